@@ -25,6 +25,22 @@ QUICK:
     the query functions
     #define JSON_DELIMITER (character) before including this file
 
+    To overwrite the signed 64-bit integer type used by `json_convert_int`
+    #define JSON_INT64 (type) before including this file
+
+    To overwrite the signed type used for document lengths, offsets and
+    token counts (defaults to a pointer sized integer)
+    #define JSON_SIZE_TYPE (type) before including this file
+
+    To load files by memory mapping them with `json_file_open` and
+    `json_load_file` (uses the operating system headers)
+    #define JSON_USE_MMAP before including this file
+
+    To build the structural index used by `json_index` and to scan strings
+    and validate UTF-8 inside the parser with SSE2 or AVX2 instead of the
+    portable scalar fallback
+    #define JSON_USE_SSE2 or JSON_USE_AVX2 before including this file
+
 LICENSE: (zlib)
     Copyright (c) 2016 Micha Mettke
 
@@ -68,30 +84,191 @@ EXAMPLES:*/
     size_t len = strlen(json);
 
     /* load content into token array */
-    size_t read = 0;
-    size_t num = json_num(json, len);
+    json_size read = 0;
+    json_size num = json_num(json, len);
     struct json_token *toks = calloc(num, sizeof(struct json_token));
     json_load(toks, num, &read, json, len);
 
+    /* parse directly from a memory mapped file */
+    struct json_file file;
+    json_load_file(&file, &toks, &max, &read, "export.json", &alloc);
+    json_file_close(&file);
+
+    /* load content in one pass into a growing token array */
+    static void *resize(void *user, void *old, json_size size)
+        {return realloc(old, (size_t)size);}
+    struct json_allocator alloc = {NULL, resize};
+    struct json_token *toks = NULL;
+    json_size max = 0, read = 0;
+    json_load_alloc(&toks, &max, &read, json, len, &alloc);
+
     /* query token */
     struct json_token *t0 = json_query(toks, num, "map.entity[4].position");
 
     /* query string */
     char buffer[64];
-    size_t size;
+    json_size size;
     json_query_string(buffer, 64, &size, toks, num, "map.entity[4].name");
 
     /* query number */
     json_number num;
     json_query_number(&num, toks, num, "map.soldier[2].position.x");
 
+    /* decode a numeric array without tokens for its elements */
+    struct json_token *verts = json_query(toks, num, "mesh.vertices");
+    json_size n = json_array_to_floats(NULL, 0, verts);
+    float *data = malloc(n * sizeof(float));
+    json_array_to_floats(data, n, verts);
+
+    /* query 64-bit integer */
+    json_int64 id;
+    json_query_int(&id, toks, num, "map.soldier[2].id");
+
     /* query type */
     int type0 = json_query_number(toks, num, "map.soldier[2]");
 
+    /* decode string escapes into an arena (plain strings are not copied) */
+    char memory[1024];
+    struct json_arena arena;
+    struct json_view view;
+    json_arena_begin(&arena, memory, sizeof(memory));
+    json_unescape(&view, &arena, json_query(toks, num, "map.entity[4].name"));
+
+    /* precompiled query */
+    struct json_path path;
+    json_path_compile(&path, "map.entity[4].position");
+    struct json_token *t1 = json_query_compiled(toks, num, &path);
+
+    /* multiple queries in one pass */
+    struct json_trie trie;
+    struct json_trie_node nodes[32];
+    struct json_token *results[2];
+    json_trie_begin(&trie, nodes, 32);
+    json_trie_add(&trie, &path, 0);
+    json_trie_add(&trie, &other_path, 1);
+    json_query_multi(results, 2, toks, num, &trie);
+
+    /* wildcard, slice and JSON Pointer selections in one pass */
+    struct json_select sel;
+    struct json_token *xs[1024];
+    json_select_compile(&sel, "map.entity[*].position.x");
+    json_size n = json_query_select(xs, 1024, toks, num, &sel, JSON_NONE);
+    json_select_compile(&sel, "/map/entity/0/position/x");
+    n = json_query_select(xs, 1024, toks, num, &sel, JSON_OBJECT);
+
+    /* hashed key index for repeated lookups into a large object */
+    struct json_token *dict = json_query(toks, num, "users");
+    struct json_hash hash;
+    json_size size = json_hash_size(dict + 1, dict->sub);
+    json_size *slots = calloc(size, sizeof(json_size));
+    json_hash_build(&hash, slots, size, dict + 1, dict->sub);
+    struct json_token *user = json_hash_get(&hash, "1234567");
+
+    /* on demand parsing of only the visited parts of a document */
+    struct json_token key, val;
+    struct json_cursor root = json_cursor_begin(json, len);
+    if (json_cursor_find(&root, "users", &val)) {
+        struct json_cursor users = json_cursor_enter(&root, &val);
+        while (json_cursor_next(&users, NULL, &val)) {}
+    }
+    while (json_cursor_next(&root, &key, &val)) {}
+    if (root.err != JSON_OK) {}
+
     /* sub-queries */
     json_token *entity = json_query(toks, num, "map.entity[4]");
     json_token *position = json_query(entity, entity->sub, "position");
     json_token *rotation = json_query(entity, entity->sub, "rotation");
+
+    /* compact tape layout with constant time subtree skipping */
+    struct json_tape *tape = calloc(num, sizeof(struct json_tape));
+    json_load_tape(tape, num, &read, json, len);
+    struct json_tape *pos = json_tape_query(tape, read, json, "map.entity[4].position");
+    for (i = (pos - tape) + 1; i < pos->next; i = tape[i].next) {}
+
+    /* streaming writer feeding a web.h connection */
+    static int flush(void *con, const char *data, int size)
+        {return wby_write((struct wby_con*)con, data, (wby_size)size);}
+    char out[4096];
+    struct json_writer w;
+    json_writer_begin(&w, out, sizeof(out), flush, connection);
+    json_write_object_begin(&w);
+    json_write_key(&w, "name", -1);
+    json_write_string(&w, "value", -1);
+    json_write_key(&w, "position", -1);
+    json_write_array_begin(&w);
+    json_write_number(&w, 0.1);
+    json_write_int(&w, 42);
+    json_write_array_end(&w);
+    json_write_object_end(&w);
+    if (json_writer_end(&w) != JSON_OK) {}
+
+    /* binary token cache for fast reloads without parsing */
+    json_cache_write(toks, read, json, len, flush, file);
+    struct json_cache cache;
+    json_cache_load(&cache, &file, "asset.cache");
+    json_cache_tokens(toks, cache.count, &cache);
+    json_cache_number(&num, &cache, 4);
+
+    /* decoding objects into structs with a field table */
+    struct vec2 {float x, y;};
+    struct entity {int id; char name[32]; struct vec2 position;};
+    #define VEC2_FIELDS(FIELD)\
+        FIELD(struct vec2, x, JSON_FIELD_FLOAT, 0)\
+        FIELD(struct vec2, y, JSON_FIELD_FLOAT, 0)
+    #define ENTITY_FIELDS(FIELD)\
+        FIELD(struct entity, id, JSON_FIELD_INT, 0)\
+        FIELD(struct entity, name, JSON_FIELD_STRING, 0)\
+        FIELD(struct entity, position, JSON_FIELD_OBJECT, &vec2_schema)
+    static const struct json_field vec2_fields[] = {VEC2_FIELDS(JSON_FIELD_ENTRY)};
+    static const struct json_field entity_fields[] = {ENTITY_FIELDS(JSON_FIELD_ENTRY)};
+    static unsigned char vec2_slots[8], entity_slots[8];
+    static struct json_schema vec2_schema, entity_schema;
+
+    json_schema_build(&vec2_schema, vec2_fields, 2, vec2_slots, 8);
+    json_schema_build(&entity_schema, entity_fields, 3, entity_slots, 8);
+    struct entity e;
+    struct json_token *obj = json_query(toks, read, "map.entity[0]");
+    json_decode(&e, &entity_schema, obj + 1, obj->sub);
+
+    /* MessagePack transcoding and reading */
+    json_mp_transcode(json, len, flush, file);
+    struct json_mp_iter mp = json_mp_begin(data, size);
+    mp = json_mp_read(&tok, &mp);
+    while (!mp.err && tok.str) {
+        mp = json_mp_read(&tok, &mp);
+    }
+    json_mp_load(toks, 256, &read, data, size);
+    json_query_number(&num, toks, read, "map.entity[4].position.x");
+
+    /* streaming parser for documents arriving in chunks */
+    static void on_event(void *user, enum json_event event,
+        const struct json_token *tok, unsigned depth) {}
+    char memory[4096]; /* max size of a token spanning chunks */
+    struct json_stream stream;
+    json_stream_begin(&stream, memory, sizeof(memory), on_event, NULL);
+    while ((n = recv(socket, chunk, sizeof(chunk), 0)) > 0)
+        json_stream_feed(&stream, chunk, n);
+    json_stream_end(&stream);
+
+    /* parallel parsing of newline delimited records with sched.h */
+    int n = json_batch_split(NULL, 0, json, len);
+    struct json_record *records = calloc(n, sizeof(struct json_record));
+    struct json_batch_slot *slots = calloc(sched.threads_num, sizeof(struct json_batch_slot));
+    json_batch_split(records, n, json, len);
+    json_batch_begin(&batch, records, n, slots, sched.threads_num, &alloc);
+    scheduler_add(&task, &sched, json_batch_run, &batch, n);
+    scheduler_join(&sched, &task);
+    struct json_token *record = json_batch_tokens(&batch, 4);
+
+    /* parallel parsing of a single document with one huge top level array */
+    struct json_split_chunk *chunks = calloc(n, sizeof(struct json_split_chunk));
+    json_split_begin(&split, chunks, n, json, len, &alloc);
+    scheduler_add(&task, &sched, json_split_scan, &split, n);
+    scheduler_join(&sched, &task);
+    json_split_reconcile(&split);
+    scheduler_add(&task, &sched, json_split_run, &split, n);
+    scheduler_join(&sched, &task);
+    json_split_join(&toks, &max, &read, &split);
 #endif
 
  /* ===============================================================
@@ -121,6 +298,32 @@ extern "C" {
 
 typedef double json_number;
 
+#ifndef JSON_INT64
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdint.h>
+#define JSON_INT64 int64_t
+#elif defined(_MSC_VER)
+#define JSON_INT64 __int64
+#elif defined(__LP64__) || defined(_LP64)
+#define JSON_INT64 long
+#else
+#define JSON_INT64 long long
+#endif
+#endif
+typedef JSON_INT64 json_int64;
+
+#ifndef JSON_SIZE_TYPE
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdint.h>
+#define JSON_SIZE_TYPE intptr_t
+#elif defined(_WIN64)
+#define JSON_SIZE_TYPE __int64
+#else
+#define JSON_SIZE_TYPE long
+#endif
+#endif
+typedef JSON_SIZE_TYPE json_size;
+
 enum json_token_type {
     JSON_NONE,      /* invalid token */
     JSON_OBJECT,    /* subobject */
@@ -133,12 +336,19 @@ enum json_token_type {
     JSON_MAX
 };
 
+enum json_token_flags {
+    JSON_FLAG_INTEGER = 0x01, /* number without fraction or exponent */
+    JSON_FLAG_ESCAPED = 0x02, /* string containing escape sequences */
+    JSON_FLAG_BINARY = 0x04 /* token references MessagePack data instead of text */
+};
+
 struct json_token {
     enum json_token_type type;
     const char *str;
-    int len;
-    int children; /* number of direct child tokens */
-    int sub; /* total number of subtokens (note: not pairs)*/
+    json_size len;
+    json_size children; /* number of direct child tokens */
+    json_size sub; /* total number of subtokens (note: not pairs)*/
+    unsigned flags; /* json_token_flags subtype bits */
 };
 
 struct json_pair {
@@ -146,28 +356,529 @@ struct json_pair {
     struct json_token value;
 };
 
+/* compact alternative token layout. Each entry references the source by
+ * offset and links to its parent and next sibling, which allows skipping
+ * subtrees and walking up the tree in constant time. */
+#define JSON_TAPE_ROOT 0x0FFFFFFFu
+struct json_tape {
+    unsigned int off;
+    /* byte offset of the token inside the source string */
+    unsigned int len;
+    /* number of bytes of the token */
+    unsigned int next;
+    /* index of the next sibling or the end of the parent if last */
+    unsigned int type:4;
+    /* enum json_token_type */
+    unsigned int parent:28;
+    /* index of the parent object/array or JSON_TAPE_ROOT */
+};
+
 enum json_status {
     JSON_OK = 0,
     JSON_INVAL,
     JSON_OUT_OF_TOKEN,
-    JSON_PARSING_ERROR
+    JSON_PARSING_ERROR,
+    JSON_OUT_OF_MEMORY,
+    JSON_FLUSH_FAILED,
+    JSON_FILE_ERROR
+};
+
+/* realloc-style callback to grow a token array. Gets called with the
+ * previous memory (or NULL) and the new size in bytes and has to return
+ * NULL if the memory could not be allocated. */
+typedef void*(*json_realloc_f)(void *userdata, void *old, json_size size);
+struct json_allocator {
+    void *userdata;
+    /* userdata passed to every callback call */
+    json_realloc_f resize;
+    /* callback to allocate or grow the token array */
 };
 
 /* parse JSON into token array */
-JSON_API int                json_num(const char *json, int length);
-JSON_API enum json_status   json_load(struct json_token *toks, int max, int *read, const char *json, int length);
+JSON_API json_size          json_num(const char *json, json_size length);
+JSON_API enum json_status   json_load(struct json_token *toks, json_size max, json_size *read, const char *json, json_size length);
+JSON_API enum json_status   json_load_alloc(struct json_token **toks, json_size *max, json_size *read, const char *json, json_size length, const struct json_allocator*);
+JSON_API enum json_status   json_load_tape(struct json_tape *tape, int max, int *read, const char *json, json_size length);
+
+#ifdef JSON_USE_MMAP
+/* read only memory mapped file. Tokens parsed from `data` stay valid
+ * until the file is closed. */
+struct json_file {
+    const char *data;
+    /* mapped file content */
+    json_size size;
+    /* size of the file in bytes */
+    void *handle;
+    /* platform specific mapping handle */
+};
+JSON_API enum json_status   json_file_open(struct json_file*, const char *path);
+JSON_API void               json_file_close(struct json_file*);
+JSON_API enum json_status   json_load_file(struct json_file*, struct json_token **toks, json_size *max, json_size *read, const char *path, const struct json_allocator*);
+#endif
+
+/* two stage parsing: structural index (needs at most `length` entries) and token generation.
+ * The index holds 32-bit offsets and is limited to documents below 4GB. */
+JSON_API enum json_status   json_index(unsigned *index, json_size max, json_size *count, const char *json, json_size length);
+JSON_API enum json_status   json_load_indexed(struct json_token *toks, json_size max, json_size *read, const char *json, json_size length, const unsigned *index, json_size count);
+
+/* incremental update of a token array after a localized edit of the
+ * document. Only the smallest container enclosing the edit is parsed again
+ * and spliced into the array. The edited document can be the old buffer
+ * modified in place or a copy, in which case all tokens are rebased. New
+ * tokens are parsed behind the current ones, which stay untouched if the
+ * update fails. */
+struct json_edit {
+    const char *old;
+    /* document the tokens were parsed from */
+    json_size offset;
+    /* byte offset of the edit inside the old document */
+    json_size removed;
+    /* number of bytes of the old document replaced by the edit */
+    json_size inserted;
+    /* number of bytes inserted in their place */
+};
+JSON_API enum json_status   json_update(struct json_token **toks, json_size *max, json_size *read, const char *json, json_size length, const struct json_edit*, const struct json_allocator*);
 
 /* access nodes inside token array */
-JSON_API struct json_token *json_query(struct json_token *toks, int count, const char *path);
-JSON_API int                json_query_number(json_number*, struct json_token *toks, int count, const char *path);
-JSON_API int                json_query_string(char*, int max, int *size, struct json_token*, int count, const char *path);
-JSON_API int                json_query_type(struct json_token *toks, int count, const char *path);
+JSON_API struct json_token *json_query(struct json_token *toks, json_size count, const char *path);
+JSON_API int                json_query_number(json_number*, struct json_token *toks, json_size count, const char *path);
+JSON_API int                json_query_int(json_int64*, struct json_token *toks, json_size count, const char *path);
+JSON_API int                json_query_string(char*, json_size max, json_size *size, struct json_token*, json_size count, const char *path);
+JSON_API int                json_query_type(struct json_token *toks, json_size count, const char *path);
+
+/* bulk decoding of all elements of a numeric array token directly from source.
+ * Returns the number of elements (only the first `max` are written) or -1 */
+JSON_API json_size          json_array_to_doubles(double *out, json_size max, const struct json_token *array);
+JSON_API json_size          json_array_to_floats(float *out, json_size max, const struct json_token *array);
+JSON_API json_size          json_array_to_int64s(json_int64 *out, json_size max, const struct json_token *array);
+
+/* decoding of string escapes into a caller provided bump arena. Strings
+ * without escapes (no JSON_FLAG_ESCAPED) are returned as views into the
+ * source without copying. */
+struct json_arena {
+    char *memory;
+    /* caller memory decoded strings are written to */
+    json_size size;
+    /* capacity of the memory in bytes */
+    json_size used;
+    /* number of bytes already handed out */
+};
+struct json_view {
+    const char *str;
+    /* decoded string (not zero terminated) */
+    json_size len;
+    /* number of bytes of the decoded string */
+};
+JSON_API void               json_arena_begin(struct json_arena*, char *memory, json_size size);
+JSON_API int                json_unescape(struct json_view*, struct json_arena*, const struct json_token*);
+
+/* precompiled query paths for repeated lookups */
+#ifndef JSON_PATH_MAX_STEPS
+#define JSON_PATH_MAX_STEPS 16
+#endif
+struct json_path_step {
+    const char *key;
+    /* object key inside the path string or NULL for array indexes */
+    int len;
+    /* length of the key or array index */
+};
+struct json_path {
+    int count;
+    /* number of steps in the path */
+    struct json_path_step steps[JSON_PATH_MAX_STEPS];
+    /* each path segment (path string needs to outlive the compiled path) */
+};
+JSON_API int                json_path_compile(struct json_path*, const char *path);
+JSON_API struct json_token *json_query_compiled(struct json_token *toks, json_size count, const struct json_path*);
+
+/* extraction of multiple paths in a single pass over the token array */
+struct json_trie_node {
+    const char *key;
+    /* object key or NULL for array indexes */
+    int len;
+    /* length of the key or array index */
+    int child;
+    /* index of the first child node or -1 */
+    int next;
+    /* index of the next sibling node or -1 */
+    int slot;
+    /* output slot if a path ends in this node or -1 */
+};
+struct json_trie {
+    struct json_trie_node *nodes;
+    /* node memory with the root node at index 0 */
+    int count;
+    /* number of used nodes */
+    int max;
+    /* number of available nodes */
+};
+JSON_API void               json_trie_begin(struct json_trie*, struct json_trie_node *nodes, int max);
+JSON_API int                json_trie_add(struct json_trie*, const struct json_path*, int slot);
+JSON_API int                json_query_multi(struct json_token **out, int slots, struct json_token *toks, json_size count, const struct json_trie*);
+
+/* selections of many tokens in a single pass over the token array. Besides
+ * object keys the dotted syntax supports wildcards and slices with
+ * negative indexes counting from the end: `entity[*].position.x`,
+ * `items[1:-1:2]`, `users.*.name` or `log[-1]`. Selectors beginning with
+ * '/' are RFC 6901 JSON Pointers like `/entity/0/position/x`. Matches are
+ * written in document order and the total number of matches returned. */
+enum json_select_kind {
+    JSON_SELECT_KEY,    /* object key */
+    JSON_SELECT_INDEX,  /* array index */
+    JSON_SELECT_SLICE,  /* range of array elements */
+    JSON_SELECT_ALL,    /* every object value or array element */
+    JSON_SELECT_MEMBER  /* JSON Pointer reference token (key or index) */
+};
+struct json_select_step {
+    enum json_select_kind kind;
+    /* type of the step */
+    const char *key;
+    /* object key or reference token inside the selector string */
+    int len;
+    /* length of the key */
+    json_size begin, end, step;
+    /* array index or slice bounds, negative bounds count from the end */
+};
+struct json_select {
+    int count;
+    /* number of steps in the selector */
+    struct json_select_step steps[JSON_PATH_MAX_STEPS];
+    /* each selector step (selector string needs to outlive the selection) */
+};
+JSON_API int                json_select_compile(struct json_select*, const char *selector);
+/* root is JSON_OBJECT or JSON_ARRAY for the container around the tokens or
+ * JSON_NONE to derive it from the first step, where a JSON Pointer index
+ * selects an array element */
+JSON_API json_size          json_query_select(struct json_token **out, json_size max, struct json_token *toks, json_size count, const struct json_select*, enum json_token_type root);
+
+/* access nodes inside tape array. Tape offsets are 32-bit and therefore
+ * limited to documents below 4GB. */
+JSON_API struct json_tape  *json_tape_query(struct json_tape *tape, int count, const char *json, const char *path);
+JSON_API void               json_tape_token(struct json_token*, const struct json_tape *tape, int index, const char *json);
+
+/* push parser for documents arriving in chunks */
+#ifndef JSON_STREAM_DEPTH
+#define JSON_STREAM_DEPTH 64
+#endif
+
+enum json_event {
+    JSON_EVENT_BEGIN,   /* object or array begins */
+    JSON_EVENT_END,     /* object or array ends (children holds child count) */
+    JSON_EVENT_KEY,     /* object key */
+    JSON_EVENT_VALUE    /* string, number or constant value */
+};
+typedef void(*json_event_f)(void *userdata, enum json_event,
+    const struct json_token*, unsigned depth);
+
+struct json_stream {
+    json_event_f callback;
+    /* called for every completed token */
+    void *userdata;
+    /* userdata passed to every callback call */
+    char *buffer;
+    /* memory to hold tokens spanning multiple chunks */
+    int capacity;
+    /* size of the buffer and therefore max size of a spanning token */
+    /* INTERNAL ONLY */
+    const char *go;
+    int used;
+    int partial;
+    int key;
+    int utf8_remain;
+    unsigned depth;
+    unsigned char type[JSON_STREAM_DEPTH];
+    int children[JSON_STREAM_DEPTH];
+};
+
+JSON_API void               json_stream_begin(struct json_stream*, char *buffer, int capacity, json_event_f, void *userdata);
+JSON_API enum json_status   json_stream_feed(struct json_stream*, const char *chunk, int length);
+JSON_API enum json_status   json_stream_end(struct json_stream*);
+
+/* parallel batch parsing of newline delimited JSON records. json_batch_run
+ * has the same signature as `sched_run` and can directly be passed to
+ * `scheduler_add` from sched.h with the number of records as size. */
+struct scheduler;
+struct json_record {
+    const char *str;
+    /* begin of the record inside the batch */
+    json_size len;
+    /* number of bytes of the record without line break */
+    int slot;
+    /* token slot holding the records tokens */
+    json_size offset;
+    /* index of the first record token inside the slot */
+    json_size count;
+    /* number of tokens of the record */
+    enum json_status status;
+    /* parsing result of the record */
+};
+
+struct json_batch_slot {
+    struct json_token *toks;
+    /* token array shared by all records parsed on the same thread */
+    json_size max;
+    /* capacity of the token array */
+    json_size read;
+    /* number of used tokens */
+};
+
+struct json_batch {
+    struct json_record *records;
+    /* records previously split by json_batch_split */
+    int count;
+    /* number of records */
+    struct json_batch_slot *slots;
+    /* one token slot per thread */
+    int slot_count;
+    /* number of slots, needs to be at least the number of threads */
+    const struct json_allocator *alloc;
+    /* allocator to grow each slot token array */
+};
+
+JSON_API int                json_batch_split(struct json_record *records, int max, const char *json, json_size length);
+JSON_API void               json_batch_begin(struct json_batch*, struct json_record*, int count, struct json_batch_slot *slots, int slot_count, const struct json_allocator*);
+JSON_API void               json_batch_run(void *batch, struct scheduler*, unsigned int begin, unsigned int end, unsigned int thread);
+JSON_API struct json_token *json_batch_tokens(const struct json_batch*, int record);
+
+/* parallel parsing of a single document made of one large top level array.
+ * The array is cut into chunks which are first scanned for string and
+ * bracket state from both possible starting states (inside or outside of a
+ * string). Reconciling the chunks in order resolves the real state at each
+ * chunk begin, after which every chunk parses the array elements starting
+ * inside of it. The run functions have the `sched_run` signature with the
+ * number of chunks as size and the tokens match json_load after joining. */
+struct json_split_chunk {
+    const char *begin;
+    /* first byte of the chunk */
+    const char *end;
+    /* one past the last byte of the chunk */
+    json_size depth[2];
+    /* bracket depth change if the chunk begins outside/inside a string */
+    int string[2];
+    /* string state at the chunk end for both starting states */
+    json_size level;
+    /* reconciled bracket depth at the chunk begin */
+    int state;
+    /* reconciled string state at the chunk begin */
+    struct json_token *toks;
+    /* tokens of all elements beginning inside the chunk */
+    json_size max;
+    /* capacity of the token array */
+    json_size read;
+    /* number of used tokens */
+    json_size elements;
+    /* number of array elements beginning inside the chunk */
+    enum json_status status;
+    /* parsing result of the chunk */
+};
+
+struct json_split {
+    const char *json;
+    /* document with a top level array */
+    json_size length;
+    /* number of bytes of the document */
+    const char *close;
+    /* closing bracket of the top level array found by reconciling */
+    struct json_split_chunk *chunks;
+    /* chunks the array is cut into */
+    int count;
+    /* number of chunks */
+    const struct json_allocator *alloc;
+    /* allocator to grow each chunk token array */
+};
+
+JSON_API enum json_status   json_split_begin(struct json_split*, struct json_split_chunk *chunks, int count, const char *json, json_size length, const struct json_allocator*);
+JSON_API void               json_split_scan(void *split, struct scheduler*, unsigned int begin, unsigned int end, unsigned int thread);
+JSON_API enum json_status   json_split_reconcile(struct json_split*);
+JSON_API void               json_split_run(void *split, struct scheduler*, unsigned int begin, unsigned int end, unsigned int thread);
+JSON_API enum json_status   json_split_join(struct json_token **toks, json_size *max, json_size *read, const struct json_split*);
+
+/* hashed key index over the members of a large object for constant time
+ * lookups. Members are passed like sub-queries as (object + 1, object->sub)
+ * or (toks, read) for the root object. The slots are caller memory. */
+struct json_hash {
+    struct json_token *toks;
+    /* object members the index was built for */
+    json_size *slots;
+    /* open addressing table with token index + 1 of each key (0 if empty) */
+    json_size mask;
+    /* number of slots - 1 */
+};
+JSON_API json_size          json_hash_size(const struct json_token *toks, json_size count);
+JSON_API int                json_hash_build(struct json_hash*, json_size *slots, json_size size, struct json_token *toks, json_size count);
+JSON_API struct json_token *json_hash_get(const struct json_hash*, const char *key);
+
+/* schema driven decoding of object members into C structs. A field table
+ * maps member names to struct offsets and is turned into a perfect hash
+ * once by json_schema_build. json_decode then fills a struct in a single
+ * pass over the pairs of an object. Field tables can be generated from an
+ * X-macro list:
+ *
+ *  #define VEC2_FIELDS(FIELD)\
+ *      FIELD(struct vec2, x, JSON_FIELD_FLOAT, 0)\
+ *      FIELD(struct vec2, y, JSON_FIELD_FLOAT, 0)
+ *  static const struct json_field vec2_fields[] = {VEC2_FIELDS(JSON_FIELD_ENTRY)};
+ */
+#include <stddef.h>
+enum json_field_type {
+    JSON_FIELD_INT,     /* int */
+    JSON_FIELD_INT64,   /* json_int64 */
+    JSON_FIELD_FLOAT,   /* float */
+    JSON_FIELD_DOUBLE,  /* double */
+    JSON_FIELD_BOOL,    /* int set to 0 or 1 */
+    JSON_FIELD_STRING,  /* zero terminated char array with escapes decoded */
+    JSON_FIELD_OBJECT   /* nested struct described by `schema` */
+};
+struct json_schema;
+struct json_field {
+    const char *name;
+    /* member name inside the JSON object */
+    json_size offset;
+    /* byte offset of the member inside the struct */
+    enum json_field_type type;
+    /* C type of the member */
+    json_size size;
+    /* size of the member in bytes */
+    const struct json_schema *schema;
+    /* schema of JSON_FIELD_OBJECT members */
+};
+#define JSON_FIELD_ENTRY(type, member, kind, schema)\
+    {#member, (json_size)offsetof(type, member), kind, (json_size)sizeof(((type*)0)->member), schema},
+
+struct json_schema {
+    const struct json_field *fields;
+    /* field table */
+    int count;
+    /* number of fields (at most 255) */
+    unsigned char *slots;
+    /* field index + 1 of each hash slot (0 if empty) */
+    unsigned mask;
+    /* number of slots - 1 */
+    unsigned seed;
+    /* hash seed without collisions between the field names */
+};
+JSON_API int                json_schema_build(struct json_schema*, const struct json_field *fields, int count, unsigned char *slots, int size);
+JSON_API int                json_decode(void *out, const struct json_schema*, const struct json_token *toks, json_size count);
+
+/* on demand parsing: iterates the direct children of an object or array and
+ * only tokenizes what is visited. Containers that are not entered are
+ * skipped by bracket and quote counting. Container values only reference
+ * their opening bracket until either entered or completed by json_cursor_skip. */
+struct json_cursor {
+    const char *cur;
+    /* next character to read inside the container or NULL if done */
+    const char *end;
+    /* end of the document */
+    const char *skip;
+    /* opening bracket of a returned container value not yet skipped */
+    const char *begin;
+    /* opening bracket of this container */
+    struct json_cursor *parent;
+    /* cursor continued after this container has been fully read */
+    enum json_token_type type;
+    /* JSON_OBJECT or JSON_ARRAY */
+    json_size count;
+    /* number of values read so far */
+    enum json_status err;
+    /* JSON_OK or the first error */
+};
+JSON_API struct json_cursor json_cursor_begin(const char *json, json_size length);
+JSON_API struct json_cursor json_cursor_enter(struct json_cursor *parent, const struct json_token *container);
+JSON_API int                json_cursor_next(struct json_cursor*, struct json_token *key, struct json_token *value);
+JSON_API int                json_cursor_find(struct json_cursor*, const char *key, struct json_token *value);
+JSON_API int                json_cursor_skip(struct json_cursor*, struct json_token *value);
+
+/* streaming writer into a caller buffer which is passed to `flush` each time
+ * it is full. The callback returns 0 on success (like wby_write). Without
+ * callback the output is limited to the buffer. String lengths below zero
+ * mean zero terminated strings. */
+typedef int(*json_flush_f)(void *userdata, const char *data, int size);
+struct json_writer {
+    char *buffer;
+    /* output buffer with space for at least 64 bytes */
+    int capacity;
+    /* size of the output buffer */
+    int used;
+    /* number of bytes inside the buffer not yet flushed */
+    json_flush_f flush;
+    /* callback to hand out a full buffer */
+    void *userdata;
+    /* userdata passed to every callback call */
+    int depth;
+    /* number of open objects and arrays */
+    int comma;
+    /* set if the next value needs a separator */
+    enum json_status err;
+    /* JSON_OK or the first error */
+};
+JSON_API void               json_writer_begin(struct json_writer*, char *buffer, int capacity, json_flush_f, void *userdata);
+JSON_API enum json_status   json_writer_end(struct json_writer*);
+JSON_API void               json_write_object_begin(struct json_writer*);
+JSON_API void               json_write_object_end(struct json_writer*);
+JSON_API void               json_write_array_begin(struct json_writer*);
+JSON_API void               json_write_array_end(struct json_writer*);
+JSON_API void               json_write_key(struct json_writer*, const char *key, int len);
+JSON_API void               json_write_string(struct json_writer*, const char *str, int len);
+JSON_API void               json_write_number(struct json_writer*, json_number);
+JSON_API void               json_write_int(struct json_writer*, json_int64);
+JSON_API void               json_write_bool(struct json_writer*, int);
+JSON_API void               json_write_null(struct json_writer*);
+JSON_API void               json_write_raw(struct json_writer*, const char *json, int len);
+
+/* binary token cache of a loaded token array together with its source to
+ * skip parsing on reload. Tokens are stored with 32-bit offsets (sources
+ * below 4GB) and numbers are stored pre-decoded. The cache is written
+ * through a flush callback and opened directly from memory or a mapped
+ * file. Token views point into the cache memory. */
+struct json_cache {
+    const char *json;
+    /* source text inside the cache */
+    json_size length;
+    /* number of bytes of the source */
+    json_size count;
+    /* number of tokens */
+    const unsigned char *records;
+    /* INTERNAL ONLY: token records */
+};
+JSON_API enum json_status   json_cache_write(const struct json_token *toks, json_size count, const char *json, json_size length, json_flush_f, void *userdata);
+JSON_API enum json_status   json_cache_open(struct json_cache*, const void *data, json_size size);
+JSON_API enum json_status   json_cache_tokens(struct json_token *toks, json_size max, const struct json_cache*);
+JSON_API int                json_cache_number(json_number*, const struct json_cache*, json_size index);
+#ifdef JSON_USE_MMAP
+JSON_API enum json_status   json_cache_load(struct json_cache*, struct json_file*, const char *path);
+#endif
+
+/* MessagePack transcoding for compact binary payloads. json_mp_transcode
+ * converts a JSON document into MessagePack. The reader mirrors the
+ * tokenizer: json_mp_begin/json_mp_read/json_mp_parse iterate the members of
+ * the root or of a container token and json_mp_load fills a token array for
+ * the query functions. Tokens are marked with JSON_FLAG_BINARY: strings
+ * reference the raw bytes and numbers their binary encoding, which
+ * json_convert, json_convert_int and json_array_to_* understand. */
+#ifndef JSON_MP_DEPTH
+#define JSON_MP_DEPTH 64
+#endif
+struct json_mp_iter {
+    const unsigned char *src;
+    /* current position inside the MessagePack data */
+    json_size len;
+    /* number of bytes left */
+    json_size left;
+    /* number of items left on this level */
+    unsigned short err;
+    /* set on invalid or truncated data */
+};
+JSON_API enum json_status   json_mp_transcode(const char *json, json_size length, json_flush_f, void *userdata);
+JSON_API struct json_mp_iter json_mp_begin(const void *data, json_size size);
+JSON_API struct json_mp_iter json_mp_read(struct json_token*, const struct json_mp_iter*);
+JSON_API struct json_mp_iter json_mp_parse(struct json_pair*, const struct json_mp_iter*);
+JSON_API enum json_status   json_mp_load(struct json_token *toks, json_size max, json_size *read, const void *data, json_size size);
 
 /*--------------------------------------------------------------------------
                                 INTERNAL
   -------------------------------------------------------------------------*/
 struct json_iter {
-    int len;
+    json_size len;
     unsigned short err;
     unsigned depth;
     const char *go;
@@ -175,15 +886,16 @@ struct json_iter {
 };
 
 /* tokenizer */
-JSON_API struct json_iter   json_begin(const char *json, int length);
+JSON_API struct json_iter   json_begin(const char *json, json_size length);
 JSON_API struct json_iter   json_read(struct json_token*, const struct json_iter*);
 JSON_API struct json_iter   json_parse(struct json_pair*, const struct json_iter*);
 
 /* utility */
 JSON_API int                json_cmp(const struct json_token*, const char*);
-JSON_API int                json_cpy(char*, int, const struct json_token*);
+JSON_API json_size          json_cpy(char*, json_size, const struct json_token*);
 JSON_API int                json_convert(json_number *, const struct json_token*);
-JSON_API void               json_init(void); /* Inits internal parser lookup tables. (only required if used with MT */
+JSON_API int                json_convert_int(json_int64 *, const struct json_token*);
+#define json_init() ((void)0) /* no-op, the parser lookup tables are constant data */
 
 #ifdef __cplusplus
 }
@@ -209,9 +921,52 @@ JSON_API void               json_init(void); /* Inits internal parser lookup tab
 #define JSON_ASSERT(expr)
 #endif
 
+#if defined(JSON_USE_AVX2)
+#include <immintrin.h>
+#elif defined(JSON_USE_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#ifdef JSON_USE_MMAP
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#endif
+
 #define JSON_INTERN static
 #define JSON_GLOBAL static
 
+#ifndef JSON_UINT64
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdint.h>
+#define JSON_UINT64 uint64_t
+#elif defined(_MSC_VER)
+#define JSON_UINT64 unsigned __int64
+#elif defined(__LP64__) || defined(_LP64)
+#define JSON_UINT64 unsigned long
+#else
+#define JSON_UINT64 unsigned long long
+#endif
+#endif
+typedef JSON_UINT64 json_uint64;
+typedef int json__check_uint64[(sizeof(json_uint64) == 8) ? 1 : -1];
+typedef int json__check_int64[(sizeof(json_int64) == 8) ? 1 : -1];
+#define JSON_U64(hi,lo) (((json_uint64)(hi) << 32) | (json_uint64)(lo))
+/* largest positive value of the signed json_size type */
+#define JSON_SIZE_MAX ((json_size)((((json_size)1 << (sizeof(json_size) * 8 - 2)) - 1) * 2 + 1))
+/* range of int without <limits.h> */
+#define JSON_INT_MAX ((int)(~0u >> 1))
+#define JSON_INT_MIN (-JSON_INT_MAX - 1)
+/* checks if a non-negative size fits into the 32-bit tape and index offsets */
+#define JSON_FITS_U32(n) ((json_size)(unsigned)(n) == (n))
+
 #ifndef NULL
 #define NULL ((void*)0)
 #endif
@@ -240,133 +995,186 @@ enum json_parser_states {
     JSON_STATE_MAX
 };
 
-/* Main token to number conversion states */
-enum json_nuber_states {
-    JSON_STATE_NUM_FAILED,
-    JSON_STATE_NUM_LOOP,
-    JSON_STATE_NUM_FLT,
-    JSON_STATE_NUM_EXP,
-    JSON_STATE_NUM_BREAK,
-    JSON_STATE_NUM_MAX
+/* character classes used to build the structural index */
+enum json_char_classes {
+    JSON_CLASS_QUOTE    = 0x01,
+    JSON_CLASS_BSLASH   = 0x02,
+    JSON_CLASS_OP       = 0x04,
+    JSON_CLASS_WS       = 0x08,
+    JSON_CLASS_CTRL     = 0x10,
+    JSON_CLASS_ZERO     = 0x20
 };
 
-/* global parser jump tables */
-JSON_GLOBAL char json_go_struct[256];
-JSON_GLOBAL char json_go_bare[256];
-JSON_GLOBAL char json_go_string[256];
-JSON_GLOBAL char json_go_utf8[256];
-JSON_GLOBAL char json_go_esc[256];
-JSON_GLOBAL char json_go_num[256];
+/* parser jump tables indexed by character. Constant data to be shared
+ * by all threads without initialization.
+ * struct: whitespace and ',' loop, '"' opens a string, brackets go up and
+ * down, ':' and '=' separate and digits, '-', 't', 'f' and 'n' begin a bare
+ * value */
+JSON_GLOBAL const char json_go_struct[256] = {
+    0,0,0,0,0,0,0,0,0,1,1,0,0,1,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    1,0,5,0,0,0,0,0,0,0,0,0,1,9,0,0,
+    9,9,9,9,9,9,9,9,9,9,2,0,0,2,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,3,0,4,0,0,
+    0,0,0,0,0,0,9,0,0,0,0,0,0,0,9,0,
+    0,0,0,0,9,0,0,0,0,0,0,3,0,4,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+/* bare: printable ASCII loops until whitespace, ',' or a closing bracket */
+JSON_GLOBAL const char json_go_bare[256] = {
+    0,0,0,0,0,0,0,0,0,10,10,0,0,10,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    1,1,1,1,1,1,1,1,1,1,1,1,10,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,10,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,10,1,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+/* string: printable ASCII loops, '\\' escapes, '"' closes and UTF-8 lead
+ * bytes expect one to three continuation bytes */
+JSON_GLOBAL const char json_go_string[256] = {
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    1,1,6,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,7,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    11,11,11,11,11,11,11,11,11,11,11,11,11,11,11,11,
+    11,11,11,11,11,11,11,11,11,11,11,11,11,11,11,11,
+    12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+    13,13,13,13,13,13,13,13,0,0,0,0,0,0,0,0
+};
+/* utf8: continuation bytes 0x80-0xBF */
+JSON_GLOBAL const char json_go_utf8[256] = {
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,
+    14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,
+    14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,
+    14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,14,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+/* esc: characters allowed after a backslash */
+JSON_GLOBAL const char json_go_esc[256] = {
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,8,0,0,0,0,0,0,0,0,0,0,0,0,8,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,8,0,0,0,
+    0,0,8,0,0,0,8,0,0,0,0,0,0,0,8,0,
+    0,0,8,0,8,8,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+/* character classes used to build the structural index: control
+ * characters, zero, whitespace, quote, backslash and operators */
+JSON_GLOBAL const char json_char_class[256] = {
+    48,16,16,16,16,16,16,16,16,24,24,16,16,24,16,16,
+    16,16,16,16,16,16,16,16,16,16,16,16,16,16,16,16,
+    8,0,1,0,0,0,0,0,0,0,0,0,4,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,4,0,0,4,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,4,2,4,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,4,0,4,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
 JSON_GLOBAL const struct json_iter JSON_ITER_NULL = {0,0,0,0,0};
-JSON_GLOBAL const struct json_token JSON_TOKEN_NULL = {JSON_NONE,0,0,0,0};
-JSON_GLOBAL int json_is_initialized;
+JSON_GLOBAL const struct json_token JSON_TOKEN_NULL = {JSON_NONE,0,0,0,0,0};
 
 /*--------------------------------------------------------------------------
  *
                                 HELPER
 
   -------------------------------------------------------------------------*/
-/* initializes the parser jump tables */
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wchar-subscripts"
-#endif
-
-JSON_API void
-json_init(void)
-{
-    int i;
-    if (json_is_initialized) return;
-    json_is_initialized = 1;
-    for (i = 48; i <= 57; ++i)
-        json_go_struct[i] = JSON_STATE_BARE;
-    json_go_struct['\t'] = JSON_STATE_LOOP;
-    json_go_struct['\r'] = JSON_STATE_LOOP;
-    json_go_struct['\n'] = JSON_STATE_LOOP;
-    json_go_struct[' '] = JSON_STATE_LOOP;
-    json_go_struct['"'] = JSON_STATE_QUP;
-    json_go_struct[':'] = JSON_STATE_SEP;
-    json_go_struct['='] = JSON_STATE_SEP;
-    json_go_struct[','] = JSON_STATE_LOOP;
-    json_go_struct['['] = JSON_STATE_UP;
-    json_go_struct[']'] = JSON_STATE_DOWN;
-    json_go_struct['{'] = JSON_STATE_UP;
-    json_go_struct['}'] = JSON_STATE_DOWN;
-    json_go_struct['-'] = JSON_STATE_BARE;
-    json_go_struct['t'] = JSON_STATE_BARE;
-    json_go_struct['f'] = JSON_STATE_BARE;
-    json_go_struct['n'] = JSON_STATE_BARE;
-
-    for (i = 32; i <= 126; ++i)
-        json_go_bare[i] = JSON_STATE_LOOP;
-    json_go_bare['\t'] = JSON_STATE_UNBARE;
-    json_go_bare['\r'] = JSON_STATE_UNBARE;
-    json_go_bare['\n'] = JSON_STATE_UNBARE;
-    json_go_bare[','] = JSON_STATE_UNBARE;
-    json_go_bare[']'] = JSON_STATE_UNBARE;
-    json_go_bare['}'] = JSON_STATE_UNBARE;
-
-    for (i = 32; i <= 126; ++i)
-        json_go_string[i] = JSON_STATE_LOOP;
-    for (i = 192; i <= 223; ++i)
-        json_go_string[i] = JSON_STATE_UTF8_2;
-    for (i = 224; i <= 239; ++i)
-        json_go_string[i] = JSON_STATE_UTF8_3;
-    for (i = 240; i <= 247; ++i)
-        json_go_string[i] = JSON_STATE_UTF8_4;
-    json_go_string['\\'] = JSON_STATE_ESC;
-    json_go_string['"'] = JSON_STATE_QDOWN;
-    for (i = 128; i <= 191; ++i)
-        json_go_utf8[i] = JSON_STATE_UTF8_NEXT;
-
-    json_go_esc['"'] = JSON_STATE_UNESC;
-    json_go_esc['\\'] = JSON_STATE_UNESC;
-    json_go_esc['/'] = JSON_STATE_UNESC;
-    json_go_esc['b'] = JSON_STATE_UNESC;
-    json_go_esc['f'] = JSON_STATE_UNESC;
-    json_go_esc['n'] = JSON_STATE_UNESC;
-    json_go_esc['r'] = JSON_STATE_UNESC;
-    json_go_esc['t'] = JSON_STATE_UNESC;
-    json_go_esc['u'] = JSON_STATE_UNESC;
-
-    for (i = 48; i <= 57; ++i)
-        json_go_num[i] = JSON_STATE_LOOP;
-    json_go_num['-'] = JSON_STATE_NUM_LOOP;
-    json_go_num['+'] = JSON_STATE_NUM_LOOP;
-    json_go_num['.'] = JSON_STATE_NUM_FLT;
-    json_go_num['e'] = JSON_STATE_NUM_EXP;
-    json_go_num['E'] = JSON_STATE_NUM_EXP;
-    json_go_num[' '] = JSON_STATE_NUM_BREAK;
-    json_go_num['\n'] = JSON_STATE_NUM_BREAK;
-    json_go_num['\t'] = JSON_STATE_NUM_BREAK;
-    json_go_num['\r'] = JSON_STATE_NUM_BREAK;
-}
-
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
-
-/* checks and returns the type of a token */
+/* returns the type of a token by its first character */
 JSON_INTERN enum json_token_type
-json_type(const struct json_token *tok)
+json_type_char(char c)
 {
-    if (!tok || !tok->str || !tok->len)
-        return JSON_NONE;
-    if (tok->str[0] == '{')
+    if (c == '{')
         return JSON_OBJECT;
-    if (tok->str[0] == '[')
+    if (c == '[')
         return JSON_ARRAY;
-    if (tok->str[0] == '\"')
+    if (c == '\"')
         return JSON_STRING;
-    if (tok->str[0] == 't')
+    if (c == 't')
         return JSON_TRUE;
-    if (tok->str[0] == 'f')
+    if (c == 'f')
         return JSON_FALSE;
-    if (tok->str[0] == 'n')
+    if (c == 'n')
         return JSON_NULL;
     return JSON_NUMBER;
 }
 
+/* returns the subtype flags of a token of the given type */
+JSON_INTERN unsigned
+json_flags(enum json_token_type type, const char *str, json_size len)
+{
+    json_size i;
+    if (type != JSON_NUMBER)
+        return 0;
+    for (i = 0; i < len; ++i) {
+        if (str[i] == '.' || str[i] == 'e' || str[i] == 'E')
+            return 0;
+    }
+    return JSON_FLAG_INTEGER;
+}
+
+/* checks and returns the type of a token */
+JSON_INTERN enum json_token_type
+json_type(const struct json_token *tok)
+{
+    if (!tok || !tok->str || !tok->len)
+        return JSON_NONE;
+    return json_type_char(tok->str[0]);
+}
+
 /* dequotes a string token */
 JSON_INTERN void
 json_deq(struct json_token *tok)
@@ -376,180 +1184,1630 @@ json_deq(struct json_token *tok)
     }
 }
 
-/* simple power function for json exponent numbers */
-JSON_INTERN json_number
-json_ipow(int base, unsigned exp)
+/* exact powers of ten representable as double */
+JSON_GLOBAL const double json_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* 128-bit truncated powers of five from 5^-342 to 5^324 used by the
+ * Eisel-Lemire algorithm and the shortest double formatting. Each entry
+ * holds the high and low 64 bits split into 32-bit halves to stay
+ * portable for C89 compilers. */
+#define JSON_POW5_MIN (-342)
+#define JSON_POW5_MAX 324
+JSON_GLOBAL const unsigned int json_pow5[JSON_POW5_MAX - JSON_POW5_MIN + 1][4] = {
+    {0xEEF453D6u,0x923BD65Au,0x113FAA29u,0x06A13B3Fu},
+    {0x9558B466u,0x1B6565F8u,0x4AC7CA59u,0xA424C507u},
+    {0xBAAEE17Fu,0xA23EBF76u,0x5D79BCF0u,0x0D2DF649u},
+    {0xE95A99DFu,0x8ACE6F53u,0xF4D82C2Cu,0x107973DCu},
+    {0x91D8A02Bu,0xB6C10594u,0x79071B9Bu,0x8A4BE869u},
+    {0xB64EC836u,0xA47146F9u,0x9748E282u,0x6CDEE284u},
+    {0xE3E27A44u,0x4D8D98B7u,0xFD1B1B23u,0x08169B25u},
+    {0x8E6D8C6Au,0xB0787F72u,0xFE30F0F5u,0xE50E20F7u},
+    {0xB208EF85u,0x5C969F4Fu,0xBDBD2D33u,0x5E51A935u},
+    {0xDE8B2B66u,0xB3BC4723u,0xAD2C7880u,0x35E61382u},
+    {0x8B16FB20u,0x3055AC76u,0x4C3BCB50u,0x21AFCC31u},
+    {0xADDCB9E8u,0x3C6B1793u,0xDF4ABE24u,0x2A1BBF3Du},
+    {0xD953E862u,0x4B85DD78u,0xD71D6DADu,0x34A2AF0Du},
+    {0x87D4713Du,0x6F33AA6Bu,0x8672648Cu,0x40E5AD68u},
+    {0xA9C98D8Cu,0xCB009506u,0x680EFDAFu,0x511F18C2u},
+    {0xD43BF0EFu,0xFDC0BA48u,0x0212BD1Bu,0x2566DEF2u},
+    {0x84A57695u,0xFE98746Du,0x014BB630u,0xF7604B57u},
+    {0xA5CED43Bu,0x7E3E9188u,0x419EA3BDu,0x35385E2Du},
+    {0xCF42894Au,0x5DCE35EAu,0x52064CACu,0x828675B9u},
+    {0x818995CEu,0x7AA0E1B2u,0x7343EFEBu,0xD1940993u},
+    {0xA1EBFB42u,0x19491A1Fu,0x1014EBE6u,0xC5F90BF8u},
+    {0xCA66FA12u,0x9F9B60A6u,0xD41A26E0u,0x77774EF6u},
+    {0xFD00B897u,0x478238D0u,0x8920B098u,0x955522B4u},
+    {0x9E20735Eu,0x8CB16382u,0x55B46E5Fu,0x5D5535B0u},
+    {0xC5A89036u,0x2FDDBC62u,0xEB2189F7u,0x34AA831Du},
+    {0xF712B443u,0xBBD52B7Bu,0xA5E9EC75u,0x01D523E4u},
+    {0x9A6BB0AAu,0x55653B2Du,0x47B233C9u,0x2125366Eu},
+    {0xC1069CD4u,0xEABE89F8u,0x999EC0BBu,0x696E840Au},
+    {0xF148440Au,0x256E2C76u,0xC00670EAu,0x43CA250Du},
+    {0x96CD2A86u,0x5764DBCAu,0x38040692u,0x6A5E5728u},
+    {0xBC807527u,0xED3E12BCu,0xC6050837u,0x04F5ECF2u},
+    {0xEBA09271u,0xE88D976Bu,0xF7864A44u,0xC633682Eu},
+    {0x93445B87u,0x31587EA3u,0x7AB3EE6Au,0xFBE0211Du},
+    {0xB8157268u,0xFDAE9E4Cu,0x5960EA05u,0xBAD82964u},
+    {0xE61ACF03u,0x3D1A45DFu,0x6FB92487u,0x298E33BDu},
+    {0x8FD0C162u,0x06306BABu,0xA5D3B6D4u,0x79F8E056u},
+    {0xB3C4F1BAu,0x87BC8696u,0x8F48A489u,0x9877186Cu},
+    {0xE0B62E29u,0x29ABA83Cu,0x331ACDABu,0xFE94DE87u},
+    {0x8C71DCD9u,0xBA0B4925u,0x9FF0C08Bu,0x7F1D0B14u},
+    {0xAF8E5410u,0x288E1B6Fu,0x07ECF0AEu,0x5EE44DD9u},
+    {0xDB71E914u,0x32B1A24Au,0xC9E82CD9u,0xF69D6150u},
+    {0x892731ACu,0x9FAF056Eu,0xBE311C08u,0x3A225CD2u},
+    {0xAB70FE17u,0xC79AC6CAu,0x6DBD630Au,0x48AAF406u},
+    {0xD64D3D9Du,0xB981787Du,0x092CBBCCu,0xDAD5B108u},
+    {0x85F04682u,0x93F0EB4Eu,0x25BBF560u,0x08C58EA5u},
+    {0xA76C5823u,0x38ED2621u,0xAF2AF2B8u,0x0AF6F24Eu},
+    {0xD1476E2Cu,0x07286FAAu,0x1AF5AF66u,0x0DB4AEE1u},
+    {0x82CCA4DBu,0x847945CAu,0x50D98D9Fu,0xC890ED4Du},
+    {0xA37FCE12u,0x6597973Cu,0xE50FF107u,0xBAB528A0u},
+    {0xCC5FC196u,0xFEFD7D0Cu,0x1E53ED49u,0xA96272C8u},
+    {0xFF77B1FCu,0xBEBCDC4Fu,0x25E8E89Cu,0x13BB0F7Au},
+    {0x9FAACF3Du,0xF73609B1u,0x77B19161u,0x8C54E9ACu},
+    {0xC795830Du,0x75038C1Du,0xD59DF5B9u,0xEF6A2417u},
+    {0xF97AE3D0u,0xD2446F25u,0x4B057328u,0x6B44AD1Du},
+    {0x9BECCE62u,0x836AC577u,0x4EE367F9u,0x430AEC32u},
+    {0xC2E801FBu,0x244576D5u,0x229C41F7u,0x93CDA73Fu},
+    {0xF3A20279u,0xED56D48Au,0x6B435275u,0x78C1110Fu},
+    {0x9845418Cu,0x345644D6u,0x830A1389u,0x6B78AAA9u},
+    {0xBE5691EFu,0x416BD60Cu,0x23CC986Bu,0xC656D553u},
+    {0xEDEC366Bu,0x11C6CB8Fu,0x2CBFBE86u,0xB7EC8AA8u},
+    {0x94B3A202u,0xEB1C3F39u,0x7BF7D714u,0x32F3D6A9u},
+    {0xB9E08A83u,0xA5E34F07u,0xDAF5CCD9u,0x3FB0CC53u},
+    {0xE858AD24u,0x8F5C22C9u,0xD1B3400Fu,0x8F9CFF68u},
+    {0x91376C36u,0xD99995BEu,0x23100809u,0xB9C21FA1u},
+    {0xB5854744u,0x8FFFFB2Du,0xABD40A0Cu,0x2832A78Au},
+    {0xE2E69915u,0xB3FFF9F9u,0x16C90C8Fu,0x323F516Cu},
+    {0x8DD01FADu,0x907FFC3Bu,0xAE3DA7D9u,0x7F6792E3u},
+    {0xB1442798u,0xF49FFB4Au,0x99CD11CFu,0xDF41779Cu},
+    {0xDD95317Fu,0x31C7FA1Du,0x40405643u,0xD711D583u},
+    {0x8A7D3EEFu,0x7F1CFC52u,0x482835EAu,0x666B2572u},
+    {0xAD1C8EABu,0x5EE43B66u,0xDA324365u,0x0005EECFu},
+    {0xD863B256u,0x369D4A40u,0x90BED43Eu,0x40076A82u},
+    {0x873E4F75u,0xE2224E68u,0x5A7744A6u,0xE804A291u},
+    {0xA90DE353u,0x5AAAE202u,0x711515D0u,0xA205CB36u},
+    {0xD3515C28u,0x31559A83u,0x0D5A5B44u,0xCA873E03u},
+    {0x8412D999u,0x1ED58091u,0xE858790Au,0xFE9486C2u},
+    {0xA5178FFFu,0x668AE0B6u,0x626E974Du,0xBE39A872u},
+    {0xCE5D73FFu,0x402D98E3u,0xFB0A3D21u,0x2DC8128Fu},
+    {0x80FA687Fu,0x881C7F8Eu,0x7CE66634u,0xBC9D0B99u},
+    {0xA139029Fu,0x6A239F72u,0x1C1FFFC1u,0xEBC44E80u},
+    {0xC9874347u,0x44AC874Eu,0xA327FFB2u,0x66B56220u},
+    {0xFBE91419u,0x15D7A922u,0x4BF1FF9Fu,0x0062BAA8u},
+    {0x9D71AC8Fu,0xADA6C9B5u,0x6F773FC3u,0x603DB4A9u},
+    {0xC4CE17B3u,0x99107C22u,0xCB550FB4u,0x384D21D3u},
+    {0xF6019DA0u,0x7F549B2Bu,0x7E2A53A1u,0x46606A48u},
+    {0x99C10284u,0x4F94E0FBu,0x2EDA7444u,0xCBFC426Du},
+    {0xC0314325u,0x637A1939u,0xFA911155u,0xFEFB5308u},
+    {0xF03D93EEu,0xBC589F88u,0x793555ABu,0x7EBA27CAu},
+    {0x96267C75u,0x35B763B5u,0x4BC1558Bu,0x2F3458DEu},
+    {0xBBB01B92u,0x83253CA2u,0x9EB1AAEDu,0xFB016F16u},
+    {0xEA9C2277u,0x23EE8BCBu,0x465E15A9u,0x79C1CADCu},
+    {0x92A1958Au,0x7675175Fu,0x0BFACD89u,0xEC191EC9u},
+    {0xB749FAEDu,0x14125D36u,0xCEF980ECu,0x671F667Bu},
+    {0xE51C79A8u,0x5916F484u,0x82B7E127u,0x80E7401Au},
+    {0x8F31CC09u,0x37AE58D2u,0xD1B2ECB8u,0xB0908810u},
+    {0xB2FE3F0Bu,0x8599EF07u,0x861FA7E6u,0xDCB4AA15u},
+    {0xDFBDCECEu,0x67006AC9u,0x67A791E0u,0x93E1D49Au},
+    {0x8BD6A141u,0x006042BDu,0xE0C8BB2Cu,0x5C6D24E0u},
+    {0xAECC4991u,0x4078536Du,0x58FAE9F7u,0x73886E18u},
+    {0xDA7F5BF5u,0x90966848u,0xAF39A475u,0x506A899Eu},
+    {0x888F9979u,0x7A5E012Du,0x6D8406C9u,0x52429603u},
+    {0xAAB37FD7u,0xD8F58178u,0xC8E5087Bu,0xA6D33B83u},
+    {0xD5605FCDu,0xCF32E1D6u,0xFB1E4A9Au,0x90880A64u},
+    {0x855C3BE0u,0xA17FCD26u,0x5CF2EEA0u,0x9A55067Fu},
+    {0xA6B34AD8u,0xC9DFC06Fu,0xF42FAA48u,0xC0EA481Eu},
+    {0xD0601D8Eu,0xFC57B08Bu,0xF13B94DAu,0xF124DA26u},
+    {0x823C1279u,0x5DB6CE57u,0x76C53D08u,0xD6B70858u},
+    {0xA2CB1717u,0xB52481EDu,0x54768C4Bu,0x0C64CA6Eu},
+    {0xCB7DDCDDu,0xA26DA268u,0xA9942F5Du,0xCF7DFD09u},
+    {0xFE5D5415u,0x0B090B02u,0xD3F93B35u,0x435D7C4Cu},
+    {0x9EFA548Du,0x26E5A6E1u,0xC47BC501u,0x4A1A6DAFu},
+    {0xC6B8E9B0u,0x709F109Au,0x359AB641u,0x9CA1091Bu},
+    {0xF867241Cu,0x8CC6D4C0u,0xC30163D2u,0x03C94B62u},
+    {0x9B407691u,0xD7FC44F8u,0x79E0DE63u,0x425DCF1Du},
+    {0xC2109436u,0x4DFB5636u,0x985915FCu,0x12F542E4u},
+    {0xF294B943u,0xE17A2BC4u,0x3E6F5B7Bu,0x17B2939Du},
+    {0x979CF3CAu,0x6CEC5B5Au,0xA705992Cu,0xEECF9C42u},
+    {0xBD8430BDu,0x08277231u,0x50C6FF78u,0x2A838353u},
+    {0xECE53CECu,0x4A314EBDu,0xA4F8BF56u,0x35246428u},
+    {0x940F4613u,0xAE5ED136u,0x871B7795u,0xE136BE99u},
+    {0xB9131798u,0x99F68584u,0x28E2557Bu,0x59846E3Fu},
+    {0xE757DD7Eu,0xC07426E5u,0x331AEADAu,0x2FE589CFu},
+    {0x9096EA6Fu,0x3848984Fu,0x3FF0D2C8u,0x5DEF7621u},
+    {0xB4BCA50Bu,0x065ABE63u,0x0FED077Au,0x756B53A9u},
+    {0xE1EBCE4Du,0xC7F16DFBu,0xD3E84959u,0x12C62894u},
+    {0x8D3360F0u,0x9CF6E4BDu,0x64712DD7u,0xABBBD95Cu},
+    {0xB080392Cu,0xC4349DECu,0xBD8D794Du,0x96AACFB3u},
+    {0xDCA04777u,0xF541C567u,0xECF0D7A0u,0xFC5583A0u},
+    {0x89E42CAAu,0xF9491B60u,0xF41686C4u,0x9DB57244u},
+    {0xAC5D37D5u,0xB79B6239u,0x311C2875u,0xC522CED5u},
+    {0xD77485CBu,0x25823AC7u,0x7D633293u,0x366B828Bu},
+    {0x86A8D39Eu,0xF77164BCu,0xAE5DFF9Cu,0x02033197u},
+    {0xA8530886u,0xB54DBDEBu,0xD9F57F83u,0x0283FDFCu},
+    {0xD267CAA8u,0x62A12D66u,0xD072DF63u,0xC324FD7Bu},
+    {0x8380DEA9u,0x3DA4BC60u,0x4247CB9Eu,0x59F71E6Du},
+    {0xA4611653u,0x8D0DEB78u,0x52D9BE85u,0xF074E608u},
+    {0xCD795BE8u,0x70516656u,0x67902E27u,0x6C921F8Bu},
+    {0x806BD971u,0x4632DFF6u,0x00BA1CD8u,0xA3DB53B6u},
+    {0xA086CFCDu,0x97BF97F3u,0x80E8A40Eu,0xCCD228A4u},
+    {0xC8A883C0u,0xFDAF7DF0u,0x6122CD12u,0x8006B2CDu},
+    {0xFAD2A4B1u,0x3D1B5D6Cu,0x796B8057u,0x20085F81u},
+    {0x9CC3A6EEu,0xC6311A63u,0xCBE33036u,0x74053BB0u},
+    {0xC3F490AAu,0x77BD60FCu,0xBEDBFC44u,0x11068A9Cu},
+    {0xF4F1B4D5u,0x15ACB93Bu,0xEE92FB55u,0x15482D44u},
+    {0x99171105u,0x2D8BF3C5u,0x751BDD15u,0x2D4D1C4Au},
+    {0xBF5CD546u,0x78EEF0B6u,0xD262D45Au,0x78A0635Du},
+    {0xEF340A98u,0x172AACE4u,0x86FB8971u,0x16C87C34u},
+    {0x9580869Fu,0x0E7AAC0Eu,0xD45D35E6u,0xAE3D4DA0u},
+    {0xBAE0A846u,0xD2195712u,0x89748360u,0x59CCA109u},
+    {0xE998D258u,0x869FACD7u,0x2BD1A438u,0x703FC94Bu},
+    {0x91FF8377u,0x5423CC06u,0x7B6306A3u,0x4627DDCFu},
+    {0xB67F6455u,0x292CBF08u,0x1A3BC84Cu,0x17B1D542u},
+    {0xE41F3D6Au,0x7377EECAu,0x20CABA5Fu,0x1D9E4A93u},
+    {0x8E938662u,0x882AF53Eu,0x547EB47Bu,0x7282EE9Cu},
+    {0xB23867FBu,0x2A35B28Du,0xE99E619Au,0x4F23AA43u},
+    {0xDEC681F9u,0xF4C31F31u,0x6405FA00u,0xE2EC94D4u},
+    {0x8B3C113Cu,0x38F9F37Eu,0xDE83BC40u,0x8DD3DD04u},
+    {0xAE0B158Bu,0x4738705Eu,0x9624AB50u,0xB148D445u},
+    {0xD98DDAEEu,0x19068C76u,0x3BADD624u,0xDD9B0957u},
+    {0x87F8A8D4u,0xCFA417C9u,0xE54CA5D7u,0x0A80E5D6u},
+    {0xA9F6D30Au,0x038D1DBCu,0x5E9FCF4Cu,0xCD211F4Cu},
+    {0xD47487CCu,0x8470652Bu,0x7647C320u,0x0069671Fu},
+    {0x84C8D4DFu,0xD2C63F3Bu,0x29ECD9F4u,0x0041E073u},
+    {0xA5FB0A17u,0xC777CF09u,0xF4681071u,0x00525890u},
+    {0xCF79CC9Du,0xB955C2CCu,0x7182148Du,0x4066EEB4u},
+    {0x81AC1FE2u,0x93D599BFu,0xC6F14CD8u,0x48405530u},
+    {0xA21727DBu,0x38CB002Fu,0xB8ADA00Eu,0x5A506A7Cu},
+    {0xCA9CF1D2u,0x06FDC03Bu,0xA6D90811u,0xF0E4851Cu},
+    {0xFD442E46u,0x88BD304Au,0x908F4A16u,0x6D1DA663u},
+    {0x9E4A9CECu,0x15763E2Eu,0x9A598E4Eu,0x043287FEu},
+    {0xC5DD4427u,0x1AD3CDBAu,0x40EFF1E1u,0x853F29FDu},
+    {0xF7549530u,0xE188C128u,0xD12BEE59u,0xE68EF47Cu},
+    {0x9A94DD3Eu,0x8CF578B9u,0x82BB74F8u,0x301958CEu},
+    {0xC13A148Eu,0x3032D6E7u,0xE36A5236u,0x3C1FAF01u},
+    {0xF18899B1u,0xBC3F8CA1u,0xDC44E6C3u,0xCB279AC1u},
+    {0x96F5600Fu,0x15A7B7E5u,0x29AB103Au,0x5EF8C0B9u},
+    {0xBCB2B812u,0xDB11A5DEu,0x7415D448u,0xF6B6F0E7u},
+    {0xEBDF6617u,0x91D60F56u,0x111B495Bu,0x3464AD21u},
+    {0x936B9FCEu,0xBB25C995u,0xCAB10DD9u,0x00BEEC34u},
+    {0xB84687C2u,0x69EF3BFBu,0x3D5D514Fu,0x40EEA742u},
+    {0xE65829B3u,0x046B0AFAu,0x0CB4A5A3u,0x112A5112u},
+    {0x8FF71A0Fu,0xE2C2E6DCu,0x47F0E785u,0xEABA72ABu},
+    {0xB3F4E093u,0xDB73A093u,0x59ED2167u,0x65690F56u},
+    {0xE0F218B8u,0xD25088B8u,0x306869C1u,0x3EC3532Cu},
+    {0x8C974F73u,0x83725573u,0x1E414218u,0xC73A13FBu},
+    {0xAFBD2350u,0x644EEACFu,0xE5D1929Eu,0xF90898FAu},
+    {0xDBAC6C24u,0x7D62A583u,0xDF45F746u,0xB74ABF39u},
+    {0x894BC396u,0xCE5DA772u,0x6B8BBA8Cu,0x328EB783u},
+    {0xAB9EB47Cu,0x81F5114Fu,0x066EA92Fu,0x3F326564u},
+    {0xD686619Bu,0xA27255A2u,0xC80A537Bu,0x0EFEFEBDu},
+    {0x8613FD01u,0x45877585u,0xBD06742Cu,0xE95F5F36u},
+    {0xA798FC41u,0x96E952E7u,0x2C481138u,0x23B73704u},
+    {0xD17F3B51u,0xFCA3A7A0u,0xF75A1586u,0x2CA504C5u},
+    {0x82EF8513u,0x3DE648C4u,0x9A984D73u,0xDBE722FBu},
+    {0xA3AB6658u,0x0D5FDAF5u,0xC13E60D0u,0xD2E0EBBAu},
+    {0xCC963FEEu,0x10B7D1B3u,0x318DF905u,0x079926A8u},
+    {0xFFBBCFE9u,0x94E5C61Fu,0xFDF17746u,0x497F7052u},
+    {0x9FD561F1u,0xFD0F9BD3u,0xFEB6EA8Bu,0xEDEFA633u},
+    {0xC7CABA6Eu,0x7C5382C8u,0xFE64A52Eu,0xE96B8FC0u},
+    {0xF9BD690Au,0x1B68637Bu,0x3DFDCE7Au,0xA3C673B0u},
+    {0x9C1661A6u,0x51213E2Du,0x06BEA10Cu,0xA65C084Eu},
+    {0xC31BFA0Fu,0xE5698DB8u,0x486E494Fu,0xCFF30A62u},
+    {0xF3E2F893u,0xDEC3F126u,0x5A89DBA3u,0xC3EFCCFAu},
+    {0x986DDB5Cu,0x6B3A76B7u,0xF8962946u,0x5A75E01Cu},
+    {0xBE895233u,0x86091465u,0xF6BBB397u,0xF1135823u},
+    {0xEE2BA6C0u,0x678B597Fu,0x746AA07Du,0xED582E2Cu},
+    {0x94DB4838u,0x40B717EFu,0xA8C2A44Eu,0xB4571CDCu},
+    {0xBA121A46u,0x50E4DDEBu,0x92F34D62u,0x616CE413u},
+    {0xE896A0D7u,0xE51E1566u,0x77B020BAu,0xF9C81D17u},
+    {0x915E2486u,0xEF32CD60u,0x0ACE1474u,0xDC1D122Eu},
+    {0xB5B5ADA8u,0xAAFF80B8u,0x0D819992u,0x132456BAu},
+    {0xE3231912u,0xD5BF60E6u,0x10E1FFF6u,0x97ED6C69u},
+    {0x8DF5EFABu,0xC5979C8Fu,0xCA8D3FFAu,0x1EF463C1u},
+    {0xB1736B96u,0xB6FD83B3u,0xBD308FF8u,0xA6B17CB2u},
+    {0xDDD0467Cu,0x64BCE4A0u,0xAC7CB3F6u,0xD05DDBDEu},
+    {0x8AA22C0Du,0xBEF60EE4u,0x6BCDF07Au,0x423AA96Bu},
+    {0xAD4AB711u,0x2EB3929Du,0x86C16C98u,0xD2C953C6u},
+    {0xD89D64D5u,0x7A607744u,0xE871C7BFu,0x077BA8B7u},
+    {0x87625F05u,0x6C7C4A8Bu,0x11471CD7u,0x64AD4972u},
+    {0xA93AF6C6u,0xC79B5D2Du,0xD598E40Du,0x3DD89BCFu},
+    {0xD389B478u,0x79823479u,0x4AFF1D10u,0x8D4EC2C3u},
+    {0x843610CBu,0x4BF160CBu,0xCEDF722Au,0x585139BAu},
+    {0xA54394FEu,0x1EEDB8FEu,0xC2974EB4u,0xEE658828u},
+    {0xCE947A3Du,0xA6A9273Eu,0x733D2262u,0x29FEEA32u},
+    {0x811CCC66u,0x8829B887u,0x0806357Du,0x5A3F525Fu},
+    {0xA163FF80u,0x2A3426A8u,0xCA07C2DCu,0xB0CF26F7u},
+    {0xC9BCFF60u,0x34C13052u,0xFC89B393u,0xDD02F0B5u},
+    {0xFC2C3F38u,0x41F17C67u,0xBBAC2078u,0xD443ACE2u},
+    {0x9D9BA783u,0x2936EDC0u,0xD54B944Bu,0x84AA4C0Du},
+    {0xC5029163u,0xF384A931u,0x0A9E795Eu,0x65D4DF11u},
+    {0xF64335BCu,0xF065D37Du,0x4D4617B5u,0xFF4A16D5u},
+    {0x99EA0196u,0x163FA42Eu,0x504BCED1u,0xBF8E4E45u},
+    {0xC06481FBu,0x9BCF8D39u,0xE45EC286u,0x2F71E1D6u},
+    {0xF07DA27Au,0x82C37088u,0x5D767327u,0xBB4E5A4Cu},
+    {0x964E858Cu,0x91BA2655u,0x3A6A07F8u,0xD510F86Fu},
+    {0xBBE226EFu,0xB628AFEAu,0x890489F7u,0x0A55368Bu},
+    {0xEADAB0ABu,0xA3B2DBE5u,0x2B45AC74u,0xCCEA842Eu},
+    {0x92C8AE6Bu,0x464FC96Fu,0x3B0B8BC9u,0x0012929Du},
+    {0xB77ADA06u,0x17E3BBCBu,0x09CE6EBBu,0x40173744u},
+    {0xE5599087u,0x9DDCAABDu,0xCC420A6Au,0x101D0515u},
+    {0x8F57FA54u,0xC2A9EAB6u,0x9FA94682u,0x4A12232Du},
+    {0xB32DF8E9u,0xF3546564u,0x47939822u,0xDC96ABF9u},
+    {0xDFF97724u,0x70297EBDu,0x59787E2Bu,0x93BC56F7u},
+    {0x8BFBEA76u,0xC619EF36u,0x57EB4EDBu,0x3C55B65Au},
+    {0xAEFAE514u,0x77A06B03u,0xEDE62292u,0x0B6B23F1u},
+    {0xDAB99E59u,0x958885C4u,0xE95FAB36u,0x8E45ECEDu},
+    {0x88B402F7u,0xFD75539Bu,0x11DBCB02u,0x18EBB414u},
+    {0xAAE103B5u,0xFCD2A881u,0xD652BDC2u,0x9F26A119u},
+    {0xD59944A3u,0x7C0752A2u,0x4BE76D33u,0x46F0495Fu},
+    {0x857FCAE6u,0x2D8493A5u,0x6F70A440u,0x0C562DDBu},
+    {0xA6DFBD9Fu,0xB8E5B88Eu,0xCB4CCD50u,0x0F6BB952u},
+    {0xD097AD07u,0xA71F26B2u,0x7E2000A4u,0x1346A7A7u},
+    {0x825ECC24u,0xC873782Fu,0x8ED40066u,0x8C0C28C8u},
+    {0xA2F67F2Du,0xFA90563Bu,0x72890080u,0x2F0F32FAu},
+    {0xCBB41EF9u,0x79346BCAu,0x4F2B40A0u,0x3AD2FFB9u},
+    {0xFEA126B7u,0xD78186BCu,0xE2F610C8u,0x4987BFA8u},
+    {0x9F24B832u,0xE6B0F436u,0x0DD9CA7Du,0x2DF4D7C9u},
+    {0xC6EDE63Fu,0xA05D3143u,0x91503D1Cu,0x79720DBBu},
+    {0xF8A95FCFu,0x88747D94u,0x75A44C63u,0x97CE912Au},
+    {0x9B69DBE1u,0xB548CE7Cu,0xC986AFBEu,0x3EE11ABAu},
+    {0xC24452DAu,0x229B021Bu,0xFBE85BADu,0xCE996168u},
+    {0xF2D56790u,0xAB41C2A2u,0xFAE27299u,0x423FB9C3u},
+    {0x97C560BAu,0x6B0919A5u,0xDCCD879Fu,0xC967D41Au},
+    {0xBDB6B8E9u,0x05CB600Fu,0x5400E987u,0xBBC1C920u},
+    {0xED246723u,0x473E3813u,0x290123E9u,0xAAB23B68u},
+    {0x9436C076u,0x0C86E30Bu,0xF9A0B672u,0x0AAF6521u},
+    {0xB9447093u,0x8FA89BCEu,0xF808E40Eu,0x8D5B3E69u},
+    {0xE7958CB8u,0x7392C2C2u,0xB60B1D12u,0x30B20E04u},
+    {0x90BD77F3u,0x483BB9B9u,0xB1C6F22Bu,0x5E6F48C2u},
+    {0xB4ECD5F0u,0x1A4AA828u,0x1E38AEB6u,0x360B1AF3u},
+    {0xE2280B6Cu,0x20DD5232u,0x25C6DA63u,0xC38DE1B0u},
+    {0x8D590723u,0x948A535Fu,0x579C487Eu,0x5A38AD0Eu},
+    {0xB0AF48ECu,0x79ACE837u,0x2D835A9Du,0xF0C6D851u},
+    {0xDCDB1B27u,0x98182244u,0xF8E43145u,0x6CF88E65u},
+    {0x8A08F0F8u,0xBF0F156Bu,0x1B8E9ECBu,0x641B58FFu},
+    {0xAC8B2D36u,0xEED2DAC5u,0xE272467Eu,0x3D222F3Fu},
+    {0xD7ADF884u,0xAA879177u,0x5B0ED81Du,0xCC6ABB0Fu},
+    {0x86CCBB52u,0xEA94BAEAu,0x98E94712u,0x9FC2B4E9u},
+    {0xA87FEA27u,0xA539E9A5u,0x3F2398D7u,0x47B36224u},
+    {0xD29FE4B1u,0x8E88640Eu,0x8EEC7F0Du,0x19A03AADu},
+    {0x83A3EEEEu,0xF9153E89u,0x1953CF68u,0x300424ACu},
+    {0xA48CEAAAu,0xB75A8E2Bu,0x5FA8C342u,0x3C052DD7u},
+    {0xCDB02555u,0x653131B6u,0x3792F412u,0xCB06794Du},
+    {0x808E1755u,0x5F3EBF11u,0xE2BBD88Bu,0xBEE40BD0u},
+    {0xA0B19D2Au,0xB70E6ED6u,0x5B6ACEAEu,0xAE9D0EC4u},
+    {0xC8DE0475u,0x64D20A8Bu,0xF245825Au,0x5A445275u},
+    {0xFB158592u,0xBE068D2Eu,0xEED6E2F0u,0xF0D56712u},
+    {0x9CED737Bu,0xB6C4183Du,0x55464DD6u,0x9685606Bu},
+    {0xC428D05Au,0xA4751E4Cu,0xAA97E14Cu,0x3C26B886u},
+    {0xF5330471u,0x4D9265DFu,0xD53DD99Fu,0x4B3066A8u},
+    {0x993FE2C6u,0xD07B7FABu,0xE546A803u,0x8EFE4029u},
+    {0xBF8FDB78u,0x849A5F96u,0xDE985204u,0x72BDD033u},
+    {0xEF73D256u,0xA5C0F77Cu,0x963E6685u,0x8F6D4440u},
+    {0x95A86376u,0x27989AADu,0xDDE70013u,0x79A44AA8u},
+    {0xBB127C53u,0xB17EC159u,0x5560C018u,0x580D5D52u},
+    {0xE9D71B68u,0x9DDE71AFu,0xAAB8F01Eu,0x6E10B4A6u},
+    {0x92267121u,0x62AB070Du,0xCAB39613u,0x04CA70E8u},
+    {0xB6B00D69u,0xBB55C8D1u,0x3D607B97u,0xC5FD0D22u},
+    {0xE45C10C4u,0x2A2B3B05u,0x8CB89A7Du,0xB77C506Au},
+    {0x8EB98A7Au,0x9A5B04E3u,0x77F3608Eu,0x92ADB242u},
+    {0xB267ED19u,0x40F1C61Cu,0x55F038B2u,0x37591ED3u},
+    {0xDF01E85Fu,0x912E37A3u,0x6B6C46DEu,0xC52F6688u},
+    {0x8B61313Bu,0xBABCE2C6u,0x2323AC4Bu,0x3B3DA015u},
+    {0xAE397D8Au,0xA96C1B77u,0xABEC975Eu,0x0A0D081Au},
+    {0xD9C7DCEDu,0x53C72255u,0x96E7BD35u,0x8C904A21u},
+    {0x881CEA14u,0x545C7575u,0x7E50D641u,0x77DA2E54u},
+    {0xAA242499u,0x697392D2u,0xDDE50BD1u,0xD5D0B9E9u},
+    {0xD4AD2DBFu,0xC3D07787u,0x955E4EC6u,0x4B44E864u},
+    {0x84EC3C97u,0xDA624AB4u,0xBD5AF13Bu,0xEF0B113Eu},
+    {0xA6274BBDu,0xD0FADD61u,0xECB1AD8Au,0xEACDD58Eu},
+    {0xCFB11EADu,0x453994BAu,0x67DE18EDu,0xA5814AF2u},
+    {0x81CEB32Cu,0x4B43FCF4u,0x80EACF94u,0x8770CED7u},
+    {0xA2425FF7u,0x5E14FC31u,0xA1258379u,0xA94D028Du},
+    {0xCAD2F7F5u,0x359A3B3Eu,0x096EE458u,0x13A04330u},
+    {0xFD87B5F2u,0x8300CA0Du,0x8BCA9D6Eu,0x188853FCu},
+    {0x9E74D1B7u,0x91E07E48u,0x775EA264u,0xCF55347Eu},
+    {0xC6120625u,0x76589DDAu,0x95364AFEu,0x032A819Eu},
+    {0xF79687AEu,0xD3EEC551u,0x3A83DDBDu,0x83F52205u},
+    {0x9ABE14CDu,0x44753B52u,0xC4926A96u,0x72793543u},
+    {0xC16D9A00u,0x95928A27u,0x75B7053Cu,0x0F178294u},
+    {0xF1C90080u,0xBAF72CB1u,0x5324C68Bu,0x12DD6339u},
+    {0x971DA050u,0x74DA7BEEu,0xD3F6FC16u,0xEBCA5E04u},
+    {0xBCE50864u,0x92111AEAu,0x88F4BB1Cu,0xA6BCF585u},
+    {0xEC1E4A7Du,0xB69561A5u,0x2B31E9E3u,0xD06C32E6u},
+    {0x9392EE8Eu,0x921D5D07u,0x3AFF322Eu,0x62439FD0u},
+    {0xB877AA32u,0x36A4B449u,0x09BEFEB9u,0xFAD487C3u},
+    {0xE69594BEu,0xC44DE15Bu,0x4C2EBE68u,0x7989A9B4u},
+    {0x901D7CF7u,0x3AB0ACD9u,0x0F9D3701u,0x4BF60A11u},
+    {0xB424DC35u,0x095CD80Fu,0x538484C1u,0x9EF38C95u},
+    {0xE12E1342u,0x4BB40E13u,0x2865A5F2u,0x06B06FBAu},
+    {0x8CBCCC09u,0x6F5088CBu,0xF93F87B7u,0x442E45D4u},
+    {0xAFEBFF0Bu,0xCB24AAFEu,0xF78F69A5u,0x1539D749u},
+    {0xDBE6FECEu,0xBDEDD5BEu,0xB573440Eu,0x5A884D1Cu},
+    {0x89705F41u,0x36B4A597u,0x31680A88u,0xF8953031u},
+    {0xABCC7711u,0x8461CEFCu,0xFDC20D2Bu,0x36BA7C3Eu},
+    {0xD6BF94D5u,0xE57A42BCu,0x3D329076u,0x04691B4Du},
+    {0x8637BD05u,0xAF6C69B5u,0xA63F9A49u,0xC2C1B110u},
+    {0xA7C5AC47u,0x1B478423u,0x0FCF80DCu,0x33721D54u},
+    {0xD1B71758u,0xE219652Bu,0xD3C36113u,0x404EA4A9u},
+    {0x83126E97u,0x8D4FDF3Bu,0x645A1CACu,0x083126EAu},
+    {0xA3D70A3Du,0x70A3D70Au,0x3D70A3D7u,0x0A3D70A4u},
+    {0xCCCCCCCCu,0xCCCCCCCCu,0xCCCCCCCCu,0xCCCCCCCDu},
+    {0x80000000u,0x00000000u,0x00000000u,0x00000000u},
+    {0xA0000000u,0x00000000u,0x00000000u,0x00000000u},
+    {0xC8000000u,0x00000000u,0x00000000u,0x00000000u},
+    {0xFA000000u,0x00000000u,0x00000000u,0x00000000u},
+    {0x9C400000u,0x00000000u,0x00000000u,0x00000000u},
+    {0xC3500000u,0x00000000u,0x00000000u,0x00000000u},
+    {0xF4240000u,0x00000000u,0x00000000u,0x00000000u},
+    {0x98968000u,0x00000000u,0x00000000u,0x00000000u},
+    {0xBEBC2000u,0x00000000u,0x00000000u,0x00000000u},
+    {0xEE6B2800u,0x00000000u,0x00000000u,0x00000000u},
+    {0x9502F900u,0x00000000u,0x00000000u,0x00000000u},
+    {0xBA43B740u,0x00000000u,0x00000000u,0x00000000u},
+    {0xE8D4A510u,0x00000000u,0x00000000u,0x00000000u},
+    {0x9184E72Au,0x00000000u,0x00000000u,0x00000000u},
+    {0xB5E620F4u,0x80000000u,0x00000000u,0x00000000u},
+    {0xE35FA931u,0xA0000000u,0x00000000u,0x00000000u},
+    {0x8E1BC9BFu,0x04000000u,0x00000000u,0x00000000u},
+    {0xB1A2BC2Eu,0xC5000000u,0x00000000u,0x00000000u},
+    {0xDE0B6B3Au,0x76400000u,0x00000000u,0x00000000u},
+    {0x8AC72304u,0x89E80000u,0x00000000u,0x00000000u},
+    {0xAD78EBC5u,0xAC620000u,0x00000000u,0x00000000u},
+    {0xD8D726B7u,0x177A8000u,0x00000000u,0x00000000u},
+    {0x87867832u,0x6EAC9000u,0x00000000u,0x00000000u},
+    {0xA968163Fu,0x0A57B400u,0x00000000u,0x00000000u},
+    {0xD3C21BCEu,0xCCEDA100u,0x00000000u,0x00000000u},
+    {0x84595161u,0x401484A0u,0x00000000u,0x00000000u},
+    {0xA56FA5B9u,0x9019A5C8u,0x00000000u,0x00000000u},
+    {0xCECB8F27u,0xF4200F3Au,0x00000000u,0x00000000u},
+    {0x813F3978u,0xF8940984u,0x40000000u,0x00000000u},
+    {0xA18F07D7u,0x36B90BE5u,0x50000000u,0x00000000u},
+    {0xC9F2C9CDu,0x04674EDEu,0xA4000000u,0x00000000u},
+    {0xFC6F7C40u,0x45812296u,0x4D000000u,0x00000000u},
+    {0x9DC5ADA8u,0x2B70B59Du,0xF0200000u,0x00000000u},
+    {0xC5371912u,0x364CE305u,0x6C280000u,0x00000000u},
+    {0xF684DF56u,0xC3E01BC6u,0xC7320000u,0x00000000u},
+    {0x9A130B96u,0x3A6C115Cu,0x3C7F4000u,0x00000000u},
+    {0xC097CE7Bu,0xC90715B3u,0x4B9F1000u,0x00000000u},
+    {0xF0BDC21Au,0xBB48DB20u,0x1E86D400u,0x00000000u},
+    {0x96769950u,0xB50D88F4u,0x13144480u,0x00000000u},
+    {0xBC143FA4u,0xE250EB31u,0x17D955A0u,0x00000000u},
+    {0xEB194F8Eu,0x1AE525FDu,0x5DCFAB08u,0x00000000u},
+    {0x92EFD1B8u,0xD0CF37BEu,0x5AA1CAE5u,0x00000000u},
+    {0xB7ABC627u,0x050305ADu,0xF14A3D9Eu,0x40000000u},
+    {0xE596B7B0u,0xC643C719u,0x6D9CCD05u,0xD0000000u},
+    {0x8F7E32CEu,0x7BEA5C6Fu,0xE4820023u,0xA2000000u},
+    {0xB35DBF82u,0x1AE4F38Bu,0xDDA2802Cu,0x8A800000u},
+    {0xE0352F62u,0xA19E306Eu,0xD50B2037u,0xAD200000u},
+    {0x8C213D9Du,0xA502DE45u,0x4526F422u,0xCC340000u},
+    {0xAF298D05u,0x0E4395D6u,0x9670B12Bu,0x7F410000u},
+    {0xDAF3F046u,0x51D47B4Cu,0x3C0CDD76u,0x5F114000u},
+    {0x88D8762Bu,0xF324CD0Fu,0xA5880A69u,0xFB6AC800u},
+    {0xAB0E93B6u,0xEFEE0053u,0x8EEA0D04u,0x7A457A00u},
+    {0xD5D238A4u,0xABE98068u,0x72A49045u,0x98D6D880u},
+    {0x85A36366u,0xEB71F041u,0x47A6DA2Bu,0x7F864750u},
+    {0xA70C3C40u,0xA64E6C51u,0x999090B6u,0x5F67D924u},
+    {0xD0CF4B50u,0xCFE20765u,0xFFF4B4E3u,0xF741CF6Du},
+    {0x82818F12u,0x81ED449Fu,0xBFF8F10Eu,0x7A8921A4u},
+    {0xA321F2D7u,0x226895C7u,0xAFF72D52u,0x192B6A0Du},
+    {0xCBEA6F8Cu,0xEB02BB39u,0x9BF4F8A6u,0x9F764490u},
+    {0xFEE50B70u,0x25C36A08u,0x02F236D0u,0x4753D5B4u},
+    {0x9F4F2726u,0x179A2245u,0x01D76242u,0x2C946590u},
+    {0xC722F0EFu,0x9D80AAD6u,0x424D3AD2u,0xB7B97EF5u},
+    {0xF8EBAD2Bu,0x84E0D58Bu,0xD2E08987u,0x65A7DEB2u},
+    {0x9B934C3Bu,0x330C8577u,0x63CC55F4u,0x9F88EB2Fu},
+    {0xC2781F49u,0xFFCFA6D5u,0x3CBF6B71u,0xC76B25FBu},
+    {0xF316271Cu,0x7FC3908Au,0x8BEF464Eu,0x3945EF7Au},
+    {0x97EDD871u,0xCFDA3A56u,0x97758BF0u,0xE3CBB5ACu},
+    {0xBDE94E8Eu,0x43D0C8ECu,0x3D52EEEDu,0x1CBEA317u},
+    {0xED63A231u,0xD4C4FB27u,0x4CA7AAA8u,0x63EE4BDDu},
+    {0x945E455Fu,0x24FB1CF8u,0x8FE8CAA9u,0x3E74EF6Au},
+    {0xB975D6B6u,0xEE39E436u,0xB3E2FD53u,0x8E122B44u},
+    {0xE7D34C64u,0xA9C85D44u,0x60DBBCA8u,0x7196B616u},
+    {0x90E40FBEu,0xEA1D3A4Au,0xBC8955E9u,0x46FE31CDu},
+    {0xB51D13AEu,0xA4A488DDu,0x6BABAB63u,0x98BDBE41u},
+    {0xE264589Au,0x4DCDAB14u,0xC696963Cu,0x7EED2DD1u},
+    {0x8D7EB760u,0x70A08AECu,0xFC1E1DE5u,0xCF543CA2u},
+    {0xB0DE6538u,0x8CC8ADA8u,0x3B25A55Fu,0x43294BCBu},
+    {0xDD15FE86u,0xAFFAD912u,0x49EF0EB7u,0x13F39EBEu},
+    {0x8A2DBF14u,0x2DFCC7ABu,0x6E356932u,0x6C784337u},
+    {0xACB92ED9u,0x397BF996u,0x49C2C37Fu,0x07965404u},
+    {0xD7E77A8Fu,0x87DAF7FBu,0xDC33745Eu,0xC97BE906u},
+    {0x86F0AC99u,0xB4E8DAFDu,0x69A028BBu,0x3DED71A3u},
+    {0xA8ACD7C0u,0x222311BCu,0xC40832EAu,0x0D68CE0Cu},
+    {0xD2D80DB0u,0x2AABD62Bu,0xF50A3FA4u,0x90C30190u},
+    {0x83C7088Eu,0x1AAB65DBu,0x792667C6u,0xDA79E0FAu},
+    {0xA4B8CAB1u,0xA1563F52u,0x577001B8u,0x91185938u},
+    {0xCDE6FD5Eu,0x09ABCF26u,0xED4C0226u,0xB55E6F86u},
+    {0x80B05E5Au,0xC60B6178u,0x544F8158u,0x315B05B4u},
+    {0xA0DC75F1u,0x778E39D6u,0x696361AEu,0x3DB1C721u},
+    {0xC913936Du,0xD571C84Cu,0x03BC3A19u,0xCD1E38E9u},
+    {0xFB587849u,0x4ACE3A5Fu,0x04AB48A0u,0x4065C723u},
+    {0x9D174B2Du,0xCEC0E47Bu,0x62EB0D64u,0x283F9C76u},
+    {0xC45D1DF9u,0x42711D9Au,0x3BA5D0BDu,0x324F8394u},
+    {0xF5746577u,0x930D6500u,0xCA8F44ECu,0x7EE36479u},
+    {0x9968BF6Au,0xBBE85F20u,0x7E998B13u,0xCF4E1ECBu},
+    {0xBFC2EF45u,0x6AE276E8u,0x9E3FEDD8u,0xC321A67Eu},
+    {0xEFB3AB16u,0xC59B14A2u,0xC5CFE94Eu,0xF3EA101Eu},
+    {0x95D04AEEu,0x3B80ECE5u,0xBBA1F1D1u,0x58724A12u},
+    {0xBB445DA9u,0xCA61281Fu,0x2A8A6E45u,0xAE8EDC97u},
+    {0xEA157514u,0x3CF97226u,0xF52D09D7u,0x1A3293BDu},
+    {0x924D692Cu,0xA61BE758u,0x593C2626u,0x705F9C56u},
+    {0xB6E0C377u,0xCFA2E12Eu,0x6F8B2FB0u,0x0C77836Cu},
+    {0xE498F455u,0xC38B997Au,0x0B6DFB9Cu,0x0F956447u},
+    {0x8EDF98B5u,0x9A373FECu,0x4724BD41u,0x89BD5EACu},
+    {0xB2977EE3u,0x00C50FE7u,0x58EDEC91u,0xEC2CB657u},
+    {0xDF3D5E9Bu,0xC0F653E1u,0x2F2967B6u,0x6737E3EDu},
+    {0x8B865B21u,0x5899F46Cu,0xBD79E0D2u,0x0082EE74u},
+    {0xAE67F1E9u,0xAEC07187u,0xECD85906u,0x80A3AA11u},
+    {0xDA01EE64u,0x1A708DE9u,0xE80E6F48u,0x20CC9495u},
+    {0x884134FEu,0x908658B2u,0x3109058Du,0x147FDCDDu},
+    {0xAA51823Eu,0x34A7EEDEu,0xBD4B46F0u,0x599FD415u},
+    {0xD4E5E2CDu,0xC1D1EA96u,0x6C9E18ACu,0x7007C91Au},
+    {0x850FADC0u,0x9923329Eu,0x03E2CF6Bu,0xC604DDB0u},
+    {0xA6539930u,0xBF6BFF45u,0x84DB8346u,0xB786151Cu},
+    {0xCFE87F7Cu,0xEF46FF16u,0xE6126418u,0x65679A63u},
+    {0x81F14FAEu,0x158C5F6Eu,0x4FCB7E8Fu,0x3F60C07Eu},
+    {0xA26DA399u,0x9AEF7749u,0xE3BE5E33u,0x0F38F09Du},
+    {0xCB090C80u,0x01AB551Cu,0x5CADF5BFu,0xD3072CC5u},
+    {0xFDCB4FA0u,0x02162A63u,0x73D9732Fu,0xC7C8F7F6u},
+    {0x9E9F11C4u,0x014DDA7Eu,0x2867E7FDu,0xDCDD9AFAu},
+    {0xC646D635u,0x01A1511Du,0xB281E1FDu,0x541501B8u},
+    {0xF7D88BC2u,0x4209A565u,0x1F225A7Cu,0xA91A4226u},
+    {0x9AE75759u,0x6946075Fu,0x3375788Du,0xE9B06958u},
+    {0xC1A12D2Fu,0xC3978937u,0x0052D6B1u,0x641C83AEu},
+    {0xF209787Bu,0xB47D6B84u,0xC0678C5Du,0xBD23A49Au},
+    {0x9745EB4Du,0x50CE6332u,0xF840B7BAu,0x963646E0u},
+    {0xBD176620u,0xA501FBFFu,0xB650E5A9u,0x3BC3D898u},
+    {0xEC5D3FA8u,0xCE427AFFu,0xA3E51F13u,0x8AB4CEBEu},
+    {0x93BA47C9u,0x80E98CDFu,0xC66F336Cu,0x36B10137u},
+    {0xB8A8D9BBu,0xE123F017u,0xB80B0047u,0x445D4184u},
+    {0xE6D3102Au,0xD96CEC1Du,0xA60DC059u,0x157491E5u},
+    {0x9043EA1Au,0xC7E41392u,0x87C89837u,0xAD68DB2Fu},
+    {0xB454E4A1u,0x79DD1877u,0x29BABE45u,0x98C311FBu},
+    {0xE16A1DC9u,0xD8545E94u,0xF4296DD6u,0xFEF3D67Au},
+    {0x8CE2529Eu,0x2734BB1Du,0x1899E4A6u,0x5F58660Cu},
+    {0xB01AE745u,0xB101E9E4u,0x5EC05DCFu,0xF72E7F8Fu},
+    {0xDC21A117u,0x1D42645Du,0x76707543u,0xF4FA1F73u},
+    {0x899504AEu,0x72497EBAu,0x6A06494Au,0x791C53A8u},
+    {0xABFA45DAu,0x0EDBDE69u,0x0487DB9Du,0x17636892u},
+    {0xD6F8D750u,0x9292D603u,0x45A9D284u,0x5D3C42B6u},
+    {0x865B8692u,0x5B9BC5C2u,0x0B8A2392u,0xBA45A9B2u},
+    {0xA7F26836u,0xF282B732u,0x8E6CAC77u,0x68D7141Eu},
+    {0xD1EF0244u,0xAF2364FFu,0x3207D795u,0x430CD926u},
+    {0x8335616Au,0xED761F1Fu,0x7F44E6BDu,0x49E807B8u},
+    {0xA402B9C5u,0xA8D3A6E7u,0x5F16206Cu,0x9C6209A6u},
+    {0xCD036837u,0x130890A1u,0x36DBA887u,0xC37A8C0Fu},
+    {0x80222122u,0x6BE55A64u,0xC2494954u,0xDA2C9789u},
+    {0xA02AA96Bu,0x06DEB0FDu,0xF2DB9BAAu,0x10B7BD6Cu},
+    {0xC83553C5u,0xC8965D3Du,0x6F928294u,0x94E5ACC7u},
+    {0xFA42A8B7u,0x3ABBF48Cu,0xCB772339u,0xBA1F17F9u},
+    {0x9C69A972u,0x84B578D7u,0xFF2A7604u,0x14536EFBu},
+    {0xC38413CFu,0x25E2D70Du,0xFEF51385u,0x19684ABAu},
+    {0xF46518C2u,0xEF5B8CD1u,0x7EB25866u,0x5FC25D69u},
+    {0x98BF2F79u,0xD5993802u,0xEF2F773Fu,0xFBD97A61u},
+    {0xBEEEFB58u,0x4AFF8603u,0xAAFB550Fu,0xFACFD8FAu},
+    {0xEEAABA2Eu,0x5DBF6784u,0x95BA2A53u,0xF983CF38u},
+    {0x952AB45Cu,0xFA97A0B2u,0xDD945A74u,0x7BF26183u},
+    {0xBA756174u,0x393D88DFu,0x94F97111u,0x9AEEF9E4u},
+    {0xE912B9D1u,0x478CEB17u,0x7A37CD56u,0x01AAB85Du},
+    {0x91ABB422u,0xCCB812EEu,0xAC62E055u,0xC10AB33Au},
+    {0xB616A12Bu,0x7FE617AAu,0x577B986Bu,0x314D6009u},
+    {0xE39C4976u,0x5FDF9D94u,0xED5A7E85u,0xFDA0B80Bu},
+    {0x8E41ADE9u,0xFBEBC27Du,0x14588F13u,0xBE847307u},
+    {0xB1D21964u,0x7AE6B31Cu,0x596EB2D8u,0xAE258FC8u},
+    {0xDE469FBDu,0x99A05FE3u,0x6FCA5F8Eu,0xD9AEF3BBu},
+    {0x8AEC23D6u,0x80043BEEu,0x25DE7BB9u,0x480D5854u},
+    {0xADA72CCCu,0x20054AE9u,0xAF561AA7u,0x9A10AE6Au},
+    {0xD910F7FFu,0x28069DA4u,0x1B2BA151u,0x8094DA04u},
+    {0x87AA9AFFu,0x79042286u,0x90FB44D2u,0xF05D0842u},
+    {0xA99541BFu,0x57452B28u,0x353A1607u,0xAC744A53u},
+    {0xD3FA922Fu,0x2D1675F2u,0x42889B89u,0x97915CE8u},
+    {0x847C9B5Du,0x7C2E09B7u,0x69956135u,0xFEBADA11u},
+    {0xA59BC234u,0xDB398C25u,0x43FAB983u,0x7E699095u},
+    {0xCF02B2C2u,0x1207EF2Eu,0x94F967E4u,0x5E03F4BBu},
+    {0x8161AFB9u,0x4B44F57Du,0x1D1BE0EEu,0xBAC278F5u},
+    {0xA1BA1BA7u,0x9E1632DCu,0x6462D92Au,0x69731732u},
+    {0xCA28A291u,0x859BBF93u,0x7D7B8F75u,0x03CFDCFEu},
+    {0xFCB2CB35u,0xE702AF78u,0x5CDA7352u,0x44C3D43Eu},
+    {0x9DEFBF01u,0xB061ADABu,0x3A088813u,0x6AFA64A7u},
+    {0xC56BAEC2u,0x1C7A1916u,0x088AAA18u,0x45B8FDD0u},
+    {0xF6C69A72u,0xA3989F5Bu,0x8AAD549Eu,0x57273D45u},
+    {0x9A3C2087u,0xA63F6399u,0x36AC54E2u,0xF678864Bu},
+    {0xC0CB28A9u,0x8FCF3C7Fu,0x84576A1Bu,0xB416A7DDu},
+    {0xF0FDF2D3u,0xF3C30B9Fu,0x656D44A2u,0xA11C51D5u},
+    {0x969EB7C4u,0x7859E743u,0x9F644AE5u,0xA4B1B325u},
+    {0xBC4665B5u,0x96706114u,0x873D5D9Fu,0x0DDE1FEEu},
+    {0xEB57FF22u,0xFC0C7959u,0xA90CB506u,0xD155A7EAu},
+    {0x9316FF75u,0xDD87CBD8u,0x09A7F124u,0x42D588F2u},
+    {0xB7DCBF53u,0x54E9BECEu,0x0C11ED6Du,0x538AEB2Fu},
+    {0xE5D3EF28u,0x2A242E81u,0x8F1668C8u,0xA86DA5FAu},
+    {0x8FA47579u,0x1A569D10u,0xF96E017Du,0x694487BCu},
+    {0xB38D92D7u,0x60EC4455u,0x37C981DCu,0xC395A9ACu},
+    {0xE070F78Du,0x3927556Au,0x85BBE253u,0xF47B1417u},
+    {0x8C469AB8u,0x43B89562u,0x93956D74u,0x78CCEC8Eu},
+    {0xAF584166u,0x54A6BABBu,0x387AC8D1u,0x970027B2u},
+    {0xDB2E51BFu,0xE9D0696Au,0x06997B05u,0xFCC0319Eu},
+    {0x88FCF317u,0xF22241E2u,0x441FECE3u,0xBDF81F03u},
+    {0xAB3C2FDDu,0xEEAAD25Au,0xD527E81Cu,0xAD7626C3u},
+    {0xD60B3BD5u,0x6A5586F1u,0x8A71E223u,0xD8D3B074u},
+    {0x85C70565u,0x62757456u,0xF6872D56u,0x67844E49u},
+    {0xA738C6BEu,0xBB12D16Cu,0xB428F8ACu,0x016561DBu},
+    {0xD106F86Eu,0x69D785C7u,0xE13336D7u,0x01BEBA52u},
+    {0x82A45B45u,0x0226B39Cu,0xECC00246u,0x61173473u},
+    {0xA34D7216u,0x42B06084u,0x27F002D7u,0xF95D0190u},
+    {0xCC20CE9Bu,0xD35C78A5u,0x31EC038Du,0xF7B441F4u},
+    {0xFF290242u,0xC83396CEu,0x7E670471u,0x75A15271u},
+    {0x9F79A169u,0xBD203E41u,0x0F0062C6u,0xE984D386u},
+    {0xC75809C4u,0x2C684DD1u,0x52C07B78u,0xA3E60868u},
+    {0xF92E0C35u,0x37826145u,0xA7709A56u,0xCCDF8A82u},
+    {0x9BBCC7A1u,0x42B17CCBu,0x88A66076u,0x400BB691u},
+    {0xC2ABF989u,0x935DDBFEu,0x6ACFF893u,0xD00EA435u},
+    {0xF356F7EBu,0xF83552FEu,0x0583F6B8u,0xC4124D43u},
+    {0x98165AF3u,0x7B2153DEu,0xC3727A33u,0x7A8B704Au},
+    {0xBE1BF1B0u,0x59E9A8D6u,0x744F18C0u,0x592E4C5Cu},
+    {0xEDA2EE1Cu,0x7064130Cu,0x1162DEF0u,0x6F79DF73u},
+    {0x9485D4D1u,0xC63E8BE7u,0x8ADDCB56u,0x45AC2BA8u},
+    {0xB9A74A06u,0x37CE2EE1u,0x6D953E2Bu,0xD7173692u},
+    {0xE8111C87u,0xC5C1BA99u,0xC8FA8DB6u,0xCCDD0437u},
+    {0x910AB1D4u,0xDB9914A0u,0x1D9C9892u,0x400A22A2u},
+    {0xB54D5E4Au,0x127F59C8u,0x2503BEB6u,0xD00CAB4Bu},
+    {0xE2A0B5DCu,0x971F303Au,0x2E44AE64u,0x840FD61Du},
+    {0x8DA471A9u,0xDE737E24u,0x5CEAECFEu,0xD289E5D2u},
+    {0xB10D8E14u,0x56105DADu,0x7425A83Eu,0x872C5F47u},
+    {0xDD50F199u,0x6B947518u,0xD12F124Eu,0x28F77719u},
+    {0x8A5296FFu,0xE33CC92Fu,0x82BD6B70u,0xD99AAA6Fu},
+    {0xACE73CBFu,0xDC0BFB7Bu,0x636CC64Du,0x1001550Bu},
+    {0xD8210BEFu,0xD30EFA5Au,0x3C47F7E0u,0x5401AA4Eu},
+    {0x8714A775u,0xE3E95C78u,0x65ACFAECu,0x34810A71u},
+    {0xA8D9D153u,0x5CE3B396u,0x7F1839A7u,0x41A14D0Du},
+    {0xD31045A8u,0x341CA07Cu,0x1EDE4811u,0x1209A050u},
+    {0x83EA2B89u,0x2091E44Du,0x934AED0Au,0xAB460432u},
+    {0xA4E4B66Bu,0x68B65D60u,0xF81DA84Du,0x5617853Fu},
+    {0xCE1DE406u,0x42E3F4B9u,0x36251260u,0xAB9D668Eu},
+    {0x80D2AE83u,0xE9CE78F3u,0xC1D72B7Cu,0x6B426019u},
+    {0xA1075A24u,0xE4421730u,0xB24CF65Bu,0x8612F81Fu},
+    {0xC94930AEu,0x1D529CFCu,0xDEE033F2u,0x6797B627u},
+    {0xFB9B7CD9u,0xA4A7443Cu,0x169840EFu,0x017DA3B1u},
+    {0x9D412E08u,0x06E88AA5u,0x8E1F2895u,0x60EE864Eu},
+    {0xC491798Au,0x08A2AD4Eu,0xF1A6F2BAu,0xB92A27E2u},
+    {0xF5B5D7ECu,0x8ACB58A2u,0xAE10AF69u,0x6774B1DBu},
+    {0x9991A6F3u,0xD6BF1765u,0xACCA6DA1u,0xE0A8EF29u},
+    {0xBFF610B0u,0xCC6EDD3Fu,0x17FD090Au,0x58D32AF3u},
+    {0xEFF394DCu,0xFF8A948Eu,0xDDFC4B4Cu,0xEF07F5B0u},
+    {0x95F83D0Au,0x1FB69CD9u,0x4ABDAF10u,0x1564F98Eu},
+    {0xBB764C4Cu,0xA7A4440Fu,0x9D6D1AD4u,0x1ABE37F1u},
+    {0xEA53DF5Fu,0xD18D5513u,0x84C86189u,0x216DC5EDu},
+    {0x92746B9Bu,0xE2F8552Cu,0x32FD3CF5u,0xB4E49BB4u},
+    {0xB7118682u,0xDBB66A77u,0x3FBC8C33u,0x221DC2A1u},
+    {0xE4D5E823u,0x92A40515u,0x0FABAF3Fu,0xEAA5334Au},
+    {0x8F05B116u,0x3BA6832Du,0x29CB4D87u,0xF2A7400Eu},
+    {0xB2C71D5Bu,0xCA9023F8u,0x743E20E9u,0xEF511012u},
+    {0xDF78E4B2u,0xBD342CF6u,0x914DA924u,0x6B255416u},
+    {0x8BAB8EEFu,0xB6409C1Au,0x1AD089B6u,0xC2F7548Eu},
+    {0xAE9672ABu,0xA3D0C320u,0xA184AC24u,0x73B529B1u},
+    {0xDA3C0F56u,0x8CC4F3E8u,0xC9E5D72Du,0x90A2741Eu},
+    {0x88658996u,0x17FB1871u,0x7E2FA67Cu,0x7A658892u},
+    {0xAA7EEBFBu,0x9DF9DE8Du,0xDDBB901Bu,0x98FEEAB7u},
+    {0xD51EA6FAu,0x85785631u,0x552A7422u,0x7F3EA565u},
+    {0x8533285Cu,0x936B35DEu,0xD53A8895u,0x8F87275Fu},
+    {0xA67FF273u,0xB8460356u,0x8A892ABAu,0xF368F137u},
+    {0xD01FEF10u,0xA657842Cu,0x2D2B7569u,0xB0432D85u},
+    {0x8213F56Au,0x67F6B29Bu,0x9C3B2962u,0x0E29FC73u},
+    {0xA298F2C5u,0x01F45F42u,0x8349F3BAu,0x91B47B8Fu},
+    {0xCB3F2F76u,0x42717713u,0x241C70A9u,0x36219A73u},
+    {0xFE0EFB53u,0xD30DD4D7u,0xED238CD3u,0x83AA0110u},
+    {0x9EC95D14u,0x63E8A506u,0xF4363804u,0x324A40AAu},
+    {0xC67BB459u,0x7CE2CE48u,0xB143C605u,0x3EDCD0D5u},
+    {0xF81AA16Fu,0xDC1B81DAu,0xDD94B786u,0x8E94050Au},
+    {0x9B10A4E5u,0xE9913128u,0xCA7CF2B4u,0x191C8326u},
+    {0xC1D4CE1Fu,0x63F57D72u,0xFD1C2F61u,0x1F63A3F0u},
+    {0xF24A01A7u,0x3CF2DCCFu,0xBC633B39u,0x673C8CECu},
+    {0x976E4108u,0x8617CA01u,0xD5BE0503u,0xE085D813u},
+    {0xBD49D14Au,0xA79DBC82u,0x4B2D8644u,0xD8A74E18u},
+    {0xEC9C459Du,0x51852BA2u,0xDDF8E7D6u,0x0ED1219Eu},
+    {0x93E1AB82u,0x52F33B45u,0xCABB90E5u,0xC942B503u},
+    {0xB8DA1662u,0xE7B00A17u,0x3D6A751Fu,0x3B936243u},
+    {0xE7109BFBu,0xA19C0C9Du,0x0CC51267u,0x0A783AD4u},
+    {0x906A617Du,0x450187E2u,0x27FB2B80u,0x668B24C5u},
+    {0xB484F9DCu,0x9641E9DAu,0xB1F9F660u,0x802DEDF6u},
+    {0xE1A63853u,0xBBD26451u,0x5E7873F8u,0xA0396973u},
+    {0x8D07E334u,0x55637EB2u,0xDB0B487Bu,0x6423E1E8u},
+    {0xB049DC01u,0x6ABC5E5Fu,0x91CE1A9Au,0x3D2CDA62u},
+    {0xDC5C5301u,0xC56B75F7u,0x7641A140u,0xCC7810FBu},
+    {0x89B9B3E1u,0x1B6329BAu,0xA9E904C8u,0x7FCB0A9Du},
+    {0xAC2820D9u,0x623BF429u,0x546345FAu,0x9FBDCD44u},
+    {0xD732290Fu,0xBACAF133u,0xA97C1779u,0x47AD4095u},
+    {0x867F59A9u,0xD4BED6C0u,0x49ED8EABu,0xCCCC485Du},
+    {0xA81F3014u,0x49EE8C70u,0x5C68F256u,0xBFFF5A74u},
+    {0xD226FC19u,0x5C6A2F8Cu,0x73832EECu,0x6FFF3111u},
+    {0x83585D8Fu,0xD9C25DB7u,0xC831FD53u,0xC5FF7EABu},
+    {0xA42E74F3u,0xD032F525u,0xBA3E7CA8u,0xB77F5E55u},
+    {0xCD3A1230u,0xC43FB26Fu,0x28CE1BD2u,0xE55F35EBu},
+    {0x80444B5Eu,0x7AA7CF85u,0x7980D163u,0xCF5B81B3u},
+    {0xA0555E36u,0x1951C366u,0xD7E105BCu,0xC332621Fu},
+    {0xC86AB5C3u,0x9FA63440u,0x8DD9472Bu,0xF3FEFAA7u},
+    {0xFA856334u,0x878FC150u,0xB14F98F6u,0xF0FEB951u},
+    {0x9C935E00u,0xD4B9D8D2u,0x6ED1BF9Au,0x569F33D3u},
+    {0xC3B83581u,0x09E84F07u,0x0A862F80u,0xEC4700C8u},
+    {0xF4A642E1u,0x4C6262C8u,0xCD27BB61u,0x2758C0FAu},
+    {0x98E7E9CCu,0xCFBD7DBDu,0x8038D51Cu,0xB897789Cu},
+    {0xBF21E440u,0x03ACDD2Cu,0xE0470A63u,0xE6BD56C3u},
+    {0xEEEA5D50u,0x04981478u,0x1858CCFCu,0xE06CAC74u},
+    {0x95527A52u,0x02DF0CCBu,0x0F37801Eu,0x0C43EBC8u},
+    {0xBAA718E6u,0x8396CFFDu,0xD3056025u,0x8F54E6BAu},
+    {0xE950DF20u,0x247C83FDu,0x47C6B82Eu,0xF32A2069u},
+    {0x91D28B74u,0x16CDD27Eu,0x4CDC331Du,0x57FA5441u},
+    {0xB6472E51u,0x1C81471Du,0xE0133FE4u,0xADF8E952u},
+    {0xE3D8F9E5u,0x63A198E5u,0x58180FDDu,0xD97723A6u},
+    {0x8E679C2Fu,0x5E44FF8Fu,0x570F09EAu,0xA7EA7648u},
+    {0xB201833Bu,0x35D63F73u,0x2CD2CC65u,0x51E513DAu},
+    {0xDE81E40Au,0x034BCF4Fu,0xF8077F7Eu,0xA65E58D1u},
+    {0x8B112E86u,0x420F6191u,0xFB04AFAFu,0x27FAF782u},
+    {0xADD57A27u,0xD29339F6u,0x79C5DB9Au,0xF1F9B563u},
+    {0xD94AD8B1u,0xC7380874u,0x18375281u,0xAE7822BCu},
+    {0x87CEC76Fu,0x1C830548u,0x8F229391u,0x0D0B15B5u},
+    {0xA9C2794Au,0xE3A3C69Au,0xB2EB3875u,0x504DDB22u},
+    {0xD433179Du,0x9C8CB841u,0x5FA60692u,0xA46151EBu},
+    {0x849FEEC2u,0x81D7F328u,0xDBC7C41Bu,0xA6BCD333u},
+    {0xA5C7EA73u,0x224DEFF3u,0x12B9B522u,0x906C0800u},
+    {0xCF39E50Fu,0xEAE16BEFu,0xD768226Bu,0x34870A00u},
+    {0x81842F29u,0xF2CCE375u,0xE6A11583u,0x00D46640u},
+    {0xA1E53AF4u,0x6F801C53u,0x60495AE3u,0xC1097FD0u},
+    {0xCA5E89B1u,0x8B602368u,0x385BB19Cu,0xB14BDFC4u},
+    {0xFCF62C1Du,0xEE382C42u,0x46729E03u,0xDD9ED7B5u},
+    {0x9E19DB92u,0xB4E31BA9u,0x6C07A2C2u,0x6A8346D1u}
+};
+
+/* returns the number of leading zero bits of a non zero value */
+JSON_INTERN int
+json_clz(json_uint64 x)
 {
-    long res = 1;
-    while (exp) {
-        if (exp & 1)
-            res *= base;
-        exp >>= 1;
-        base *= base;
-    }
-    return (json_number)res;
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanReverse64(&i, x);
+    return 63 - (int)i;
+#else
+    int n = 0;
+    while (!(x & ((json_uint64)0xFF << 56))) {x <<= 8; n += 8;}
+    while (!(x & ((json_uint64)1 << 63))) {x <<= 1; n++;}
+    return n;
+#endif
 }
 
-/* converts a token containing a integer value into a number */
-JSON_INTERN json_number
-json_stoi(struct json_token *tok)
+/* full 64x64 bit into 128 bit multiplication */
+JSON_INTERN void
+json_mul128(json_uint64 a, json_uint64 b, json_uint64 *hi, json_uint64 *lo)
 {
-    json_number n = 0;
-    int i = 0;
-    int off;
-    int neg;
-    if (!tok->str || !tok->len)
-        return 0;
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 json_uint128;
+    json_uint128 r = (json_uint128)a * b;
+    *hi = (json_uint64)(r >> 64);
+    *lo = (json_uint64)r;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *lo = _umul128(a, b, hi);
+#else
+    const json_uint64 mask = 0xFFFFFFFFu;
+    json_uint64 p00 = (a & mask) * (b & mask);
+    json_uint64 p01 = (a & mask) * (b >> 32);
+    json_uint64 p10 = (a >> 32) * (b & mask);
+    json_uint64 p11 = (a >> 32) * (b >> 32);
+    json_uint64 mid = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+    *lo = (mid << 32) | (p00 & mask);
+    *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+}
+
+/* converts w * 10^q into the nearest double by the Eisel-Lemire algorithm.
+ * The result is correctly rounded for every w with up to 19 digits. */
+JSON_INTERN double
+json_lemire(json_uint64 w, int q)
+{
+    int lz, upper, power2;
+    const unsigned int *p;
+    json_uint64 hi, lo, hi2, lo2, mantissa;
+    union {json_uint64 u; double d;} r;
+
+    r.u = 0;
+    if (!w || q < JSON_POW5_MIN)
+        return r.d;
+    if (q > JSON_POW5_MAX) {
+        r.u = (json_uint64)0x7FF << 52;
+        return r.d;
+    }
+
+    lz = json_clz(w);
+    w <<= lz;
+    p = json_pow5[q - JSON_POW5_MIN];
+    json_mul128(w, ((json_uint64)p[0] << 32) | p[1], &hi, &lo);
+    if ((hi & 0x1FF) == 0x1FF) {
+        /* lower bits are not precise enough so add the second product */
+        json_mul128(w, ((json_uint64)p[2] << 32) | p[3], &hi2, &lo2);
+        lo += hi2;
+        if (hi2 > lo) hi++;
+    }
+
+    /* power2 = floor(q * log2(10)) + 63 + upper - lz + bias */
+    upper = (int)(hi >> 63);
+    mantissa = hi >> (upper + 9);
+    power2 = (q < 0) ? -((-217706 * q + 65535) >> 16): ((217706 * q) >> 16);
+    power2 += 63 + upper - lz + 1023;
 
-    off = (tok->str[0] == '-' || tok->str[0] == '+') ? 1 : 0;
-    neg = (tok->str[0] == '-') ? 1 : 0;
-    for (i = off; i < tok->len; i++) {
-        if ((tok->str[i] >= '0') && (tok->str[i] <= '9'))
-            n = (n * 10) + tok->str[i]  - '0';
+    if (power2 <= 0) {
+        /* subnormal number */
+        if (-power2 + 1 >= 64)
+            return r.d;
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        power2 = (mantissa < ((json_uint64)1 << 52)) ? 0: 1;
+        r.u = mantissa | ((json_uint64)power2 << 52);
+        return r.d;
     }
-    return (neg) ? -n : n;
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1) {
+        /* exactly halfway between two doubles: round to even */
+        if ((mantissa << (upper + 9)) == hi)
+            mantissa &= ~(json_uint64)1;
+    }
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= ((json_uint64)2 << 52)) {
+        mantissa = (json_uint64)1 << 52;
+        power2++;
+    }
+    mantissa &= ~((json_uint64)1 << 52);
+    if (power2 >= 0x7FF) {
+        r.u = (json_uint64)0x7FF << 52;
+        return r.d;
+    }
+    r.u = mantissa | ((json_uint64)power2 << 52);
+    return r.d;
 }
 
-/* converts a token containing a real value into a floating point number */
-JSON_INTERN json_number
-json_stof(struct json_token *tok)
+/* arbitrary precision unsigned integer big enough to hold 768 decimal
+ * digits scaled by the largest power of five or two needed for a double */
+#define JSON_BIGINT_LIMBS 100
+#define JSON_BIGINT_DIGITS 768
+struct json_bigint {
+    unsigned int limb[JSON_BIGINT_LIMBS];
+    /* 32-bit limbs with the least significant first */
+    int len;
+    /* number of used limbs */
+};
+
+JSON_INTERN void
+json_big_muladd(struct json_bigint *b, unsigned int mul, unsigned int add)
 {
-    int i = 0;
-    json_number n = 0;
-    json_number f = 0.1;
-    if (!tok->str || !tok->len) return 0;
-    for (i = 0; i < tok->len; i++) {
-        if ((tok->str[i] >= '0') && (tok->str[i] <= '9')) {
-            n = n + (tok->str[i] - '0') * f;
-            f *= 0.1;
-        }
+    int i;
+    json_uint64 carry = add;
+    for (i = 0; i < b->len; ++i) {
+        carry += (json_uint64)b->limb[i] * mul;
+        b->limb[i] = (unsigned int)(carry & 0xFFFFFFFFu);
+        carry >>= 32;
+    }
+    if (carry) {
+        JSON_ASSERT(b->len < JSON_BIGINT_LIMBS);
+        b->limb[b->len++] = (unsigned int)carry;
     }
-    return n;
 }
 
-/* compares a size limited string with a string inside a token */
+JSON_INTERN void
+json_big_pow5(struct json_bigint *b, int n)
+{
+    static const unsigned int pow5[] = {1,5,25,125,625,3125,15625,78125,
+        390625,1953125,9765625,48828125,244140625,1220703125};
+    for (; n >= 13; n -= 13)
+        json_big_muladd(b, pow5[13], 0);
+    if (n) json_big_muladd(b, pow5[n], 0);
+}
+
+JSON_INTERN void
+json_big_shl(struct json_bigint *b, int n)
+{
+    int i, limbs = n / 32, bits = n % 32;
+    if (!b->len || n <= 0) return;
+    JSON_ASSERT(b->len + limbs < JSON_BIGINT_LIMBS);
+    for (i = b->len; i >= 0; --i) {
+        unsigned int hi = (i < b->len) ? b->limb[i]: 0;
+        unsigned int lo = (i > 0) ? b->limb[i-1]: 0;
+        b->limb[i + limbs] = (!bits) ? hi:
+            ((hi << bits) | (lo >> (32 - bits))) & 0xFFFFFFFFu;
+    }
+    for (i = 0; i < limbs; ++i)
+        b->limb[i] = 0;
+    b->len += limbs + 1;
+    while (b->len && !b->limb[b->len-1])
+        b->len--;
+}
+
 JSON_INTERN int
-json_lcmp(const struct json_token* tok, const char* str, int len)
+json_big_cmp(const struct json_bigint *a, const struct json_bigint *b)
 {
     int i;
-    JSON_ASSERT(tok);
-    JSON_ASSERT(str);
-    if (!tok || !str || !len) return 1;
-    for (i = 0; (i < tok->len && i < len); i++, str++){
-        if (tok->str[i] != *str)
-            return 1;
+    if (a->len != b->len)
+        return (a->len < b->len) ? -1: 1;
+    for (i = a->len - 1; i >= 0; --i) {
+        if (a->limb[i] != b->limb[i])
+            return (a->limb[i] < b->limb[i]) ? -1: 1;
     }
     return 0;
 }
 
-/*--------------------------------------------------------------------------
- *
-                                UTILITY
-
-  -------------------------------------------------------------------------*/
-JSON_API int
-json_convert(json_number *num, const struct json_token *tok)
+/* decides between a positive double `lower` and its successor for the
+ * decimal number in [str,end) by comparing all its digits exactly
+ * against the halfway point between both doubles */
+JSON_INTERN double
+json_decide(const char *str, const char *end, double lower)
 {
-    int len;
-    const char *cur;
-    json_number i, f, e, p;
-    enum {INT, FLT, EXP, TOKS};
-    struct json_token nums[TOKS];
-    struct json_token *write = &nums[INT];
+    int e, cmp, shift;
+    int exp10 = 0, count = 0, sticky = 0, frac = 0;
+    struct json_bigint digits, halfway;
+    json_uint64 m;
+    union {json_uint64 u; double d;} r;
 
-    JSON_ASSERT(num);
-    JSON_ASSERT(tok);
-    if (!num || !tok || !tok->str || !tok->len)
-        return JSON_NONE;
+    /* digits = all significant decimal digits, value = digits * 10^exp10 */
+    digits.len = 0;
+    for (; str < end; ++str) {
+        if (*str == '.') {frac = 1; continue;}
+        if (*str < '0' || *str > '9') break;
+        if (!count && *str == '0') {
+            exp10 -= frac;
+            continue;
+        }
+        if (count < JSON_BIGINT_DIGITS) {
+            json_big_muladd(&digits, 10, (unsigned int)(*str - '0'));
+            exp10 -= frac;
+            count++;
+        } else {
+            sticky |= (*str != '0');
+            exp10 += !frac;
+        }
+    }
+    if (str < end && (*str == 'e' || *str == 'E')) {
+        int x = 0, neg = 0;
+        if (++str < end && (*str == '-' || *str == '+'))
+            neg = (*str++ == '-');
+        for (; str < end && *str >= '0' && *str <= '9'; ++str)
+            if (x < 100000) x = x * 10 + (*str - '0');
+        exp10 += (neg) ? -x: x;
+    }
 
-    nums[INT] = JSON_TOKEN_NULL;
-    nums[FLT] = JSON_TOKEN_NULL;
-    nums[EXP] = JSON_TOKEN_NULL;
-    len = tok->len;
-    write->str = tok->str;
-
-    for (cur = tok->str; len; cur++, len--) {
-        char state =  json_go_num[*(const unsigned char*)cur];
-        switch (state) {
-            case JSON_STATE_NUM_FAILED: {
-                return JSON_NONE;
-            } break;
-            case JSON_STATE_NUM_FLT: {
-                if (nums[FLT].str)
-                    return JSON_NONE;
-                if (nums[EXP].str)
-                    return JSON_NONE;
-                write->len = (int)(cur - write->str);
-                write = &nums[FLT];
-                write->str = cur + 1;
-            } break;
-            case JSON_STATE_NUM_EXP: {
-                if (nums[EXP].str)
-                    return JSON_NONE;
-                write->len = (int)(cur - write->str);
-                write = &nums[EXP];
-                write->str = cur + 1;
-            } break;
-            case JSON_STATE_NUM_BREAK: {
-                len = 1;
-            } break;
-            default: break;
-        }
-    }
-    write->len = (int)(cur - write->str);
-
-    i = json_stoi(&nums[INT]);
-    f = json_stof(&nums[FLT]);
-    e = json_stoi(&nums[EXP]);
-    p = json_ipow(10, (unsigned)((e < 0) ? -e : e));
-    if (e < 0) p = (1 / p);
-    *num = (i + ((i < 0) ? -f : f)) * p;
-    return JSON_NUMBER;
+    /* halfway = (2m+1) * 2^(e-1) with lower = m * 2^e */
+    r.d = lower;
+    e = (int)((r.u >> 52) & 0x7FF);
+    m = r.u & (((json_uint64)1 << 52) - 1);
+    if (e) m |= (json_uint64)1 << 52;
+    e = (e ? e: 1) - 1075;
+    m = 2 * m + 1;
+    halfway.limb[0] = (unsigned int)(m & 0xFFFFFFFFu);
+    halfway.limb[1] = (unsigned int)(m >> 32);
+    halfway.len = (halfway.limb[1]) ? 2: 1;
+
+    /* bring both sides to integers of the same power of two and five */
+    if (exp10 >= 0)
+        json_big_pow5(&digits, exp10);
+    else json_big_pow5(&halfway, -exp10);
+    shift = exp10 - (e - 1);
+    if (shift > 0)
+        json_big_shl(&digits, shift);
+    else json_big_shl(&halfway, -shift);
+
+    cmp = json_big_cmp(&digits, &halfway);
+    if (!cmp) cmp = (sticky) ? 1: (int)((r.u & 1) ? 1: -1);
+    if (cmp > 0) r.u++;
+    return r.d;
 }
 
-JSON_API int
-json_cpy(char *dst, int max, const struct json_token* tok)
+/* returns true if all eight characters are decimal digits */
+JSON_INTERN int
+json_is_digits8(json_uint64 v)
 {
-    int i = 0;
-    int ret;
-    int siz;
-
-    JSON_ASSERT(dst);
-    JSON_ASSERT(tok);
-    if (!dst || !max || !tok)
-        return 0;
+    return (((v & JSON_U64(0xF0F0F0F0u,0xF0F0F0F0u)) |
+        (((v + JSON_U64(0x06060606u,0x06060606u)) & JSON_U64(0xF0F0F0F0u,0xF0F0F0F0u)) >> 4))
+            == JSON_U64(0x33333333u,0x33333333u));
+}
 
-    ret = (max < (tok->len + 1)) ? max : tok->len;
-    siz = (max < (tok->len + 1)) ? max-1 : tok->len;
-    for (i = 0; i < siz; i++)
-        dst[i] = tok->str[i];
-    dst[siz] = '\0';
-    return ret;
+/* loads eight characters in little endian order */
+JSON_INTERN json_uint64
+json_load8(const char *p)
+{
+    const unsigned char *u = (const unsigned char*)p;
+    return (json_uint64)u[0] | ((json_uint64)u[1] << 8) |
+        ((json_uint64)u[2] << 16) | ((json_uint64)u[3] << 24) |
+        ((json_uint64)u[4] << 32) | ((json_uint64)u[5] << 40) |
+        ((json_uint64)u[6] << 48) | ((json_uint64)u[7] << 56);
 }
 
-JSON_API int
-json_cmp(const struct json_token* tok, const char* str)
+/* converts eight decimal digits with three multiplications (SWAR) */
+JSON_INTERN json_uint64
+json_digits8(json_uint64 v)
 {
-    int i;
-    JSON_ASSERT(tok);
-    JSON_ASSERT(str);
-    if (!tok || !str) return 1;
-    for (i = 0; (i < tok->len && *str); i++, str++){
-        if (tok->str[i] != *str)
-            return 1;
-    }
-    return 0;
+    v -= JSON_U64(0x30303030u,0x30303030u);
+    v = (v * 10) + (v >> 8);
+    v = (((v & JSON_U64(0x000000FFu,0x000000FFu)) * JSON_U64(0x000F4240u,0x00000064u)) +
+        (((v >> 16) & JSON_U64(0x000000FFu,0x000000FFu)) * JSON_U64(0x00002710u,0x00000001u))) >> 32;
+    return v;
 }
-/*--------------------------------------------------------------------------
- *
-                                TOKENIZER
+
+/* returns the first non whitespace character in [cur,end) */
+JSON_INTERN const char*
+json_skip_space(const char *cur, const char *end)
+{
+    while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\n'))
+        cur++;
+    return cur;
+}
+
+/* returns true if only whitespace is left between cur and end */
+JSON_INTERN int
+json_is_end(const char *cur, const char *end)
+{
+    return (cur == end || *cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\n');
+}
+
+/* parses the number at the beginning of [cur,end) into the correctly
+ * rounded double and returns the end of the number or NULL if malformed */
+JSON_INTERN const char*
+json_parse_double(double *num, const char *cur, const char *end)
+{
+    const char *digits_begin;
+    json_uint64 w = 0;
+    int digits = 0, any = 0;
+    int truncated = 0;
+    int neg = 0, q = 0;
+    double d;
+
+    /* split into 19 digit decimal significand and base 10 exponent */
+    if (cur < end && (*cur == '-' || *cur == '+'))
+        neg = (*cur++ == '-');
+    digits_begin = cur;
+    for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur, any = 1) {
+        if (digits < 19) {
+            w = w * 10 + (json_uint64)(*cur - '0');
+            digits += (w != 0);
+        } else {
+            truncated |= (*cur != '0');
+            q++;
+        }
+    }
+    if (cur < end && *cur == '.') {
+        ++cur;
+        while (w && digits <= 11 && end - cur >= 8 && json_is_digits8(json_load8(cur))) {
+            w = w * 100000000 + json_digits8(json_load8(cur));
+            digits += 8;
+            q -= 8;
+            cur += 8;
+            any = 1;
+        }
+        for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur, any = 1) {
+            if (digits < 19) {
+                w = w * 10 + (json_uint64)(*cur - '0');
+                digits += (w != 0);
+                q--;
+            } else truncated |= (*cur != '0');
+        }
+    }
+    if (!any) return NULL;
+    if (cur < end && (*cur == 'e' || *cur == 'E')) {
+        int e = 0, eneg = 0;
+        const char *exp;
+        if (++cur < end && (*cur == '-' || *cur == '+'))
+            eneg = (*cur++ == '-');
+        for (exp = cur; cur < end && *cur >= '0' && *cur <= '9'; ++cur)
+            if (e < 100000) e = e * 10 + (*cur - '0');
+        if (cur == exp) return NULL;
+        q += (eneg) ? -e: e;
+    }
+
+#if !defined(__FLT_EVAL_METHOD__) || (__FLT_EVAL_METHOD__ == 0)
+    if (!truncated && q >= -22 && q <= 22 && w <= ((json_uint64)1 << 53)) {
+        /* both values are exact doubles so a single operation rounds correctly */
+        d = (double)w;
+        d = (q < 0) ? d / json_pow10[-q]: d * json_pow10[q];
+        *num = (neg) ? -d: d;
+        return cur;
+    }
+#endif
+    d = json_lemire(w, q);
+    if (truncated && d != json_lemire(w + 1, q)) {
+        /* more than 19 digits and the cut off digits decide the rounding */
+        d = json_decide(digits_begin, cur, d);
+    }
+    *num = (neg) ? -d: d;
+    return cur;
+}
+
+/* parses the integer at the beginning of [cur,end) and returns the end of
+ * the number or NULL if it is malformed or does not fit into 64-bit */
+JSON_INTERN const char*
+json_parse_int(json_int64 *num, const char *cur, const char *end)
+{
+    const char *begin;
+    const json_uint64 max = ((json_uint64)1 << 63) - 1;
+    json_uint64 n = 0;
+    int neg = 0;
+
+    if (cur < end && (*cur == '-' || *cur == '+'))
+        neg = (*cur++ == '-');
+    begin = cur;
+    if (end - cur >= 8 && json_is_digits8(json_load8(cur))) {
+        n = json_digits8(json_load8(cur));
+        cur += 8;
+    }
+    /* 19 decimal digits always fit into an unsigned 64-bit integer */
+    for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur)
+        n = n * 10 + (json_uint64)(*cur - '0');
+    if (cur == begin || cur - begin > 19 || n > max + (json_uint64)neg)
+        return NULL;
+    if (cur < end && (*cur == '.' || *cur == 'e' || *cur == 'E'))
+        return NULL;
+    *num = (neg && n) ? -(json_int64)(n - 1) - 1: (json_int64)n;
+    return cur;
+}
+
+/* vector helpers for the SSE2/AVX2 code paths */
+#if defined(JSON_USE_AVX2)
+#define JSON_VEC_WIDTH 32
+#define JSON_VEC __m256i
+#define JSON_VLOAD(p) _mm256_loadu_si256((const __m256i*)(const void*)(p))
+#define JSON_VEQ(v,c) _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))
+#define JSON_VLE(v,c) _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(c)), v)
+#define JSON_VOR(a,b) _mm256_or_si256(a, b)
+#define JSON_VADD(a,b) _mm256_add_epi8(a, b)
+#define JSON_VMASK(v) ((json_uint64)(unsigned)_mm256_movemask_epi8(v))
+#elif defined(JSON_USE_SSE2)
+#define JSON_VEC_WIDTH 16
+#define JSON_VEC __m128i
+#define JSON_VLOAD(p) _mm_loadu_si128((const __m128i*)(const void*)(p))
+#define JSON_VEQ(v,c) _mm_cmpeq_epi8(v, _mm_set1_epi8(c))
+#define JSON_VLE(v,c) _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(c)), v)
+#define JSON_VOR(a,b) _mm_or_si128(a, b)
+#define JSON_VADD(a,b) _mm_add_epi8(a, b)
+#define JSON_VMASK(v) ((json_uint64)(unsigned)_mm_movemask_epi8(v))
+#endif
+
+/* returns the index of the lowest set bit */
+JSON_INTERN int
+json_ctz(json_uint64 x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (int)i;
+#else
+    int n = 0;
+    while (!(x & 0xFF)) {x >>= 8; n += 8;}
+    while (!(x & 1)) {x >>= 1; n++;}
+    return n;
+#endif
+}
+
+/* returns the first byte of a string body at or after `cur` that needs the
+ * string state machine: quote, backslash, control character or a byte that
+ * does not belong to a complete UTF-8 sequence. Sequences are checked by the
+ * same rules as json_go_string and json_go_utf8. */
+#ifdef JSON_VEC_WIDTH
+JSON_INTERN const char*
+json_scan_string(const char *cur, const char *end)
+{
+    const char *begin = cur;
+    json_uint64 carry = 0;
+    /* continuation bytes expected at the begin of the next block */
+    while (end - cur >= JSON_VEC_WIDTH) {
+        JSON_VEC v = JSON_VLOAD(cur);
+        JSON_VEC v1 = JSON_VADD(v, v);
+        JSON_VEC v2 = JSON_VADD(v1, v1);
+        JSON_VEC v3 = JSON_VADD(v2, v2);
+        JSON_VEC v4 = JSON_VADD(v3, v3);
+        /* bit 7 to bit 3 of each byte moved into the sign by doubling */
+        json_uint64 b7 = JSON_VMASK(v), b6 = JSON_VMASK(v1), b5 = JSON_VMASK(v2);
+        json_uint64 b4 = JSON_VMASK(v3), b3 = JSON_VMASK(v4);
+        json_uint64 cont = b7 & ~b6;
+        json_uint64 lead = b7 & b6;
+        json_uint64 lead2 = lead & ~b5;
+        json_uint64 lead3 = lead & b5 & ~b4;
+        json_uint64 lead4 = lead & b5 & b4 & ~b3;
+        json_uint64 expect = carry | (lead2 << 1) | (lead3 << 1) | (lead3 << 2) |
+            (lead4 << 1) | (lead4 << 2) | (lead4 << 3);
+        json_uint64 stop = JSON_VMASK(JSON_VOR(JSON_VOR(JSON_VEQ(v, '"'), JSON_VEQ(v, '\\')),
+            JSON_VOR(JSON_VLE(v, 0x1F), JSON_VEQ(v, 0x7F))));
+        stop |= (lead & b5 & b4 & b3) | (expect ^ cont);
+        stop &= ((json_uint64)1 << JSON_VEC_WIDTH) - 1;
+        if (stop) {
+            cur += json_ctz(stop);
+            break;
+        }
+        carry = expect >> JSON_VEC_WIDTH;
+        cur += JSON_VEC_WIDTH;
+    }
+    /* hand a partial sequence back to the state machine from its lead byte */
+    while (cur > begin && ((unsigned char)cur[-1] & 0xC0) == 0x80)
+        cur--;
+    if (cur > begin && (unsigned char)cur[-1] >= 0xC0)
+        cur--;
+    return cur;
+}
+#else
+JSON_INTERN const char*
+json_scan_string(const char *cur, const char *end)
+{
+    /* skips eight printable ASCII characters at a time (SWAR) */
+    const json_uint64 ones = JSON_U64(0x01010101u,0x01010101u);
+    const json_uint64 high = JSON_U64(0x80808080u,0x80808080u);
+    while (end - cur >= 8) {
+        json_uint64 v = json_load8(cur);
+        json_uint64 q = v ^ (ones * '"');
+        json_uint64 b = v ^ (ones * '\\');
+        json_uint64 d = v ^ (ones * 0x7F);
+        json_uint64 t = v | (v - ones * 0x20) | ((q - ones) & ~q) |
+            ((b - ones) & ~b) | ((d - ones) & ~d);
+        if (t & high) break;
+        cur += 8;
+    }
+    return cur;
+}
+#endif
+
+/* returns JSON_FLAG_ESCAPED if a string body contains a backslash */
+JSON_INTERN unsigned
+json_escape_flag(const char *str, json_size len)
+{
+    const char *end = str + len;
+    const char *cur = json_scan_string(str, end);
+    for (; cur < end; cur = json_scan_string(cur + 1, end)) {
+        if (*cur == '\\')
+            return JSON_FLAG_ESCAPED;
+    }
+    return 0;
+}
+
+/* compares a size limited string with a string inside a token */
+JSON_INTERN int
+json_lcmp(const struct json_token* tok, const char* str, int len)
+{
+    json_size i;
+    JSON_ASSERT(tok);
+    JSON_ASSERT(str);
+    if (!tok || !str || !len) return 1;
+    for (i = 0; (i < tok->len && i < len); i++, str++){
+        if (tok->str[i] != *str)
+            return 1;
+    }
+    return 0;
+}
+
+/* reads a big endian unsigned integer of `bytes` size */
+JSON_INTERN json_uint64
+json_mp_be(const unsigned char *p, int bytes)
+{
+    json_uint64 v = 0;
+    while (bytes--)
+        v = (v << 8) | *p++;
+    return v;
+}
+
+/* reads the MessagePack item header at `p`. Returns the token type and sets
+ * the header size and the payload size (bytes of strings and numbers,
+ * elements of arrays, pairs of maps) or JSON_NONE if invalid/truncated. */
+JSON_INTERN enum json_token_type
+json_mp_header(const unsigned char *p, const unsigned char *end,
+    json_size *head, json_size *size)
+{
+    static const unsigned char extra[] = {
+        /* 0xc0 - 0xdf: additional bytes behind the format byte */
+        0,0,0,0, 1,2,4,0, 0,0, 4,8, 1,2,4,8, 1,2,4,8, 0,0,0,0,0, 1,2,4, 2,4, 2,4};
+    json_uint64 n;
+    unsigned c;
+    int bytes;
+
+    if (p >= end) return JSON_NONE;
+    c = *p;
+    *head = 1;
+    *size = 0;
+    if (c <= 0x7f || c >= 0xe0) return JSON_NUMBER;
+    if (c <= 0x8f) {*size = c & 0x0f; return JSON_OBJECT;}
+    if (c <= 0x9f) {*size = c & 0x0f; return JSON_ARRAY;}
+    if (c <= 0xbf) {*size = c & 0x1f; return JSON_STRING;}
+    if (c == 0xc0) return JSON_NULL;
+    if (c == 0xc2) return JSON_FALSE;
+    if (c == 0xc3) return JSON_TRUE;
+
+    bytes = extra[c - 0xc0];
+    if (!bytes || end - p <= bytes) return JSON_NONE;
+    if (c >= 0xca && c <= 0xd3) {
+        /* float, unsigned and signed integers */
+        *size = bytes;
+        *head = 1 + bytes;
+        return JSON_NUMBER;
+    }
+    n = json_mp_be(p + 1, bytes);
+    if ((json_size)n < 0 || (json_uint64)(json_size)n != n)
+        return JSON_NONE;
+    *head = 1 + bytes;
+    *size = (json_size)n;
+    switch (c) {
+    case 0xc4: case 0xc5: case 0xc6: /* bin */
+    case 0xd9: case 0xda: case 0xdb: return JSON_STRING;
+    case 0xdc: case 0xdd: return JSON_ARRAY;
+    case 0xde: case 0xdf: return JSON_OBJECT;
+    default: return JSON_NONE;
+    }
+}
+
+/* decodes a MessagePack number. Returns JSON_FLAG_INTEGER for integers
+ * written to `i`, 0 for floating point numbers written to `d` or -1 */
+JSON_INTERN int
+json_mp_number(json_int64 *i, double *d, const unsigned char *p, const unsigned char *end)
+{
+    json_uint64 u;
+    unsigned c;
+    if (p >= end) return -1;
+    c = *p;
+    if (c <= 0x7f) {*i = (json_int64)c; return JSON_FLAG_INTEGER;}
+    if (c >= 0xe0) {*i = (json_int64)c - 256; return JSON_FLAG_INTEGER;}
+    switch (c) {
+    case 0xca: {
+        union {float f; unsigned u;} bits;
+        if (end - p < 5) return -1;
+        bits.u = (unsigned)json_mp_be(p + 1, 4);
+        *d = bits.f;
+        return 0;
+    }
+    case 0xcb: {
+        union {double d; json_uint64 u;} bits;
+        if (end - p < 9) return -1;
+        bits.u = json_mp_be(p + 1, 8);
+        *d = bits.d;
+        return 0;
+    }
+    case 0xcc: case 0xcd: case 0xce: case 0xcf:
+        if (end - p <= (1 << (c - 0xcc))) return -1;
+        u = json_mp_be(p + 1, 1 << (c - 0xcc));
+        if (u > JSON_U64(0x7FFFFFFF, 0xFFFFFFFF)) {
+            *d = (double)u;
+            return 0;
+        }
+        *i = (json_int64)u;
+        return JSON_FLAG_INTEGER;
+    case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+        int bytes = 1 << (c - 0xd0);
+        if (end - p <= bytes) return -1;
+        u = json_mp_be(p + 1, bytes);
+        if (bytes < 8 && (u >> (bytes * 8 - 1)))
+            u |= ~(json_uint64)0 << (bytes * 8); /* sign extension */
+        *i = (json_int64)u;
+        return JSON_FLAG_INTEGER;
+    }
+    default: return -1;
+    }
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                UTILITY
+
+  -------------------------------------------------------------------------*/
+JSON_API int
+json_convert(json_number *num, const struct json_token *tok)
+{
+    const char *end;
+    JSON_ASSERT(num);
+    JSON_ASSERT(tok);
+    if (!num || !tok || !tok->str || !tok->len)
+        return JSON_NONE;
+    if (tok->flags & JSON_FLAG_BINARY) {
+        json_int64 i;
+        const unsigned char *p = (const unsigned char*)tok->str;
+        if (tok->type != JSON_NUMBER) return JSON_NONE;
+        switch (json_mp_number(&i, num, p, p + tok->len)) {
+        case JSON_FLAG_INTEGER: *num = (json_number)i; return JSON_NUMBER;
+        case 0: return JSON_NUMBER;
+        default: return JSON_NONE;
+        }
+    }
+    end = json_parse_double(num, tok->str, tok->str + tok->len);
+    if (!end || !json_is_end(end, tok->str + tok->len))
+        return JSON_NONE;
+    return JSON_NUMBER;
+}
+
+JSON_API int
+json_convert_int(json_int64 *num, const struct json_token *tok)
+{
+    const char *end;
+    JSON_ASSERT(num);
+    JSON_ASSERT(tok);
+    if (!num || !tok || !tok->str || !tok->len)
+        return JSON_NONE;
+    if (tok->flags & JSON_FLAG_BINARY) {
+        double d;
+        const unsigned char *p = (const unsigned char*)tok->str;
+        if (tok->type != JSON_NUMBER) return JSON_NONE;
+        if (json_mp_number(num, &d, p, p + tok->len) != JSON_FLAG_INTEGER)
+            return JSON_NONE;
+        return JSON_NUMBER;
+    }
+    end = json_parse_int(num, tok->str, tok->str + tok->len);
+    if (!end || !json_is_end(end, tok->str + tok->len))
+        return JSON_NONE;
+    return JSON_NUMBER;
+}
+
+enum json_array_kind {
+    JSON_ARRAY_DOUBLE,
+    JSON_ARRAY_FLOAT,
+    JSON_ARRAY_INT64
+};
+
+/* decodes each array element without generating tokens in between */
+JSON_INTERN json_size
+json_array_decode(void *out, json_size max, const struct json_token *array,
+    enum json_array_kind kind)
+{
+    json_size n = 0;
+    const char *cur, *end;
+    JSON_ASSERT(array);
+    if (!array || array->type != JSON_ARRAY || !array->str || !array->len)
+        return -1;
+    if (!out) max = 0;
+
+    if (array->flags & JSON_FLAG_BINARY) {
+        json_size head, count, size;
+        const unsigned char *p = (const unsigned char*)array->str;
+        const unsigned char *e = p + array->len;
+        if (json_mp_header(p, e, &head, &count) != JSON_ARRAY)
+            return -1;
+        for (p += head; n < count; ++n, p += head) {
+            json_int64 i = 0;
+            double d = 0;
+            int integer = json_mp_number(&i, &d, p, e);
+            if (integer < 0 || json_mp_header(p, e, &head, &size) != JSON_NUMBER)
+                return -1;
+            if (kind == JSON_ARRAY_INT64) {
+                if (!integer) return -1;
+                if (n < max) ((json_int64*)out)[n] = i;
+                continue;
+            }
+            if (integer) d = (double)i;
+            if (n < max && kind == JSON_ARRAY_DOUBLE)
+                ((double*)out)[n] = d;
+            else if (n < max)
+                ((float*)out)[n] = (float)d;
+        }
+        return n;
+    }
+
+    cur = array->str;
+    end = array->str + array->len;
+    if (*cur != '[') return -1;
+    cur = json_skip_space(cur + 1, end);
+    if (cur < end && *cur == ']')
+        return 0;
+    while (cur < end) {
+        if (kind == JSON_ARRAY_INT64) {
+            json_int64 i;
+            if (!(cur = json_parse_int(&i, cur, end)))
+                return -1;
+            if (n < max) ((json_int64*)out)[n] = i;
+        } else {
+            double d;
+            if (!(cur = json_parse_double(&d, cur, end)))
+                return -1;
+            if (n < max && kind == JSON_ARRAY_DOUBLE)
+                ((double*)out)[n] = d;
+            else if (n < max)
+                ((float*)out)[n] = (float)d;
+        }
+        n++;
+        cur = json_skip_space(cur, end);
+        if (cur >= end) break;
+        if (*cur == ']') return n;
+        if (*cur != ',') break;
+        cur = json_skip_space(cur + 1, end);
+    }
+    return -1;
+}
+
+JSON_API json_size
+json_array_to_doubles(double *out, json_size max, const struct json_token *array)
+{
+    return json_array_decode(out, max, array, JSON_ARRAY_DOUBLE);
+}
+
+JSON_API json_size
+json_array_to_floats(float *out, json_size max, const struct json_token *array)
+{
+    return json_array_decode(out, max, array, JSON_ARRAY_FLOAT);
+}
+
+JSON_API json_size
+json_array_to_int64s(json_int64 *out, json_size max, const struct json_token *array)
+{
+    return json_array_decode(out, max, array, JSON_ARRAY_INT64);
+}
+
+JSON_API json_size
+json_cpy(char *dst, json_size max, const struct json_token* tok)
+{
+    json_size i = 0;
+    json_size ret;
+    json_size siz;
+
+    JSON_ASSERT(dst);
+    JSON_ASSERT(tok);
+    if (!dst || !max || !tok)
+        return 0;
+
+    ret = (max < (tok->len + 1)) ? max : tok->len;
+    siz = (max < (tok->len + 1)) ? max-1 : tok->len;
+    for (i = 0; i < siz; i++)
+        dst[i] = tok->str[i];
+    dst[siz] = '\0';
+    return ret;
+}
+
+JSON_API int
+json_cmp(const struct json_token* tok, const char* str)
+{
+    json_size i;
+    JSON_ASSERT(tok);
+    JSON_ASSERT(str);
+    if (!tok || !str) return 1;
+    for (i = 0; (i < tok->len && *str); i++, str++){
+        if (tok->str[i] != *str)
+            return 1;
+    }
+    return 0;
+}
+
+JSON_API void
+json_arena_begin(struct json_arena *a, char *memory, json_size size)
+{
+    JSON_ASSERT(a);
+    if (!a) return;
+    a->memory = memory;
+    a->size = (memory) ? size: 0;
+    a->used = 0;
+}
+
+/* parses the four hex digits of an unicode escape or returns -1 */
+JSON_INTERN long
+json_hex4(const char *p)
+{
+    int i;
+    long v = 0;
+    for (i = 0; i < 4; ++i) {
+        char c = p[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    }
+    return v;
+}
+
+/* writes a code point as UTF-8 and returns the number of bytes */
+JSON_INTERN int
+json_utf8_encode(char *dst, unsigned long cp)
+{
+    if (cp < 0x80) {
+        dst[0] = (char)cp;
+        return 1;
+    } else if (cp < 0x800) {
+        dst[0] = (char)(0xC0 | (cp >> 6));
+        dst[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    } else if (cp < 0x10000) {
+        dst[0] = (char)(0xE0 | (cp >> 12));
+        dst[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        dst[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    dst[0] = (char)(0xF0 | (cp >> 18));
+    dst[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    dst[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    dst[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* decodes the escape sequence at `cur` (pointing behind the backslash) into
+ * up to four UTF-8 bytes. Returns the number of source bytes consumed or 0 */
+JSON_INTERN int
+json_decode_escape(char *dst, int *size, const char *cur, const char *end)
+{
+    long cp, lo;
+    *size = 1;
+    if (cur >= end) return 0;
+    switch (*cur) {
+    case '"': *dst = '"'; return 1;
+    case '\\': *dst = '\\'; return 1;
+    case '/': *dst = '/'; return 1;
+    case 'b': *dst = '\b'; return 1;
+    case 'f': *dst = '\f'; return 1;
+    case 'n': *dst = '\n'; return 1;
+    case 'r': *dst = '\r'; return 1;
+    case 't': *dst = '\t'; return 1;
+    case 'u': break;
+    default: return 0;
+    }
+    if (end - cur < 5 || (cp = json_hex4(cur + 1)) < 0)
+        return 0;
+    if (cp >= 0xD800 && cp <= 0xDBFF && end - cur >= 11 && cur[5] == '\\' &&
+        cur[6] == 'u' && (lo = json_hex4(cur + 7)) >= 0xDC00 && lo <= 0xDFFF) {
+        /* surrogate pair */
+        *size = json_utf8_encode(dst, (unsigned long)(0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00)));
+        return 11;
+    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+        /* lone surrogate */
+        cp = 0xFFFD;
+    }
+    *size = json_utf8_encode(dst, (unsigned long)cp);
+    return 5;
+}
+
+JSON_API int
+json_unescape(struct json_view *out, struct json_arena *a,
+    const struct json_token *tok)
+{
+    char *dst;
+    const char *cur, *end;
+
+    JSON_ASSERT(out);
+    JSON_ASSERT(tok);
+    if (!out || !tok) return 0;
+    out->str = tok->str;
+    out->len = tok->len;
+    if (!(tok->flags & JSON_FLAG_ESCAPED))
+        return 1;
+
+    /* decoded strings are never longer than their source */
+    if (!a || !a->memory || a->size - a->used < tok->len)
+        goto fail;
+    dst = a->memory + a->used;
+    cur = tok->str;
+    end = tok->str + tok->len;
+    while (cur < end) {
+        int n, size;
+        if (*cur != '\\') {
+            *dst++ = *cur++;
+            continue;
+        }
+        if (!(n = json_decode_escape(dst, &size, cur + 1, end)))
+            goto fail;
+        cur += n + 1;
+        dst += size;
+    }
+    out->str = a->memory + a->used;
+    out->len = (json_size)(dst - out->str);
+    a->used += out->len;
+    return 1;
+
+fail:
+    out->str = NULL;
+    out->len = 0;
+    return 0;
+}
+/*--------------------------------------------------------------------------
+ *
+                                TOKENIZER
 
   -------------------------------------------------------------------------*/
 JSON_API struct json_iter
-json_begin(const char *str, int len)
+json_begin(const char *str, json_size len)
 {
     struct json_iter iter = JSON_ITER_NULL;
-    json_init();
     iter.src = str;
     iter.len = len;
     return iter;
@@ -559,9 +2817,10 @@ JSON_API struct json_iter
 json_read(struct json_token *obj, const struct json_iter* prev)
 {
     struct json_iter iter;
-    int len;
-    const char *cur;
+    json_size len;
+    const char *cur, *next;
     int utf8_remain = 0;
+    int escaped = 0;
     unsigned char c;
 
     JSON_ASSERT(obj);
@@ -613,7 +2872,7 @@ json_read(struct json_token *obj, const struct json_iter* prev)
         } break;
         case JSON_STATE_DOWN: {
             if (--iter.depth == 1) {
-                obj->len = (int)(cur - obj->str) + 1;
+                obj->len = (json_size)(cur - obj->str) + 1;
                 if (iter.depth != 1 || !obj->str)
                     goto l_loop;
                 goto l_yield;
@@ -628,11 +2887,15 @@ json_read(struct json_token *obj, const struct json_iter* prev)
                     obj->children++;
                 obj->sub++;
             }
+            /* jump over plain string content */
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (json_size)(next - cur) - 1;
+            cur = next - 1;
         } break;
         case JSON_STATE_QDOWN: {
             iter.go = json_go_struct;
             if (iter.depth <= 1) {
-                obj->len = (int)(cur - obj->str) + 1;
+                obj->len = (json_size)(cur - obj->str) + 1;
                 if (iter.depth > 1 || !obj->str)
                     goto l_loop;
                 goto l_yield;
@@ -640,9 +2903,13 @@ json_read(struct json_token *obj, const struct json_iter* prev)
         } break;
         case JSON_STATE_ESC: {
             iter.go = json_go_esc;
+            escaped = 1;
         } break;
         case JSON_STATE_UNESC: {
             iter.go = json_go_string;
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (json_size)(next - cur) - 1;
+            cur = next - 1;
         } break;
         case JSON_STATE_BARE: {
             if (iter.depth <= 1) {
@@ -657,8 +2924,9 @@ json_read(struct json_token *obj, const struct json_iter* prev)
         case JSON_STATE_UNBARE: {
             iter.go = json_go_struct;
             if (iter.depth <= 1) {
-                obj->len = (int)(cur - obj->str);
+                obj->len = (json_size)(cur - obj->str);
                 obj->type = (enum json_token_type)json_type(obj);
+                obj->flags = json_flags(obj->type, obj->str, obj->len);
                 if (obj->type == JSON_STRING)
                     json_deq(obj);
                 iter.src = cur;
@@ -680,8 +2948,11 @@ json_read(struct json_token *obj, const struct json_iter* prev)
             utf8_remain = 3;
         } break;
         case JSON_STATE_UTF8_NEXT: {
-            if (!--utf8_remain)
-                iter.go = json_go_string;
+            if (--utf8_remain) break;
+            iter.go = json_go_string;
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (json_size)(next - cur) - 1;
+            cur = next - 1;
         } break;
         default:
             break;
@@ -695,10 +2966,13 @@ l_end:
         iter.src = 0;
         iter.len = 0;
         if (obj->str) {
-            obj->len = (c == '}') ? (int)((cur-1) - obj->str): (int)(cur - obj->str);
+            obj->len = (c == '}') ? (json_size)((cur-1) - obj->str): (json_size)(cur - obj->str);
             obj->type = (enum json_token_type)json_type(obj);
-            if (obj->type == JSON_STRING)
+            obj->flags = json_flags(obj->type, obj->str, obj->len);
+            if (obj->type == JSON_STRING) {
                 json_deq(obj);
+                if (escaped) obj->flags |= JSON_FLAG_ESCAPED;
+            }
         }
         return iter;
     }
@@ -708,8 +2982,11 @@ l_yield:
     iter.src = cur + 1;
     iter.len = len - 1;
     obj->type = json_type(obj);
-    if (obj->type == JSON_STRING)
+    obj->flags = json_flags(obj->type, obj->str, obj->len);
+    if (obj->type == JSON_STRING) {
         json_deq(obj);
+        if (escaped) obj->flags |= JSON_FLAG_ESCAPED;
+    }
     return iter;
 }
 
@@ -729,12 +3006,12 @@ json_parse(struct json_pair *p, const struct json_iter* it)
                                 PARSER
 
   -------------------------------------------------------------------------*/
-JSON_API int
-json_num(const char *json, int length)
+JSON_API json_size
+json_num(const char *json, json_size length)
 {
     struct json_iter iter;
     struct json_token tok;
-    int count = 0;
+    json_size count = 0;
 
     JSON_ASSERT(json);
     JSON_ASSERT(length > 0);
@@ -750,285 +3027,3725 @@ json_num(const char *json, int length)
     return count;
 }
 
-JSON_API enum json_status
-json_load(struct json_token *toks, int max, int *read,
-            const char *json, int length)
-{
-    enum json_status status = JSON_OK;
-    struct json_token tok;
-    struct json_iter iter;
-
-    JSON_ASSERT(toks);
-    JSON_ASSERT(json);
-    JSON_ASSERT(length > 0);
-    JSON_ASSERT(max > 0);
-    JSON_ASSERT(read);
+/* output of the single pass tokenizer. Either writes `json_token` or
+ * `json_tape` entries depending on which array is set. */
+struct json_sink {
+    struct json_token *toks;
+    struct json_tape *tape;
+    const struct json_allocator *alloc;
+    const char *base;
+    json_size max, read;
+    json_size parent;
+    unsigned depth;
+    /* brackets opened before the input which stay open at its end */
+};
 
-    if (!toks || !json || !length || !max || !read)
-        return JSON_INVAL;
-    if (*read >= max)
-        return JSON_OUT_OF_TOKEN;
+JSON_GLOBAL const struct json_sink JSON_SINK_NULL = {0,0,0,0,0,0,-1,0};
 
-    iter = json_begin(json, length);
-    iter = json_read(&tok, &iter);
-    if (iter.err && iter.len)
-        return JSON_PARSING_ERROR;
+/* grows the token array by the user provided allocator if possible */
+JSON_INTERN int
+json_grow(struct json_sink *s)
+{
+    void *mem;
+    json_size cap = (s->max < 32) ? 64 : s->max * 2;
+    if (!s->alloc || !s->alloc->resize || s->tape) return 0;
+    mem = s->alloc->resize(s->alloc->userdata, s->toks,
+        cap * (json_size)sizeof(struct json_token));
+    if (!mem) return 0;
+    s->toks = (struct json_token*)mem;
+    s->max = cap;
+    return 1;
+}
 
-    while (iter.len) {
-        toks[*read] = tok;
-        *read += 1;
-        if (*read > max) return JSON_OUT_OF_TOKEN;
-        if (toks[*read-1].type == JSON_OBJECT ||  toks[*read-1].type == JSON_ARRAY) {
-            status = json_load(toks, max, read, toks[*read-1].str, toks[*read-1].len);
-            if (status != JSON_OK) return status;
-        }
+/* appends a token as child of the current parent and returns its index */
+JSON_INTERN json_size
+json_emit(struct json_sink *s, enum json_token_type type, const char *str, json_size len)
+{
+    json_size idx;
+    if (s->read >= s->max && !json_grow(s))
+        return -1;
+    if (s->tape && (unsigned)s->read >= JSON_TAPE_ROOT)
+        return -1;
 
-        iter = json_read(&tok, &iter);
-        if (iter.err && iter.src && iter.len)
-            return JSON_PARSING_ERROR;
+    idx = s->read++;
+    if (s->tape) {
+        struct json_tape *t = &s->tape[idx];
+        t->off = (unsigned)(str - s->base);
+        t->len = (unsigned)len;
+        t->next = (unsigned)idx + 1;
+        t->type = (unsigned)type;
+        t->parent = (s->parent < 0) ? JSON_TAPE_ROOT: (unsigned)s->parent;
+    } else {
+        struct json_token *t = &s->toks[idx];
+        t->type = type;
+        t->str = str;
+        t->len = len;
+        t->children = 0;
+        t->sub = 0;
+        t->flags = json_flags(type, str, len);
+        if (s->parent >= 0)
+            s->toks[s->parent].children++;
     }
-    return status;
+    return idx;
 }
-/*--------------------------------------------------------------------------
- *
-                                QUERY
 
-  -------------------------------------------------------------------------*/
-JSON_INTERN const char*
-json_strchr(const char *str, char c, int len)
+/* opens a new object or array. While open a token stores the index of its
+ * parent inside `sub` which is replaced by the subtoken count on close. */
+JSON_INTERN int
+json_open(struct json_sink *s, enum json_token_type type, const char *str)
 {
-    int neg = (len < 0) ? 1: 0;
-    int dec = neg ? 0 : 1;
-    len = neg ? 0 : len;
-    if (!str) return NULL;
-    while (*str && len >= 0) {
-        if (*str == c)
-            return str;
-        len -= dec;
-        str++;
-    }
-    if (neg) return str;
-    return NULL;
+    json_size idx = json_emit(s, type, str, 0);
+    if (idx < 0) return 0;
+    if (!s->tape)
+        s->toks[idx].sub = s->parent;
+    s->parent = idx;
+    return 1;
 }
 
-JSON_INTERN const char*
-json_path_parse_name(struct json_token *tok, const char *path,
-    char delimiter)
+/* closes the current object or array at the closing bracket */
+JSON_INTERN void
+json_close(struct json_sink *s, const char *end)
 {
-    const char *del;
-    const char *begin, *end;
-    if (!path || *path == '\0')
-        return NULL;
+    json_size idx = s->parent;
+    if (s->tape) {
+        struct json_tape *t = &s->tape[idx];
+        t->len = (unsigned)(end - (s->base + t->off)) + 1;
+        t->next = (unsigned)s->read;
+        s->parent = (t->parent == JSON_TAPE_ROOT) ? -1: (json_size)t->parent;
+    } else {
+        struct json_token *t = &s->toks[idx];
+        t->len = (json_size)(end - t->str) + 1;
+        s->parent = t->sub;
+        t->sub = s->read - idx - 1;
+    }
+}
 
-    tok->str = path;
-    del = json_strchr(tok->str, delimiter, -1);
-    begin = json_strchr(tok->str, '[', -1);
-    end = json_strchr(tok->str, ']', -1);
+/* single pass tokenizer over all depths of the document */
+JSON_INTERN enum json_status
+json_tokenize(struct json_sink *s, const char *json, json_size length)
+{
+    const char *cur, *next;
+    const char *begin = NULL;
+    const char *go = json_go_struct;
+    unsigned depth = s->depth;
+    int utf8_remain = 0;
+    int escaped = 0;
+    json_size len, idx;
 
-    /* array part left */
-    if (begin && end && begin == tok->str) {
-        tok->len = (int)((end - begin) + 1);
-        if (*(end + 1) == '\0')
-            return NULL;
-        if (*(end + 1) == '.')
-            return(end + 2);
-        else return(end + 1);
+    for (cur = json, len = length; len && *cur; cur++, len--) {
+        unsigned char c = (unsigned char)*cur;
+        switch (go[c]) {
+        case JSON_STATE_FAILED: return JSON_PARSING_ERROR;
+        case JSON_STATE_LOOP: break;
+        case JSON_STATE_SEP: {
+            if (s->parent >= 0 && !s->tape)
+                s->toks[s->parent].children--;
+        } break;
+        case JSON_STATE_UP: {
+            if (depth++ == 0) break;
+            if (!json_open(s, (c == '{') ? JSON_OBJECT: JSON_ARRAY, cur))
+                return JSON_OUT_OF_TOKEN;
+        } break;
+        case JSON_STATE_DOWN: {
+            if (depth <= s->depth) return JSON_PARSING_ERROR;
+            if (--depth == 0) break;
+            json_close(s, cur);
+        } break;
+        case JSON_STATE_QUP: {
+            go = json_go_string;
+            begin = cur;
+            escaped = 0;
+            /* jump over plain string content */
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (json_size)(next - cur) - 1;
+            cur = next - 1;
+        } break;
+        case JSON_STATE_QDOWN: {
+            go = json_go_struct;
+            idx = json_emit(s, JSON_STRING, begin + 1, (json_size)(cur - begin) - 1);
+            if (idx < 0) return JSON_OUT_OF_TOKEN;
+            if (escaped && !s->tape)
+                s->toks[idx].flags |= JSON_FLAG_ESCAPED;
+        } break;
+        case JSON_STATE_ESC: go = json_go_esc; escaped = 1; break;
+        case JSON_STATE_UNESC: {
+            go = json_go_string;
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (json_size)(next - cur) - 1;
+            cur = next - 1;
+        } break;
+        case JSON_STATE_BARE: {
+            go = json_go_bare;
+            begin = cur;
+        } break;
+        case JSON_STATE_UNBARE: {
+            go = json_go_struct;
+            if (json_emit(s, json_type_char(*begin), begin, (json_size)(cur - begin)) < 0)
+                return JSON_OUT_OF_TOKEN;
+            cur--; len++;
+        } break;
+        case JSON_STATE_UTF8_2: go = json_go_utf8; utf8_remain = 1; break;
+        case JSON_STATE_UTF8_3: go = json_go_utf8; utf8_remain = 2; break;
+        case JSON_STATE_UTF8_4: go = json_go_utf8; utf8_remain = 3; break;
+        case JSON_STATE_UTF8_NEXT: {
+            if (--utf8_remain) break;
+            go = json_go_string;
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (json_size)(next - cur) - 1;
+            cur = next - 1;
+        } break;
+        default: break;
+        }
     }
 
-    /* only array after name */
-    if (begin < del) {
-        tok->len = (int)(begin - tok->str);
-        return begin;
-    }
+    if (go == json_go_bare) {
+        /* bare value at the end of input */
+        if (json_emit(s, json_type_char(*begin), begin, (json_size)(cur - begin)) < 0)
+            return JSON_OUT_OF_TOKEN;
+    } else if (go != json_go_struct)
+        return JSON_PARSING_ERROR;
+    return (depth != s->depth) ? JSON_PARSING_ERROR: JSON_OK;
+}
 
-    if (!del) return NULL;
-    if (*del == '\0') {
-        tok->len = (int)(del - tok->str);
-        return NULL;
-    }
-    tok->len = (int)(del - tok->str);
-    return del+1;
+JSON_API enum json_status
+json_load(struct json_token *toks, json_size max, json_size *read,
+            const char *json, json_size length)
+{
+    enum json_status status;
+    struct json_sink sink;
+
+    JSON_ASSERT(toks);
+    JSON_ASSERT(json);
+    JSON_ASSERT(length > 0);
+    JSON_ASSERT(max > 0);
+    JSON_ASSERT(read);
+
+    if (!toks || !json || !length || !max || !read)
+        return JSON_INVAL;
+    if (*read >= max)
+        return JSON_OUT_OF_TOKEN;
+
+    sink = JSON_SINK_NULL;
+    sink.toks = toks;
+    sink.max = max;
+    sink.read = *read;
+    status = json_tokenize(&sink, json, length);
+    *read = sink.read;
+    return status;
 }
 
-JSON_INTERN int
-json_path_parse_array(struct json_token *array, const struct json_token *token)
+JSON_API enum json_status
+json_load_alloc(struct json_token **toks, json_size *max, json_size *read,
+    const char *json, json_size length, const struct json_allocator *alloc)
 {
-    const char *begin;
-    const char *end;
+    enum json_status status;
+    struct json_sink sink;
 
-    array->str = token->str;
-    begin = json_strchr(array->str, '[', (int)token->len);
-    if (!begin || ((int)(begin - array->str) >= token->len))
-        return 0;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(max);
+    JSON_ASSERT(read);
+    JSON_ASSERT(json);
+    JSON_ASSERT(alloc);
+    JSON_ASSERT(alloc->resize);
+
+    if (!toks || !max || !read || !json || !length || !alloc || !alloc->resize)
+        return JSON_INVAL;
+
+    sink = JSON_SINK_NULL;
+    sink.toks = *toks;
+    sink.alloc = alloc;
+    sink.max = *max;
+    sink.read = *read;
+    status = json_tokenize(&sink, json, length);
+    *toks = sink.toks;
+    *max = sink.max;
+    *read = sink.read;
+    return status;
+}
 
-    end = json_strchr(begin, ']', (int)(token->len - (int)(begin - array->str)));
-    if (!end || ((int)(end - array->str) >= token->len))
+/* returns 1 if a container encloses the byte range [begin,end) of the old
+ * document without touching its brackets */
+JSON_INTERN int
+json_encloses(const struct json_token *t, const char *old, json_size begin,
+    json_size end)
+{
+    json_size open = (json_size)(t->str - old);
+    if (t->type != JSON_OBJECT && t->type != JSON_ARRAY)
         return 0;
+    return open < begin && end < open + t->len;
+}
 
-    array->str = begin + 1;
-    array->len = (int)((end-1) - begin);
-    return 1;
+/* copies tokens between possibly overlapping ranges */
+JSON_INTERN void
+json_move(struct json_token *dst, const struct json_token *src, json_size n)
+{
+    json_size i;
+    if (dst < src) {
+        for (i = 0; i < n; ++i)
+            dst[i] = src[i];
+    } else if (dst > src) {
+        for (i = n; i > 0; --i)
+            dst[i-1] = src[i-1];
+    }
 }
 
-JSON_API struct json_token*
-json_query(struct json_token *toks, int count, const char *path)
+JSON_API enum json_status
+json_update(struct json_token **toks, json_size *max, json_size *read,
+    const char *json, json_size length, const struct json_edit *edit,
+    const struct json_allocator *alloc)
 {
-    int i = 0;
-    int begin = 1;
-    struct json_token *iter = NULL;
-    /* iterator to step over each token in the toks array */
-    struct json_token name;
-    /* current segment in the path to search in the tree for */
-    struct json_token array;
-    /* array token to store the current path segment array index */
-    struct json_object {int index, size;} obj;
-    /* current object iterator with current pair index and total pairs in object */
+    json_size i, n, target = -1;
+    json_size begin, end, delta, diff, tail;
+    json_size children, count;
+    enum json_status status;
+    struct json_sink sink;
+    struct json_token *t;
 
     JSON_ASSERT(toks);
-    JSON_ASSERT(count > 0);
-    if (!toks || !count) return iter;
-    if (!path) return &toks[i];
+    JSON_ASSERT(max);
+    JSON_ASSERT(read);
+    JSON_ASSERT(json);
+    JSON_ASSERT(edit);
+    if (!toks || !*toks || !max || !read || !json || length <= 0 || !edit || !edit->old)
+        return JSON_INVAL;
+    if (edit->offset < 0 || edit->removed < 0 || edit->inserted < 0)
+        return JSON_INVAL;
 
-    iter = &toks[i];
-    array.len = 0;
-    array.str = NULL;
+    begin = edit->offset;
+    end = edit->offset + edit->removed;
+    delta = edit->inserted - edit->removed;
+    sink = JSON_SINK_NULL;
+    sink.toks = *toks;
+    sink.max = *max;
+    sink.alloc = alloc;
 
-    path = json_path_parse_name(&name, path, JSON_DELIMITER);
-    while (1) {
-        if (iter->type == JSON_OBJECT || iter->type == JSON_ARRAY || begin) {
-            /* setup iteration over elements inside a object or array */
-            obj.index = 0;
-            if (begin) {
-                begin = 0;
-                obj.size = count;
-            } else if (iter->type == JSON_OBJECT) {
-                obj.size = iter->children;
-                if ((i + 1) > count) return NULL;
-                iter = &toks[++i];
-            } else {
-                json_number n;
-                int j = 0;
+    /* descend into the smallest enclosing container */
+    count = *read;
+    for (i = 0; i < count;) {
+        t = &(*toks)[i];
+        if (json_encloses(t, edit->old, begin, end)) {
+            target = i;
+            count = i + 1 + t->sub;
+            i++;
+        } else i += t->sub + 1;
+    }
+    if (target < 0) {
+        /* edit touches the root so the whole document is parsed again
+         * behind the current tokens and only replaces them on success */
+        sink.read = *read;
+        status = json_tokenize(&sink, json, length);
+        *toks = sink.toks;
+        *max = sink.max;
+        if (status != JSON_OK)
+            return status;
+        json_move(*toks, *toks + *read, sink.read - *read);
+        *read = sink.read - *read;
+        return JSON_OK;
+    }
 
-                /* array object so set iterator to array index */
-                if (!json_path_parse_array(&array, &name))
-                    return NULL;
-                if ((i+1) > count)
-                    return NULL;
-                if (array.len < 1)
-                    return NULL;
-                if (json_convert(&n, &array) != JSON_NUMBER)
-                    return NULL;
-                if ((int)n >= iter->children)
-                    return NULL;
-                array.str = NULL;
-                array.len = 0;
+    /* parse the members of the container behind the current tokens. The
+     * brackets have to stay in place and match after the edit. */
+    t = &(*toks)[target];
+    i = (json_size)(t->str - edit->old);
+    n = t->len + delta;
+    if (i + n > length || n < 2 ||
+        json[i] != ((t->type == JSON_OBJECT) ? '{': '[') ||
+        json[i+n-1] != ((t->type == JSON_OBJECT) ? '}': ']'))
+        return JSON_PARSING_ERROR;
+    children = t->children;
+    t->children = 0;
+    sink.read = *read;
+    sink.parent = target;
+    sink.depth = 1;
+    status = json_tokenize(&sink, json + i + 1, n - 2);
+    *toks = sink.toks;
+    *max = sink.max;
+    t = &(*toks)[target];
+    if (status != JSON_OK) {
+        t->children = children;
+        return status;
+    }
 
-                /* iterate over each array element and find the correct index */
-                iter++; i++;
-                for (j = 0; j < n; ++j) {
-                    if (iter->type == JSON_ARRAY || iter->type == JSON_OBJECT) {
-                        i = i + (iter->sub) + 1;
-                    } else i += 1;
-                    if (i > count)
-                        return NULL;
-                    iter = &toks[i];
-                }
-                if (!path) return iter;
-                path = json_path_parse_name(&name, path, JSON_DELIMITER);
+    /* splice the new tokens in place of the old container content */
+    n = sink.read - *read;
+    diff = n - t->sub;
+    tail = *read - (target + 1 + t->sub);
+    if (diff > 0) {
+        if (*read + diff + n > *max) {
+            while (sink.max < *read + diff + n && json_grow(&sink));
+            *toks = sink.toks;
+            *max = sink.max;
+            if (sink.max < *read + diff + n) {
+                /* old tokens are still in place and stay valid */
+                (*toks)[target].children = children;
+                return JSON_OUT_OF_TOKEN;
             }
-            continue;
         }
-        {
-            /* check if current table element is equal to the current path  */
-            if (!json_lcmp(iter, name.str, name.len)) {
-                /* correct token found and end of path */
-                if (!path) {
-                    if ((i + 1) > count)
-                        return NULL;
-                    return (iter + 1);
-                }
-                /* check if path points to invalid token */
-                if ((i+1) > count)
-                    return NULL;
-                if(toks[i+1].type != JSON_OBJECT && toks[i+1].type != JSON_ARRAY)
-                    return NULL;
+        json_move(*toks + *read + diff, *toks + *read, n);
+        json_move(*toks + target + 1 + n, *toks + target + 1 + t->sub, tail);
+        json_move(*toks + target + 1, *toks + *read + diff, n);
+    } else {
+        json_move(*toks + target + 1, *toks + *read, n);
+        json_move(*toks + target + 1 + n, *toks + target + 1 - diff + n, tail);
+    }
+    t = &(*toks)[target];
 
-                /* look deeper into child object/array */
-                iter = &toks[++i];
-                path = json_path_parse_name(&name, path, JSON_DELIMITER);
-            } else {
-                /* key is not correct iterate until end of object */
-                if (++obj.index >= obj.size)
-                    return NULL;
-                if ((i + 1) >= count)
-                    return NULL;
-                if (iter[1].type == JSON_ARRAY || iter[1].type == JSON_OBJECT) {
-                    i = i + (iter[1].sub + 2);
-                } else i = i + 2;
-                if (i >= count)
-                    return NULL;
-                iter = &toks[i];
-            }
-        }
+    /* resize all enclosing containers and rebase the unchanged tokens */
+    for (i = 0; i < target;) {
+        struct json_token *p = &(*toks)[i];
+        if (json_encloses(p, edit->old, begin, end)) {
+            p->len += delta;
+            p->sub += diff;
+            i++;
+        } else i += p->sub + 1;
     }
-    return iter;
+    t->len += delta;
+    t->sub = n;
+    if (json != edit->old) {
+        for (i = 0; i <= target; ++i)
+            (*toks)[i].str = json + ((*toks)[i].str - edit->old);
+    }
+    if (json != edit->old || delta) {
+        for (i = target + 1 + n; i < target + 1 + n + tail; ++i)
+            (*toks)[i].str = json + ((*toks)[i].str - edit->old) + delta;
+    }
+    *read += diff;
+    return JSON_OK;
 }
 
-JSON_API int
-json_query_number(json_number *num, struct json_token *toks, int count,
-    const char *path)
+#ifdef JSON_USE_MMAP
+JSON_API enum json_status
+json_file_open(struct json_file *file, const char *path)
 {
-    struct json_token *tok;
-    JSON_ASSERT(toks);
-    JSON_ASSERT(count > 0);
-    JSON_ASSERT(num);
+    JSON_ASSERT(file);
     JSON_ASSERT(path);
-    if (!toks || !count || !num || !path)
-        return JSON_NONE;
-
-    tok = json_query(toks, count, path);
-    if (!tok) return JSON_NONE;
-    if (tok->type != JSON_NUMBER)
-        return tok->type;
-    return json_convert(num, tok);
+    if (!file || !path)
+        return JSON_INVAL;
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+#ifdef _WIN32
+    {
+        HANDLE f, map;
+        LARGE_INTEGER size;
+        f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (f == INVALID_HANDLE_VALUE)
+            return JSON_FILE_ERROR;
+        if (!GetFileSizeEx(f, &size) || size.QuadPart <= 0) {
+            CloseHandle(f);
+            return JSON_FILE_ERROR;
+        }
+        if ((json_size)size.QuadPart != size.QuadPart) {
+            CloseHandle(f);
+            return JSON_INVAL;
+        }
+        map = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(f);
+        if (!map) return JSON_FILE_ERROR;
+        file->data = (const char*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+        if (!file->data) {
+            CloseHandle(map);
+            return JSON_FILE_ERROR;
+        }
+        file->size = (json_size)size.QuadPart;
+        file->handle = map;
+    }
+#else
+    {
+        void *data;
+        struct stat st;
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return JSON_FILE_ERROR;
+        if (fstat(fd, &st) || st.st_size <= 0) {
+            close(fd);
+            return JSON_FILE_ERROR;
+        }
+        if ((json_size)st.st_size != st.st_size) {
+            /* file does not fit into the address space */
+            close(fd);
+            return JSON_INVAL;
+        }
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            return JSON_FILE_ERROR;
+#ifdef MADV_SEQUENTIAL
+        /* pages are read once from front to back */
+        madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+        file->data = (const char*)data;
+        file->size = (json_size)st.st_size;
+    }
+#endif
+    return JSON_OK;
+}
 
+JSON_API void
+json_file_close(struct json_file *file)
+{
+    JSON_ASSERT(file);
+    if (!file || !file->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(file->data);
+    CloseHandle((HANDLE)file->handle);
+#else
+    munmap((void*)file->data, (size_t)file->size);
+#endif
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
 }
 
-JSON_API int
-json_query_string(char *buffer, int max, int *size,
-    struct json_token *toks, int count, const char *path)
+JSON_API enum json_status
+json_load_file(struct json_file *file, struct json_token **toks, json_size *max,
+    json_size *read, const char *path, const struct json_allocator *alloc)
 {
-    struct json_token *tok;
-    JSON_ASSERT(toks);
-    JSON_ASSERT(count > 0);
-    JSON_ASSERT(buffer);
-    JSON_ASSERT(size);
-    JSON_ASSERT(path);
-    if (!toks || !count || !buffer || !size || !path)
-        return JSON_NONE;
+    enum json_status status = json_file_open(file, path);
+    if (status != JSON_OK) return status;
+    status = json_load_alloc(toks, max, read, file->data, file->size, alloc);
+    if (status != JSON_OK)
+        json_file_close(file);
+    return status;
+}
+#endif
 
-    tok = json_query(toks, count, path);
-    if (!tok) return JSON_NONE;
-    if (tok->type != JSON_STRING)
-        return tok->type;
-    *size = json_cpy(buffer, max, tok);
-    return tok->type;
+JSON_API enum json_status
+json_load_tape(struct json_tape *tape, int max, int *read,
+    const char *json, json_size length)
+{
+    enum json_status status;
+    struct json_sink sink;
+
+    JSON_ASSERT(tape);
+    JSON_ASSERT(json);
+    JSON_ASSERT(length > 0);
+    JSON_ASSERT(max > 0);
+    JSON_ASSERT(read);
+
+    if (!tape || !json || !length || !max || !read)
+        return JSON_INVAL;
+    if (!JSON_FITS_U32(length))
+        return JSON_INVAL;
+    if (*read >= max)
+        return JSON_OUT_OF_TOKEN;
 
+    sink = JSON_SINK_NULL;
+    sink.tape = tape;
+    sink.base = json;
+    sink.max = max;
+    sink.read = *read;
+    status = json_tokenize(&sink, json, length);
+    *read = (int)sink.read;
+    return status;
 }
+/*--------------------------------------------------------------------------
+ *
+                                BATCH
 
+  -------------------------------------------------------------------------*/
 JSON_API int
-json_query_type(struct json_token *toks, int count, const char *path)
+json_batch_split(struct json_record *records, int max, const char *json,
+    json_size length)
 {
-    struct json_token *tok;
+    int n = 0;
+    const char *cur = json;
+    const char *end = json + length;
+
+    JSON_ASSERT(json);
+    if (!json || length <= 0) return 0;
+    while (cur < end && *cur) {
+        const char *line = cur;
+        while (cur < end && *cur && *cur != '\n')
+            cur++;
+        if (cur > line && !(cur - line == 1 && *line == '\r')) {
+            if (records && n < max) {
+                struct json_record *r = &records[n];
+                r->str = line;
+                r->len = (json_size)(cur - line);
+                r->slot = r->offset = r->count = 0;
+                r->status = JSON_OK;
+            }
+            n++;
+        }
+        if (cur < end && *cur == '\n')
+            cur++;
+    }
+    return n;
+}
+
+JSON_API void
+json_batch_begin(struct json_batch *batch, struct json_record *records,
+    int count, struct json_batch_slot *slots, int slot_count,
+    const struct json_allocator *alloc)
+{
+    int i;
+    JSON_ASSERT(batch);
+    JSON_ASSERT(records);
+    JSON_ASSERT(slots);
+    JSON_ASSERT(slot_count > 0);
+    if (!batch) return;
+
+    batch->records = records;
+    batch->count = count;
+    batch->slots = slots;
+    batch->slot_count = slot_count;
+    batch->alloc = alloc;
+    for (i = 0; slots && i < slot_count; ++i)
+        slots[i].read = 0;
+}
+
+JSON_API void
+json_batch_run(void *userdata, struct scheduler *sched, unsigned int begin,
+    unsigned int end, unsigned int thread)
+{
+    unsigned int i;
+    struct json_sink sink;
+    struct json_batch_slot *slot;
+    struct json_batch *batch = (struct json_batch*)userdata;
+
+    (void)sched;
+    JSON_ASSERT(batch);
+    JSON_ASSERT(thread < (unsigned)batch->slot_count);
+    if (!batch || thread >= (unsigned)batch->slot_count)
+        return;
+
+    /* every thread only writes into its own token slot */
+    slot = &batch->slots[thread];
+    sink = JSON_SINK_NULL;
+    sink.toks = slot->toks;
+    sink.max = slot->max;
+    sink.read = slot->read;
+    sink.alloc = batch->alloc;
+
+    for (i = begin; i < end && i < (unsigned)batch->count; ++i) {
+        struct json_record *r = &batch->records[i];
+        r->slot = (int)thread;
+        r->offset = sink.read;
+        sink.parent = -1;
+        r->status = json_tokenize(&sink, r->str, r->len);
+        if (r->status != JSON_OK)
+            sink.read = r->offset;
+        r->count = sink.read - r->offset;
+    }
+    slot->toks = sink.toks;
+    slot->max = sink.max;
+    slot->read = sink.read;
+}
+
+JSON_API struct json_token*
+json_batch_tokens(const struct json_batch *batch, int record)
+{
+    const struct json_record *r;
+    JSON_ASSERT(batch);
+    if (!batch || record < 0 || record >= batch->count)
+        return NULL;
+    r = &batch->records[record];
+    if (r->status != JSON_OK || !r->count)
+        return NULL;
+    return batch->slots[r->slot].toks + r->offset;
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                STREAM
+
+  -------------------------------------------------------------------------*/
+JSON_API void
+json_stream_begin(struct json_stream *s, char *buffer, int capacity,
+    json_event_f callback, void *userdata)
+{
+    JSON_ASSERT(s);
+    JSON_ASSERT(callback);
+    if (!s) return;
+    s->callback = callback;
+    s->userdata = userdata;
+    s->buffer = buffer;
+    s->capacity = (buffer) ? capacity: 0;
+    s->go = json_go_struct;
+    s->used = 0;
+    s->partial = 0;
+    s->key = 0;
+    s->utf8_remain = 0;
+    s->depth = 0;
+}
+
+/* appends the unfinished part of a token to the stream buffer */
+JSON_INTERN int
+json_stream_save(struct json_stream *s, const char *begin, const char *end)
+{
+    if ((int)(end - begin) > s->capacity - s->used)
+        return 0;
+    while (begin < end)
+        s->buffer[s->used++] = *begin++;
+    return 1;
+}
+
+/* emits a completed value or key token between begin and end */
+JSON_INTERN enum json_status
+json_stream_value(struct json_stream *s, const char *begin, const char *end)
+{
+    struct json_token tok = JSON_TOKEN_NULL;
+    if (s->partial) {
+        if (!json_stream_save(s, begin, end))
+            return JSON_OUT_OF_MEMORY;
+        begin = s->buffer;
+        end = s->buffer + s->used;
+        s->partial = 0;
+        s->used = 0;
+    }
+    tok.str = begin;
+    tok.len = (int)(end - begin);
+    tok.type = json_type_char(*begin);
+    if (tok.type == JSON_STRING) {
+        tok.str++;
+        tok.len -= 2;
+    }
+    tok.flags = json_flags(tok.type, tok.str, tok.len);
+    if (tok.type == JSON_STRING)
+        tok.flags = json_escape_flag(tok.str, tok.len);
+    if (s->key && s->depth && s->type[s->depth-1] == JSON_OBJECT) {
+        s->callback(s->userdata, JSON_EVENT_KEY, &tok, s->depth);
+    } else {
+        if (s->depth) s->children[s->depth-1]++;
+        s->callback(s->userdata, JSON_EVENT_VALUE, &tok, s->depth);
+    }
+    return JSON_OK;
+}
+
+JSON_API enum json_status
+json_stream_feed(struct json_stream *s, const char *chunk, int length)
+{
+    int len;
+    const char *cur, *next;
+    const char *begin = chunk;
+    struct json_token tok = JSON_TOKEN_NULL;
+    enum json_status status;
+
+    JSON_ASSERT(s);
+    JSON_ASSERT(chunk);
+    if (!s || !chunk || length < 0 || !s->go)
+        return JSON_INVAL;
+
+    for (cur = chunk, len = length; len && *cur; cur++, len--) {
+        unsigned char c = (unsigned char)*cur;
+        switch (s->go[c]) {
+        case JSON_STATE_FAILED: return JSON_PARSING_ERROR;
+        case JSON_STATE_LOOP: {
+            if (c == ',')
+                s->key = (s->depth && s->type[s->depth-1] == JSON_OBJECT);
+        } break;
+        case JSON_STATE_SEP: s->key = 0; break;
+        case JSON_STATE_UP: {
+            if (s->depth >= JSON_STREAM_DEPTH)
+                return JSON_OUT_OF_MEMORY;
+            if (s->depth) s->children[s->depth-1]++;
+            tok.type = (c == '{') ? JSON_OBJECT: JSON_ARRAY;
+            tok.str = cur;
+            tok.len = 1;
+            tok.children = 0;
+            s->callback(s->userdata, JSON_EVENT_BEGIN, &tok, s->depth);
+            s->type[s->depth] = (unsigned char)tok.type;
+            s->children[s->depth++] = 0;
+            s->key = (c == '{');
+        } break;
+        case JSON_STATE_DOWN: {
+            if (!s->depth) return JSON_PARSING_ERROR;
+            s->depth--;
+            tok.type = (enum json_token_type)s->type[s->depth];
+            tok.str = cur;
+            tok.len = 1;
+            tok.children = s->children[s->depth];
+            s->callback(s->userdata, JSON_EVENT_END, &tok, s->depth);
+            s->key = 0;
+        } break;
+        case JSON_STATE_QUP: {
+            s->go = json_go_string;
+            begin = cur;
+            /* jump over plain string content */
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (int)(next - cur) - 1;
+            cur = next - 1;
+        } break;
+        case JSON_STATE_QDOWN: {
+            s->go = json_go_struct;
+            status = json_stream_value(s, begin, cur + 1);
+            if (status != JSON_OK) return status;
+        } break;
+        case JSON_STATE_ESC: s->go = json_go_esc; break;
+        case JSON_STATE_UNESC: {
+            s->go = json_go_string;
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (int)(next - cur) - 1;
+            cur = next - 1;
+        } break;
+        case JSON_STATE_BARE: s->go = json_go_bare; begin = cur; break;
+        case JSON_STATE_UNBARE: {
+            s->go = json_go_struct;
+            status = json_stream_value(s, begin, cur);
+            if (status != JSON_OK) return status;
+            cur--; len++;
+        } break;
+        case JSON_STATE_UTF8_2: s->go = json_go_utf8; s->utf8_remain = 1; break;
+        case JSON_STATE_UTF8_3: s->go = json_go_utf8; s->utf8_remain = 2; break;
+        case JSON_STATE_UTF8_4: s->go = json_go_utf8; s->utf8_remain = 3; break;
+        case JSON_STATE_UTF8_NEXT: {
+            if (--s->utf8_remain) break;
+            s->go = json_go_string;
+            next = json_scan_string(cur + 1, cur + len);
+            len -= (int)(next - cur) - 1;
+            cur = next - 1;
+        } break;
+        default: break;
+        }
+    }
+
+    if (s->go != json_go_struct) {
+        /* token continues inside the next chunk */
+        if (!json_stream_save(s, begin, cur))
+            return JSON_OUT_OF_MEMORY;
+        s->partial = 1;
+    }
+    return JSON_OK;
+}
+
+JSON_API enum json_status
+json_stream_end(struct json_stream *s)
+{
+    enum json_status status = JSON_OK;
+    JSON_ASSERT(s);
+    if (!s || !s->go) return JSON_INVAL;
+    if (s->go == json_go_bare) {
+        /* bare value at the end of input */
+        s->go = json_go_struct;
+        status = json_stream_value(s, s->buffer, s->buffer);
+    }
+    if (s->go != json_go_struct || s->depth)
+        status = JSON_PARSING_ERROR;
+    s->go = NULL;
+    return status;
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                INDEX
+
+  -------------------------------------------------------------------------*/
+/* bitmasks for each character class of a 64 byte block. Bit n is byte n. */
+struct json_block {
+    json_uint64 quote;
+    json_uint64 bslash;
+    json_uint64 op;
+    json_uint64 ws;
+    json_uint64 ctrl;
+    json_uint64 zero;
+    json_uint64 high;
+};
+
+/* classifies each character of a 64 byte block */
+JSON_INTERN void
+json_classify(struct json_block *b, const unsigned char *src)
+{
+    int i;
+    b->quote = b->bslash = b->op = 0;
+    b->ws = b->ctrl = b->zero = b->high = 0;
+#ifdef JSON_VEC_WIDTH
+    for (i = 0; i < 64; i += JSON_VEC_WIDTH) {
+        JSON_VEC v = JSON_VLOAD(src + i);
+        JSON_VEC op = JSON_VOR(JSON_VOR(JSON_VOR(JSON_VEQ(v, '{'), JSON_VEQ(v, '}')),
+            JSON_VOR(JSON_VEQ(v, '['), JSON_VEQ(v, ']'))),
+            JSON_VOR(JSON_VOR(JSON_VEQ(v, ':'), JSON_VEQ(v, ',')), JSON_VEQ(v, '=')));
+        JSON_VEC ws = JSON_VOR(JSON_VOR(JSON_VEQ(v, ' '), JSON_VEQ(v, '\t')),
+            JSON_VOR(JSON_VEQ(v, '\r'), JSON_VEQ(v, '\n')));
+        b->quote |= JSON_VMASK(JSON_VEQ(v, '"')) << i;
+        b->bslash |= JSON_VMASK(JSON_VEQ(v, '\\')) << i;
+        b->zero |= JSON_VMASK(JSON_VEQ(v, 0)) << i;
+        b->ctrl |= JSON_VMASK(JSON_VLE(v, 0x1F)) << i;
+        b->high |= (JSON_VMASK(v) | JSON_VMASK(JSON_VEQ(v, 0x7F))) << i;
+        b->op |= JSON_VMASK(op) << i;
+        b->ws |= JSON_VMASK(ws) << i;
+    }
+#else
+    for (i = 0; i < 64; ++i) {
+        json_uint64 bit = (json_uint64)1 << i;
+        char c = json_char_class[src[i]];
+        if (src[i] >= 0x7F) b->high |= bit;
+        if (!c) continue;
+        if (c & JSON_CLASS_QUOTE) b->quote |= bit;
+        if (c & JSON_CLASS_BSLASH) b->bslash |= bit;
+        if (c & JSON_CLASS_OP) b->op |= bit;
+        if (c & JSON_CLASS_WS) b->ws |= bit;
+        if (c & JSON_CLASS_CTRL) b->ctrl |= bit;
+        if (c & JSON_CLASS_ZERO) b->zero |= bit;
+    }
+#endif
+}
+
+/* sets every bit between an opening and closing quote (inclusive/exclusive) */
+JSON_INTERN json_uint64
+json_prefix_xor(json_uint64 x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/* returns the mask of characters escaped by a backslash inside a block.
+ * `carry` is set if the first character of the next block is escaped. */
+JSON_INTERN json_uint64
+json_escaped(json_uint64 bslash, json_uint64 *carry)
+{
+    json_uint64 m, escaped = *carry;
+    *carry = 0;
+    for (m = bslash; m; m &= m - 1) {
+        json_uint64 bit = m & (~m + 1);
+        if (escaped & bit) continue;
+        if (bit >> 63) *carry = 1;
+        else escaped |= bit << 1;
+    }
+    return escaped;
+}
+
+/* returns zero if a string body contains DEL or an invalid UTF-8 sequence */
+JSON_INTERN int
+json_check_string(const char *cur, const char *end)
+{
+    int remain;
+    for (cur = json_scan_string(cur, end); cur < end; cur = json_scan_string(cur, end)) {
+        switch (json_go_string[(unsigned char)*cur++]) {
+        case JSON_STATE_FAILED: return 0;
+        case JSON_STATE_UTF8_2: remain = 1; break;
+        case JSON_STATE_UTF8_3: remain = 2; break;
+        case JSON_STATE_UTF8_4: remain = 3; break;
+        default: continue;
+        }
+        for (; remain; --remain, ++cur) {
+            if (cur >= end || json_go_utf8[(unsigned char)*cur] != JSON_STATE_UTF8_NEXT)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+JSON_API enum json_status
+json_index(unsigned *index, json_size max, json_size *count, const char *json,
+    json_size length)
+{
+    json_size pos;
+    json_size n = 0;
+    int done = 0;
+    json_uint64 prev_string = 0;
+    /* all bits set if the previous block ended inside a string */
+    json_uint64 prev_scalar = 0;
+    /* set if the last byte of the previous block was part of a bare value */
+    json_uint64 prev_escaped = 0;
+    /* set if the first byte of the current block is escaped */
+    json_size open = 0;
+    /* opening quote of the last string */
+    int high = 0;
+    /* set if the last string may contain DEL or non ASCII characters */
+    const unsigned char *src = (const unsigned char*)json;
+
+    JSON_ASSERT(index);
+    JSON_ASSERT(count);
+    JSON_ASSERT(json);
+    if (!index || !count || !json || length <= 0 || !JSON_FITS_U32(length))
+        return JSON_INVAL;
+
+    for (pos = 0; pos < length && !done; pos += 64) {
+        struct json_block b;
+        unsigned char tmp[64];
+        const unsigned char *blk = src + pos;
+        json_uint64 valid = ~(json_uint64)0;
+        json_uint64 escaped, quotes, string, scalar, bits, m;
+
+        if (length - pos < 64) {
+            int i;
+            for (i = 0; i < 64; ++i)
+                tmp[i] = (pos + i < length) ? src[pos + i] : 0;
+            blk = tmp;
+        }
+        json_classify(&b, blk);
+        if (b.zero) {
+            /* end of string or input inside this block */
+            valid = (b.zero & (~b.zero + 1)) - 1;
+            b.quote &= valid; b.bslash &= valid;
+            b.op &= valid; b.ctrl &= valid;
+            done = 1;
+        }
+
+        /* every backslash not escaped itself escapes the next character */
+        escaped = json_escaped(b.bslash, &prev_escaped);
+        for (m = escaped & valid; m; m &= m - 1) {
+            if (!json_go_esc[blk[json_ctz(m)]])
+                return JSON_PARSING_ERROR;
+        }
+
+        /* string regions and unescaped control characters inside them */
+        quotes = b.quote & ~escaped;
+        string = json_prefix_xor(quotes) ^ prev_string;
+        prev_string = (json_uint64)0 - (string >> 63);
+        if (b.ctrl & string & ~quotes & valid)
+            return JSON_PARSING_ERROR;
+        high |= (b.high & string & valid) != 0;
+
+        /* structural characters, quotes and the first byte of bare values */
+        scalar = valid & ~(b.op | b.ws | quotes | string);
+        bits = (b.op & ~string) | quotes;
+        bits |= scalar & ~((scalar << 1) | prev_scalar);
+        prev_scalar = scalar >> 63;
+
+        for (; bits; bits &= bits - 1) {
+            json_uint64 bit = bits & (~bits + 1);
+            json_size at = pos + json_ctz(bits);
+            if (n >= max) return JSON_OUT_OF_TOKEN;
+            index[n++] = (unsigned)at;
+            if (!(quotes & bit)) continue;
+            if (string & bit) {
+                open = at;
+            } else if (high) {
+                /* only strings in blocks with DEL or non ASCII are checked */
+                if (!json_check_string(json + open + 1, json + at))
+                    return JSON_PARSING_ERROR;
+                high = (b.high & string & valid & ~(bit - 1)) != 0;
+            }
+        }
+    }
+    *count = n;
+    return (prev_string) ? JSON_PARSING_ERROR: JSON_OK;
+}
+
+/* generates tokens from the structural index */
+JSON_INTERN enum json_status
+json_tokenize_indexed(struct json_sink *s, const char *json, json_size length,
+    const unsigned *index, json_size count)
+{
+    json_size i, idx;
+    unsigned depth = 0;
+    for (i = 0; i < count; ++i) {
+        const char *cur = json + index[i];
+        switch (*cur) {
+        case '{': case '[': {
+            if (depth++ == 0) break;
+            if (!json_open(s, (*cur == '{') ? JSON_OBJECT: JSON_ARRAY, cur))
+                return JSON_OUT_OF_TOKEN;
+        } break;
+        case '}': case ']': {
+            if (!depth) return JSON_PARSING_ERROR;
+            if (--depth == 0) break;
+            json_close(s, cur);
+        } break;
+        case ':': case '=': {
+            if (s->parent >= 0 && !s->tape)
+                s->toks[s->parent].children--;
+        } break;
+        case ',': break;
+        case '"': {
+            const char *end;
+            if (++i >= count) return JSON_PARSING_ERROR;
+            end = json + index[i];
+            idx = json_emit(s, JSON_STRING, cur + 1, (json_size)(end - cur) - 1);
+            if (idx < 0) return JSON_OUT_OF_TOKEN;
+            if (!s->tape)
+                s->toks[idx].flags |= json_escape_flag(cur + 1, (json_size)(end - cur) - 1);
+        } break;
+        default: {
+            /* bare value: scan until the end by the state table */
+            unsigned end = index[i];
+            unsigned char c = (unsigned char)*cur;
+            if (json_go_struct[c] != JSON_STATE_BARE)
+                return JSON_PARSING_ERROR;
+            for (; (json_size)end < length && json[end]; ++end) {
+                char state = json_go_bare[(unsigned char)json[end]];
+                if (state == JSON_STATE_FAILED) return JSON_PARSING_ERROR;
+                if (state == JSON_STATE_UNBARE) break;
+            }
+            if (json_emit(s, json_type_char(*cur), cur, (json_size)(end - index[i])) < 0)
+                return JSON_OUT_OF_TOKEN;
+            while (i + 1 < count && index[i+1] < end) i++;
+        } break;
+        }
+    }
+    return (depth) ? JSON_PARSING_ERROR: JSON_OK;
+}
+
+JSON_API enum json_status
+json_load_indexed(struct json_token *toks, json_size max, json_size *read,
+    const char *json, json_size length, const unsigned *index, json_size count)
+{
+    enum json_status status;
+    struct json_sink sink;
+
     JSON_ASSERT(toks);
+    JSON_ASSERT(json);
+    JSON_ASSERT(index);
+    JSON_ASSERT(max > 0);
+    JSON_ASSERT(read);
+
+    if (!toks || !json || !length || !max || !read || !index)
+        return JSON_INVAL;
+    if (*read >= max)
+        return JSON_OUT_OF_TOKEN;
+
+    sink = JSON_SINK_NULL;
+    sink.toks = toks;
+    sink.max = max;
+    sink.read = *read;
+    status = json_tokenize_indexed(&sink, json, length, index, count);
+    *read = sink.read;
+    return status;
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                SPLIT
+
+  -------------------------------------------------------------------------*/
+/* walks the brackets outside of strings from `cur` to `end` and stops at
+ * the first comma at depth one or the bracket closing the array. The string
+ * state is 0 outside, 1 inside and 2 directly after a backslash inside of a
+ * string. */
+JSON_INTERN const char*
+json_split_walk(const char *cur, const char *end, json_size *depth, int *string)
+{
+    json_size d = *depth;
+    int s = *string;
+    while (cur < end) {
+        if (s == 1) {
+            cur = json_scan_string(cur, end);
+            if (cur >= end) break;
+            if (*cur == '"') s = 0;
+            else if (*cur == '\\') s = 2;
+        } else if (s == 2) {
+            s = 1;
+        } else if (*cur == '"') {
+            s = 1;
+        } else if (*cur == '[' || *cur == '{') {
+            d++;
+        } else if (*cur == ']' || *cur == '}') {
+            if (--d <= 0) break;
+        } else if (*cur == ',' && d == 1) break;
+        cur++;
+    }
+    *depth = d;
+    *string = s;
+    return cur;
+}
+
+/* string state of a chunk beginning inside a string. The first byte is
+ * escaped if it follows an odd number of backslashes. */
+JSON_INTERN int
+json_split_state(const char *json, const char *begin)
+{
+    const char *cur = begin;
+    while (cur > json && cur[-1] == '\\')
+        cur--;
+    return ((begin - cur) & 1) ? 2: 1;
+}
+
+JSON_API enum json_status
+json_split_begin(struct json_split *split, struct json_split_chunk *chunks,
+    int count, const char *json, json_size length,
+    const struct json_allocator *alloc)
+{
+    int i;
+    const char *cur = json;
+    const char *end = json + length;
+
+    JSON_ASSERT(split);
+    JSON_ASSERT(chunks);
     JSON_ASSERT(count > 0);
-    JSON_ASSERT(path);
-    if (!toks || !count || !path)
-        return JSON_NONE;
+    JSON_ASSERT(json);
+    if (!split || !chunks || count <= 0 || !json || length <= 0)
+        return JSON_INVAL;
 
-    tok = json_query(toks, count, path);
-    if (!tok) return JSON_NONE;
-    return tok->type;
+    while (cur < end && (json_char_class[(unsigned char)*cur] & JSON_CLASS_WS))
+        cur++;
+    if (cur >= end || *cur != '[')
+        return JSON_INVAL;
+    cur++;
+
+    split->json = json;
+    split->length = length;
+    split->close = NULL;
+    split->chunks = chunks;
+    split->count = count;
+    split->alloc = alloc;
+    for (i = 0; i < count; ++i) {
+        struct json_split_chunk *c = &chunks[i];
+        c->begin = cur + (json_size)((double)(end - cur) * i / count);
+        c->end = cur + (json_size)((double)(end - cur) * (i + 1) / count);
+        c->level = c->read = c->elements = 0;
+        c->state = 0;
+        c->status = JSON_OK;
+    }
+    chunks[count-1].end = end;
+    return JSON_OK;
+}
+
+JSON_API void
+json_split_scan(void *userdata, struct scheduler *sched, unsigned int begin,
+    unsigned int end, unsigned int thread)
+{
+    unsigned int i;
+    struct json_split *split = (struct json_split*)userdata;
+
+    (void)sched;
+    (void)thread;
+    JSON_ASSERT(split);
+    if (!split) return;
+
+    for (i = begin; i < end && i < (unsigned)split->count; ++i) {
+        json_size pos, length;
+        struct json_split_chunk *c = &split->chunks[i];
+        const unsigned char *src = (const unsigned char*)c->begin;
+        json_uint64 prev_string = 0;
+        /* all bits set if the previous block ended inside a string */
+        json_uint64 prev_escaped = (json_split_state(split->json, c->begin) == 2);
+        /* set if the first byte of the current block is escaped */
+
+        c->depth[0] = c->depth[1] = 0;
+        length = (json_size)(c->end - c->begin);
+        for (pos = 0; pos < length; pos += 64) {
+            struct json_block b;
+            unsigned char tmp[64];
+            const unsigned char *blk = src + pos;
+            json_uint64 valid = ~(json_uint64)0;
+            json_uint64 string, m;
+
+            if (length - pos < 64) {
+                int j;
+                for (j = 0; j < 64; ++j)
+                    tmp[j] = (pos + j < length) ? src[pos + j] : 0;
+                valid = ((json_uint64)1 << (length - pos)) - 1;
+                blk = tmp;
+            }
+            json_classify(&b, blk);
+            string = json_prefix_xor(b.quote & ~json_escaped(b.bslash, &prev_escaped) & valid);
+            string ^= prev_string;
+            prev_string = (json_uint64)0 - (string >> 63);
+
+            /* string regions of a chunk beginning outside of a string are
+             * exactly the structure of one beginning inside of a string */
+            for (m = b.op & valid; m; m &= m - 1) {
+                int bit = json_ctz(m);
+                int s = (int)((string >> bit) & 1);
+                unsigned char ch = blk[bit];
+                if (ch == '[' || ch == '{')
+                    c->depth[s]++;
+                else if (ch == ']' || ch == '}')
+                    c->depth[s]--;
+            }
+        }
+        c->string[0] = (prev_string != 0);
+        c->string[1] = !c->string[0];
+    }
+}
+
+JSON_API enum json_status
+json_split_reconcile(struct json_split *split)
+{
+    int i;
+    int string = 0;
+    json_size level = 1;
+    const char *cur;
+
+    JSON_ASSERT(split);
+    if (!split || !split->chunks)
+        return JSON_INVAL;
+
+    for (i = 0; i < split->count; ++i) {
+        struct json_split_chunk *c = &split->chunks[i];
+        c->level = level;
+        c->state = (string) ? json_split_state(split->json, c->begin): 0;
+        level += c->depth[string];
+        string = c->string[string];
+    }
+
+    /* the array has to be closed by the last bracket of the document.
+     * Arrays closed earlier are caught by the chunks while parsing. */
+    split->close = NULL;
+    cur = split->json + split->length;
+    while (cur > split->json && (!cur[-1] ||
+        (json_char_class[(unsigned char)cur[-1]] & JSON_CLASS_WS)))
+        cur--;
+    if (level || string || cur == split->json || cur[-1] != ']')
+        return JSON_PARSING_ERROR;
+    split->close = cur - 1;
+    return JSON_OK;
+}
+
+JSON_API void
+json_split_run(void *userdata, struct scheduler *sched, unsigned int begin,
+    unsigned int end, unsigned int thread)
+{
+    unsigned int i;
+    struct json_sink sink;
+    struct json_split *split = (struct json_split*)userdata;
+
+    (void)sched;
+    (void)thread;
+    JSON_ASSERT(split);
+    if (!split) return;
+
+    for (i = begin; i < end && i < (unsigned)split->count; ++i) {
+        int s;
+        json_size d, n;
+        const char *from, *to, *limit;
+        struct json_split_chunk *c = &split->chunks[i];
+        struct json_split_chunk *next = c + 1;
+
+        c->read = c->elements = 0;
+        c->status = (split->close) ? JSON_OK: JSON_PARSING_ERROR;
+        if (!split->close || c->begin > split->close)
+            continue;
+
+        /* elements begin after the first top level comma of the chunk */
+        from = c->begin;
+        if (i > 0) {
+            d = c->level;
+            s = c->state;
+            limit = (c->end < split->close) ? c->end: split->close;
+            from = json_split_walk(c->begin, limit, &d, &s);
+            if (from >= limit) continue;
+            if (*from++ != ',') {
+                c->status = JSON_PARSING_ERROR;
+                continue;
+            }
+        }
+        /* and end at the first one of the following chunk */
+        to = split->close;
+        if (i + 1 < (unsigned)split->count && next->begin <= split->close) {
+            d = next->level;
+            s = next->state;
+            to = json_split_walk(next->begin, split->close, &d, &s);
+            if (to < split->close && *to != ',') {
+                c->status = JSON_PARSING_ERROR;
+                continue;
+            }
+        }
+
+        sink = JSON_SINK_NULL;
+        sink.toks = c->toks;
+        sink.max = c->max;
+        sink.alloc = split->alloc;
+        sink.depth = 1;
+        c->status = json_tokenize(&sink, from, (json_size)(to - from));
+        c->toks = sink.toks;
+        c->max = sink.max;
+        c->read = (c->status == JSON_OK) ? sink.read: 0;
+        for (n = 0; n < c->read; n += c->toks[n].sub + 1)
+            c->elements++;
+    }
+}
+
+JSON_API enum json_status
+json_split_join(struct json_token **toks, json_size *max, json_size *read,
+    const struct json_split *split)
+{
+    int i;
+    json_size n, total;
+
+    JSON_ASSERT(toks);
+    JSON_ASSERT(max);
+    JSON_ASSERT(read);
+    JSON_ASSERT(split);
+    if (!toks || !max || !read || !split || !split->chunks)
+        return JSON_INVAL;
+
+    total = *read;
+    for (i = 0; i < split->count; ++i) {
+        if (split->chunks[i].status != JSON_OK)
+            return split->chunks[i].status;
+        total += split->chunks[i].read;
+    }
+    if (total > *max) {
+        void *mem;
+        const struct json_allocator *alloc = split->alloc;
+        if (!alloc || !alloc->resize)
+            return JSON_OUT_OF_TOKEN;
+        mem = alloc->resize(alloc->userdata, *toks,
+            total * (json_size)sizeof(struct json_token));
+        if (!mem) return JSON_OUT_OF_TOKEN;
+        *toks = (struct json_token*)mem;
+        *max = total;
+    }
+    /* tokens only reference relative counts and can be copied as is */
+    for (i = 0; i < split->count; ++i) {
+        const struct json_split_chunk *c = &split->chunks[i];
+        for (n = 0; n < c->read; ++n)
+            (*toks)[(*read)++] = c->toks[n];
+    }
+    return JSON_OK;
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                QUERY
+
+  -------------------------------------------------------------------------*/
+JSON_INTERN const char*
+json_strchr(const char *str, char c, int len)
+{
+    int neg = (len < 0) ? 1: 0;
+    int dec = neg ? 0 : 1;
+    len = neg ? 0 : len;
+    if (!str) return NULL;
+    while (*str && len >= 0) {
+        if (*str == c)
+            return str;
+        len -= dec;
+        str++;
+    }
+    if (neg) return str;
+    return NULL;
+}
+
+JSON_INTERN const char*
+json_path_parse_name(struct json_token *tok, const char *path,
+    char delimiter)
+{
+    const char *del;
+    const char *begin, *end;
+    if (!path || *path == '\0')
+        return NULL;
+
+    tok->str = path;
+    del = json_strchr(tok->str, delimiter, -1);
+    begin = json_strchr(tok->str, '[', -1);
+    end = json_strchr(tok->str, ']', -1);
+
+    /* array part left */
+    if (begin && end && begin == tok->str) {
+        tok->len = (int)((end - begin) + 1);
+        if (*(end + 1) == '\0')
+            return NULL;
+        if (*(end + 1) == '.')
+            return(end + 2);
+        else return(end + 1);
+    }
+
+    /* only array after name */
+    if (begin < del) {
+        tok->len = (int)(begin - tok->str);
+        return begin;
+    }
+
+    if (!del) return NULL;
+    if (*del == '\0') {
+        tok->len = (int)(del - tok->str);
+        return NULL;
+    }
+    tok->len = (int)(del - tok->str);
+    return del+1;
+}
+
+JSON_INTERN int
+json_path_parse_array(struct json_token *array, const struct json_token *token)
+{
+    const char *begin;
+    const char *end;
+
+    *array = JSON_TOKEN_NULL;
+    array->str = token->str;
+    begin = json_strchr(array->str, '[', (int)token->len);
+    if (!begin || ((json_size)(begin - array->str) >= token->len))
+        return 0;
+
+    end = json_strchr(begin, ']', (int)(token->len - (json_size)(begin - array->str)));
+    if (!end || ((json_size)(end - array->str) >= token->len))
+        return 0;
+
+    array->str = begin + 1;
+    array->len = (int)((end-1) - begin);
+    return 1;
+}
+
+JSON_API struct json_token*
+json_query(struct json_token *toks, json_size count, const char *path)
+{
+    json_size i = 0;
+    int begin = 1;
+    struct json_token *iter = NULL;
+    /* iterator to step over each token in the toks array */
+    struct json_token name;
+    /* current segment in the path to search in the tree for */
+    struct json_token array;
+    /* array token to store the current path segment array index */
+    struct json_object {json_size index, size;} obj;
+    /* current object iterator with current pair index and total pairs in object */
+
+    JSON_ASSERT(toks);
+    JSON_ASSERT(count > 0);
+    if (!toks || !count) return iter;
+    if (!path) return &toks[i];
+
+    iter = &toks[i];
+    array.len = 0;
+    array.str = NULL;
+
+    path = json_path_parse_name(&name, path, JSON_DELIMITER);
+    while (1) {
+        if (iter->type == JSON_OBJECT || iter->type == JSON_ARRAY || begin) {
+            /* setup iteration over elements inside a object or array */
+            obj.index = 0;
+            if (begin) {
+                begin = 0;
+                obj.size = count;
+            } else if (iter->type == JSON_OBJECT) {
+                obj.size = iter->children;
+                if ((i + 1) > count) return NULL;
+                iter = &toks[++i];
+            } else {
+                json_number n;
+                json_size j = 0;
+
+                /* array object so set iterator to array index */
+                if (!json_path_parse_array(&array, &name))
+                    return NULL;
+                if ((i+1) > count)
+                    return NULL;
+                if (array.len < 1)
+                    return NULL;
+                if (json_convert(&n, &array) != JSON_NUMBER)
+                    return NULL;
+                if ((json_size)n >= iter->children)
+                    return NULL;
+                array.str = NULL;
+                array.len = 0;
+
+                /* iterate over each array element and find the correct index */
+                iter++; i++;
+                for (j = 0; j < n; ++j) {
+                    if (iter->type == JSON_ARRAY || iter->type == JSON_OBJECT) {
+                        i = i + (iter->sub) + 1;
+                    } else i += 1;
+                    if (i > count)
+                        return NULL;
+                    iter = &toks[i];
+                }
+                if (!path) return iter;
+                path = json_path_parse_name(&name, path, JSON_DELIMITER);
+            }
+            continue;
+        }
+        {
+            /* check if current table element is equal to the current path  */
+            if (!json_lcmp(iter, name.str, name.len)) {
+                /* correct token found and end of path */
+                if (!path) {
+                    if ((i + 1) > count)
+                        return NULL;
+                    return (iter + 1);
+                }
+                /* check if path points to invalid token */
+                if ((i+1) > count)
+                    return NULL;
+                if(toks[i+1].type != JSON_OBJECT && toks[i+1].type != JSON_ARRAY)
+                    return NULL;
+
+                /* look deeper into child object/array */
+                iter = &toks[++i];
+                path = json_path_parse_name(&name, path, JSON_DELIMITER);
+            } else {
+                /* key is not correct iterate until end of object */
+                if (++obj.index >= obj.size)
+                    return NULL;
+                if ((i + 1) >= count)
+                    return NULL;
+                if (iter[1].type == JSON_ARRAY || iter[1].type == JSON_OBJECT) {
+                    i = i + (iter[1].sub + 2);
+                } else i = i + 2;
+                if (i >= count)
+                    return NULL;
+                iter = &toks[i];
+            }
+        }
+    }
+    return iter;
+}
+
+JSON_API int
+json_query_number(json_number *num, struct json_token *toks, json_size count,
+    const char *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(count > 0);
+    JSON_ASSERT(num);
+    JSON_ASSERT(path);
+    if (!toks || !count || !num || !path)
+        return JSON_NONE;
+
+    tok = json_query(toks, count, path);
+    if (!tok) return JSON_NONE;
+    if (tok->type != JSON_NUMBER)
+        return tok->type;
+    return json_convert(num, tok);
+
+}
+
+JSON_API int
+json_query_int(json_int64 *num, struct json_token *toks, json_size count,
+    const char *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(count > 0);
+    JSON_ASSERT(num);
+    JSON_ASSERT(path);
+    if (!toks || !count || !num || !path)
+        return JSON_NONE;
+
+    tok = json_query(toks, count, path);
+    if (!tok) return JSON_NONE;
+    if (tok->type != JSON_NUMBER)
+        return tok->type;
+    return json_convert_int(num, tok);
+}
+
+JSON_API int
+json_query_string(char *buffer, json_size max, json_size *size,
+    struct json_token *toks, json_size count, const char *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(count > 0);
+    JSON_ASSERT(buffer);
+    JSON_ASSERT(size);
+    JSON_ASSERT(path);
+    if (!toks || !count || !buffer || !size || !path)
+        return JSON_NONE;
+
+    tok = json_query(toks, count, path);
+    if (!tok) return JSON_NONE;
+    if (tok->type != JSON_STRING)
+        return tok->type;
+    *size = json_cpy(buffer, max, tok);
+    return tok->type;
+
+}
+
+JSON_API int
+json_query_type(struct json_token *toks, json_size count, const char *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(count > 0);
+    JSON_ASSERT(path);
+    if (!toks || !count || !path)
+        return JSON_NONE;
+
+    tok = json_query(toks, count, path);
+    if (!tok) return JSON_NONE;
+    return tok->type;
+}
+
+/* compares a tape string token with a size limited string */
+JSON_INTERN int
+json_tape_lcmp(const struct json_tape *t, const char *json, const char *str, int len)
+{
+    int i;
+    const char *key = json + t->off;
+    if (t->type != JSON_STRING || (int)t->len != len)
+        return 1;
+    for (i = 0; i < len; ++i) {
+        if (key[i] != str[i])
+            return 1;
+    }
+    return 0;
+}
+
+/* the root container is not on the tape. Only whitespace and a quote can
+ * be between its bracket and the first token, documents without brackets
+ * are objects. */
+JSON_INTERN enum json_token_type
+json_tape_root(const struct json_tape *tape, const char *json)
+{
+    const char *cur = json + tape[0].off;
+    while (cur > json) {
+        char c = *--cur;
+        if (c == '[') return JSON_ARRAY;
+        if (c == '{') return JSON_OBJECT;
+    }
+    return JSON_OBJECT;
+}
+
+JSON_API struct json_tape*
+json_tape_query(struct json_tape *tape, int count, const char *json,
+    const char *path)
+{
+    int i = 0;
+    int end = count;
+    int found;
+    struct json_token name;
+    /* current segment in the path to search in the tree for */
+
+    JSON_ASSERT(tape);
+    JSON_ASSERT(count > 0);
+    JSON_ASSERT(json);
+    if (!tape || count <= 0 || !json) return NULL;
+    if (!path) return &tape[0];
+    if (json_tape_root(tape, json) != ((*path == '[') ? JSON_ARRAY: JSON_OBJECT))
+        return NULL;
+
+    while (path) {
+        path = json_path_parse_name(&name, path, JSON_DELIMITER);
+        if (name.str[0] == '[') {
+            /* array index: step over siblings by their next index */
+            int n;
+            json_number num;
+            struct json_token array;
+            if (!json_path_parse_array(&array, &name) || array.len < 1)
+                return NULL;
+            if (json_convert(&num, &array) != JSON_NUMBER || num < 0)
+                return NULL;
+            for (n = (int)num; n && i < end; --n)
+                i = (int)tape[i].next;
+            if (i >= end) return NULL;
+            found = i;
+        } else {
+            /* object: compare every key and skip values */
+            while (i < end) {
+                if (i + 1 >= end) return NULL;
+                if (!json_tape_lcmp(&tape[i], json, name.str, name.len))
+                    break;
+                i = (int)tape[i+1].next;
+            }
+            if (i >= end) return NULL;
+            found = i + 1;
+        }
+        if (!path)
+            return &tape[found];
+        /* keys only step into objects and indexes only into arrays */
+        if (tape[found].type != ((*path == '[') ? JSON_ARRAY: JSON_OBJECT))
+            return NULL;
+        i = found + 1;
+        end = (int)tape[found].next;
+    }
+    return NULL;
+}
+
+JSON_API void
+json_tape_token(struct json_token *tok, const struct json_tape *tape,
+    int index, const char *json)
+{
+    int i;
+    const struct json_tape *t;
+
+    JSON_ASSERT(tok);
+    JSON_ASSERT(tape);
+    JSON_ASSERT(json);
+    if (!tok || !tape || !json) return;
+
+    t = &tape[index];
+    tok->type = (enum json_token_type)t->type;
+    tok->str = json + t->off;
+    tok->len = (json_size)t->len;
+    tok->sub = (json_size)t->next - index - 1;
+    tok->children = 0;
+    tok->flags = json_flags(tok->type, tok->str, tok->len);
+    if (t->type == JSON_STRING)
+        tok->flags = json_escape_flag(tok->str, tok->len);
+    if (t->type != JSON_OBJECT && t->type != JSON_ARRAY)
+        return;
+    for (i = index + 1; i < (int)t->next; i = (int)tape[i].next)
+        tok->children++;
+    if (t->type == JSON_OBJECT)
+        tok->children /= 2;
+}
+
+/* returns 1 if both size limited strings are equal */
+JSON_INTERN int
+json_memeq(const char *a, const char *b, json_size len)
+{
+    while (len && *a == *b) {
+        a++; b++; len--;
+    }
+    return !len;
+}
+
+/* compares an object key token with a size limited string */
+JSON_INTERN int
+json_key_eq(const struct json_token *key, const char *str, json_size len)
+{
+    if (key->len != len)
+        return 0;
+    return !len || (key->str[0] == str[0] && json_memeq(key->str, str, len));
+}
+
+JSON_API int
+json_path_compile(struct json_path *p, const char *path)
+{
+    JSON_ASSERT(p);
+    JSON_ASSERT(path);
+    if (!p || !path) return 0;
+
+    p->count = 0;
+    while (*path) {
+        struct json_path_step *step;
+        if (p->count >= JSON_PATH_MAX_STEPS)
+            return 0;
+        step = &p->steps[p->count++];
+        if (*path == '[') {
+            /* array index */
+            const char *digits = ++path;
+            step->key = NULL;
+            step->len = 0;
+            for (; *path >= '0' && *path <= '9'; ++path) {
+                if (step->len > (JSON_INT_MAX - (*path - '0')) / 10)
+                    return 0;
+                step->len = step->len * 10 + (*path - '0');
+            }
+            if (path == digits || *path++ != ']')
+                return 0;
+        } else {
+            /* object key */
+            step->key = path;
+            while (*path && *path != JSON_DELIMITER && *path != '[')
+                path++;
+            step->len = (int)(path - step->key);
+            if (!step->len) return 0;
+        }
+        if (*path == JSON_DELIMITER && *(++path) == '\0')
+            return 0;
+    }
+    return p->count > 0;
+}
+
+JSON_API struct json_token*
+json_query_compiled(struct json_token *toks, json_size count,
+    const struct json_path *path)
+{
+    int s;
+    json_size i = 0;
+    json_size end = count;
+    json_size found = 0;
+
+    JSON_ASSERT(toks);
+    JSON_ASSERT(path);
+    if (!toks || count <= 0 || !path)
+        return NULL;
+
+    for (s = 0; s < path->count; ++s) {
+        const struct json_path_step *step = &path->steps[s];
+        if (!step->key) {
+            /* step over array elements */
+            int n;
+            for (n = step->len; n && i < end; --n)
+                i += toks[i].sub + 1;
+            if (i >= end) return NULL;
+            found = i;
+        } else {
+            /* compare every object key and step over values */
+            while (i + 1 < end) {
+                if (json_key_eq(&toks[i], step->key, step->len))
+                    break;
+                i += toks[i+1].sub + 2;
+            }
+            if (i + 1 >= end) return NULL;
+            found = i + 1;
+        }
+        if (s + 1 == path->count)
+            break;
+        /* keys only step into objects and indexes only into arrays */
+        if (toks[found].type != (path->steps[s+1].key ? JSON_OBJECT: JSON_ARRAY))
+            return NULL;
+        i = found + 1;
+        end = found + 1 + toks[found].sub;
+    }
+    return &toks[found];
+}
+
+JSON_API void
+json_trie_begin(struct json_trie *trie, struct json_trie_node *nodes, int max)
+{
+    JSON_ASSERT(trie);
+    JSON_ASSERT(nodes);
+    JSON_ASSERT(max > 0);
+    if (!trie) return;
+    trie->nodes = nodes;
+    trie->max = (nodes) ? max: 0;
+    trie->count = 0;
+    if (trie->max <= 0) return;
+    nodes[0].key = NULL;
+    nodes[0].len = 0;
+    nodes[0].child = nodes[0].next = -1;
+    nodes[0].slot = -1;
+    trie->count = 1;
+}
+
+JSON_API int
+json_trie_add(struct json_trie *trie, const struct json_path *path, int slot)
+{
+    int s, node = 0;
+    JSON_ASSERT(trie);
+    JSON_ASSERT(path);
+    if (!trie || !path || !trie->count || !path->count)
+        return 0;
+
+    for (s = 0; s < path->count; ++s) {
+        const struct json_path_step *step = &path->steps[s];
+        struct json_trie_node *n;
+        int c = trie->nodes[node].child;
+
+        /* find matching child or add a new one in front */
+        for (; c >= 0; c = trie->nodes[c].next) {
+            n = &trie->nodes[c];
+            if (n->len != step->len || (!n->key) != (!step->key))
+                continue;
+            if (!n->key || json_memeq(n->key, step->key, n->len))
+                break;
+        }
+        if (c < 0) {
+            if (trie->count >= trie->max)
+                return 0;
+            c = trie->count++;
+            n = &trie->nodes[c];
+            n->key = step->key;
+            n->len = step->len;
+            n->child = -1;
+            n->slot = -1;
+            n->next = trie->nodes[node].child;
+            trie->nodes[node].child = c;
+        }
+        node = c;
+    }
+    trie->nodes[node].slot = slot;
+    return 1;
+}
+
+/* matches all trie children of a node against an object or array range */
+JSON_INTERN int
+json_query_trie(struct json_token **out, int slots, struct json_token *toks,
+    json_size begin, json_size end, int pairs, const struct json_trie *trie, int node)
+{
+    json_size i, index = 0;
+    int n = 0;
+    int max_index = -1;
+    const struct json_trie_node *nodes = trie->nodes;
+
+    /* arrays can stop after the biggest index a path points to */
+    if (!pairs) {
+        int c;
+        for (c = nodes[node].child; c >= 0; c = nodes[c].next)
+            if (!nodes[c].key && nodes[c].len > max_index)
+                max_index = nodes[c].len;
+        if (max_index < 0) return 0;
+    }
+
+    for (i = begin; i < end; ++index) {
+        int c = nodes[node].child;
+        json_size value = (pairs) ? i + 1: i;
+        if (value >= end) break;
+        for (; c >= 0; c = nodes[c].next) {
+            if (pairs && nodes[c].key && json_key_eq(&toks[i], nodes[c].key, nodes[c].len))
+                break;
+            if (!pairs && !nodes[c].key && nodes[c].len == index)
+                break;
+        }
+        if (c >= 0) {
+            const struct json_token *v = &toks[value];
+            if (nodes[c].slot >= 0 && nodes[c].slot < slots && !out[nodes[c].slot]) {
+                out[nodes[c].slot] = &toks[value];
+                n++;
+            }
+            if (nodes[c].child >= 0 && (v->type == JSON_OBJECT || v->type == JSON_ARRAY))
+                n += json_query_trie(out, slots, toks, value + 1, value + 1 + v->sub,
+                        v->type == JSON_OBJECT, trie, c);
+        }
+        if (!pairs && index >= max_index)
+            break;
+        i = value + toks[value].sub + 1;
+    }
+    return n;
+}
+
+JSON_API int
+json_query_multi(struct json_token **out, int slots, struct json_token *toks,
+    json_size count, const struct json_trie *trie)
+{
+    int i, c, pairs = 1;
+    JSON_ASSERT(out);
+    JSON_ASSERT(toks);
+    JSON_ASSERT(trie);
+    if (!out || !toks || count <= 0 || !trie || !trie->count)
+        return 0;
+
+    for (i = 0; i < slots; ++i)
+        out[i] = NULL;
+    /* the root container is not part of the token array so the type of
+     * the first path segments decides between object and array */
+    c = trie->nodes[0].child;
+    if (c >= 0 && !trie->nodes[c].key)
+        pairs = 0;
+    return json_query_trie(out, slots, toks, 0, count, pairs, trie, 0);
+}
+
+/* parses an optionally negative slice bound, returns the end of the number */
+JSON_INTERN const char*
+json_select_bound(json_size *out, const char *cur)
+{
+    int neg = (*cur == '-');
+    json_size n = 0;
+    if (neg) cur++;
+    if (*cur < '0' || *cur > '9')
+        return NULL;
+    for (; *cur >= '0' && *cur <= '9'; ++cur)
+        n = n * 10 + (*cur - '0');
+    *out = (neg) ? -n: n;
+    return cur;
+}
+
+/* parses a JSON Pointer into reference tokens */
+JSON_INTERN int
+json_select_pointer(struct json_select *sel, const char *ptr)
+{
+    sel->count = 0;
+    while (*ptr == '/') {
+        const char *cur;
+        struct json_select_step *step;
+        if (sel->count >= JSON_PATH_MAX_STEPS)
+            return 0;
+        step = &sel->steps[sel->count++];
+        step->kind = JSON_SELECT_MEMBER;
+        step->key = ++ptr;
+        while (*ptr && *ptr != '/') {
+            if (*ptr == '~' && ptr[1] != '0' && ptr[1] != '1')
+                return 0;
+            ptr++;
+        }
+        step->len = (int)(ptr - step->key);
+
+        /* array index without leading zeros, otherwise only a key */
+        step->begin = -1;
+        step->end = step->step = 1;
+        cur = json_select_bound(&step->begin, step->key);
+        if (*step->key == '-' || cur != ptr || (step->len > 1 && *step->key == '0'))
+            step->begin = -1;
+    }
+    return !*ptr && sel->count > 0;
+}
+
+JSON_API int
+json_select_compile(struct json_select *sel, const char *selector)
+{
+    const char *cur = selector;
+    JSON_ASSERT(sel);
+    JSON_ASSERT(selector);
+    if (!sel || !selector) return 0;
+    if (*cur == '/')
+        return json_select_pointer(sel, cur);
+
+    sel->count = 0;
+    while (*cur) {
+        struct json_select_step *step;
+        if (sel->count >= JSON_PATH_MAX_STEPS)
+            return 0;
+        step = &sel->steps[sel->count++];
+        step->key = NULL;
+        step->len = 0;
+        step->begin = 0;
+        step->end = 0;
+        step->step = 1;
+        if (*cur == '[') {
+            cur++;
+            if (*cur == '*') {
+                step->kind = JSON_SELECT_ALL;
+                cur++;
+            } else {
+                /* index or slice with optional bounds and step size */
+                step->kind = JSON_SELECT_INDEX;
+                if (*cur != ':' && !(cur = json_select_bound(&step->begin, cur)))
+                    return 0;
+                if (*cur == ':') {
+                    step->kind = JSON_SELECT_SLICE;
+                    step->end = JSON_SIZE_MAX;
+                    if (*++cur != ':' && *cur != ']' && !(cur = json_select_bound(&step->end, cur)))
+                        return 0;
+                    if (*cur == ':' && *++cur != ']' &&
+                        (!(cur = json_select_bound(&step->step, cur)) || step->step <= 0))
+                        return 0;
+                }
+            }
+            if (*cur++ != ']')
+                return 0;
+        } else {
+            step->kind = JSON_SELECT_KEY;
+            step->key = cur;
+            while (*cur && *cur != JSON_DELIMITER && *cur != '[')
+                cur++;
+            step->len = (int)(cur - step->key);
+            if (!step->len) return 0;
+            if (step->len == 1 && *step->key == '*')
+                step->kind = JSON_SELECT_ALL;
+        }
+        if (*cur == JSON_DELIMITER && *(++cur) == '\0')
+            return 0;
+    }
+    return sel->count > 0;
+}
+
+/* compares an object key with a JSON Pointer reference token */
+JSON_INTERN int
+json_select_key(const struct json_token *key, const char *ref, int len)
+{
+    json_size i = 0;
+    const char *end = ref + len;
+    while (ref < end) {
+        char c = *ref++;
+        if (c == '~') c = (*ref++ == '0') ? '~': '/';
+        if (i >= key->len || key->str[i++] != c)
+            return 0;
+    }
+    return i == key->len;
+}
+
+/* resolves a negative index or bound against the number of elements */
+JSON_INTERN json_size
+json_select_index(json_size index, json_size len)
+{
+    if (index >= 0) return index;
+    index += len;
+    return (index < 0) ? 0: index;
+}
+
+JSON_INTERN json_size json_select_match(struct json_token**, json_size, json_size,
+    struct json_token*, json_size, json_size, int, json_size, const struct json_select*, int);
+
+/* emits a value matched by the last step or matches the next step inside */
+JSON_INTERN json_size
+json_select_value(struct json_token **out, json_size max, json_size n,
+    struct json_token *toks, json_size value, const struct json_select *sel, int s)
+{
+    struct json_token *v = &toks[value];
+    if (s + 1 == sel->count) {
+        if (out && n < max)
+            out[n] = v;
+        return n + 1;
+    }
+    if (v->type != JSON_OBJECT && v->type != JSON_ARRAY)
+        return n;
+    return json_select_match(out, max, n, toks, value + 1, value + 1 + v->sub,
+        v->type == JSON_OBJECT, (json_size)v->children, sel, s + 1);
+}
+
+/* matches one step against the members of an object or array range */
+JSON_INTERN json_size
+json_select_match(struct json_token **out, json_size max, json_size n,
+    struct json_token *toks, json_size begin, json_size end, int pairs,
+    json_size len, const struct json_select *sel, int s)
+{
+    json_size i = begin, index;
+    json_size first, last;
+    const struct json_select_step *step = &sel->steps[s];
+
+    if (pairs) {
+        if (step->kind == JSON_SELECT_ALL) {
+            for (; i + 1 < end; i += toks[i+1].sub + 2)
+                n = json_select_value(out, max, n, toks, i + 1, sel, s);
+            return n;
+        }
+        if (step->kind != JSON_SELECT_KEY && step->kind != JSON_SELECT_MEMBER)
+            return n;
+        /* keys are unique like for json_query */
+        for (; i + 1 < end; i += toks[i+1].sub + 2) {
+            if ((step->kind == JSON_SELECT_KEY) ?
+                json_key_eq(&toks[i], step->key, step->len):
+                json_select_key(&toks[i], step->key, step->len))
+                return json_select_value(out, max, n, toks, i + 1, sel, s);
+        }
+        return n;
+    }
+
+    switch (step->kind) {
+    case JSON_SELECT_ALL:
+        for (; i < end; i += toks[i].sub + 1)
+            n = json_select_value(out, max, n, toks, i, sel, s);
+        return n;
+    case JSON_SELECT_KEY:
+        return n;
+    case JSON_SELECT_MEMBER:
+        if (step->begin < 0) return n;
+        first = step->begin;
+        last = first + 1;
+        break;
+    default:
+        /* element range of the step, unknown lengths are counted first */
+        if (len < 0 && (step->begin < 0 || step->end < 0)) {
+            for (len = 0; i < end; i += toks[i].sub + 1)
+                len++;
+            i = begin;
+        }
+        if (step->kind == JSON_SELECT_INDEX && step->begin < 0 && step->begin + len < 0)
+            return n;
+        first = json_select_index(step->begin, len);
+        last = (step->kind == JSON_SELECT_SLICE) ?
+            json_select_index(step->end, len): first + 1;
+        break;
+    }
+
+    /* skip to the first element and step through the range */
+    for (index = 0; i < end && index < last; ++index) {
+        if (index >= first && !((index - first) % step->step))
+            n = json_select_value(out, max, n, toks, i, sel, s);
+        i += toks[i].sub + 1;
+    }
+    return n;
+}
+
+/* the root container is not part of the token array so without a root
+ * type the first step decides between object and array */
+JSON_INTERN int
+json_select_root(const struct json_select *sel, enum json_token_type root)
+{
+    const struct json_select_step *step = &sel->steps[0];
+    if (root != JSON_NONE)
+        return root == JSON_OBJECT;
+    switch (step->kind) {
+    case JSON_SELECT_KEY: return 1;
+    case JSON_SELECT_ALL: return step->key != NULL;
+    case JSON_SELECT_MEMBER: return step->begin < 0;
+    default: return 0;
+    }
+}
+
+JSON_API json_size
+json_query_select(struct json_token **out, json_size max, struct json_token *toks,
+    json_size count, const struct json_select *sel, enum json_token_type root)
+{
+    JSON_ASSERT(toks);
+    JSON_ASSERT(sel);
+    if (!toks || count <= 0 || !sel || sel->count <= 0)
+        return 0;
+    return json_select_match(out, max, 0, toks, 0, count,
+        json_select_root(sel, root), -1, sel, 0);
+}
+
+/* FNV-1a hash of a key */
+JSON_INTERN unsigned
+json_hash_key(const char *str, json_size len)
+{
+    json_size i;
+    unsigned h = 2166136261u;
+    for (i = 0; i < len; ++i) {
+        h ^= (unsigned char)str[i];
+        h = (h * 16777619u) & 0xFFFFFFFFu;
+    }
+    return h;
+}
+
+JSON_API json_size
+json_hash_size(const struct json_token *toks, json_size count)
+{
+    json_size i, pairs = 0, size = 8;
+    JSON_ASSERT(toks);
+    if (!toks || count <= 0) return 0;
+    for (i = 0; i + 1 < count; i += toks[i+1].sub + 2)
+        pairs++;
+    /* keep the load factor at or below one half */
+    while (size < pairs * 2)
+        size *= 2;
+    return size;
+}
+
+JSON_API int
+json_hash_build(struct json_hash *hash, json_size *slots, json_size size,
+    struct json_token *toks, json_size count)
+{
+    json_size i, pairs = 0;
+    JSON_ASSERT(hash);
+    JSON_ASSERT(slots);
+    JSON_ASSERT(toks);
+    if (!hash || !slots || !toks || count <= 0)
+        return 0;
+    if (size <= 0 || (size & (size - 1)))
+        return 0;
+
+    hash->toks = toks;
+    hash->slots = slots;
+    hash->mask = size - 1;
+    for (i = 0; i < size; ++i)
+        slots[i] = 0;
+    for (i = 0; i + 1 < count; i += toks[i+1].sub + 2) {
+        unsigned h = json_hash_key(toks[i].str, toks[i].len);
+        json_size at = (json_size)(h & (unsigned)hash->mask);
+        if (++pairs * 2 > size)
+            return 0;
+        /* linear probing and the first of duplicated keys wins */
+        for (; slots[at]; at = (at + 1) & hash->mask) {
+            if (json_key_eq(&toks[slots[at]-1], toks[i].str, toks[i].len))
+                break;
+        }
+        if (!slots[at])
+            slots[at] = i + 1;
+    }
+    return 1;
+}
+
+JSON_API struct json_token*
+json_hash_get(const struct json_hash *hash, const char *key)
+{
+    json_size len, at;
+    JSON_ASSERT(hash);
+    JSON_ASSERT(key);
+    if (!hash || !hash->slots || !key)
+        return NULL;
+
+    for (len = 0; key[len]; ++len);
+    at = (json_size)(json_hash_key(key, len) & (unsigned)hash->mask);
+    for (; hash->slots[at]; at = (at + 1) & hash->mask) {
+        struct json_token *k = &hash->toks[hash->slots[at]-1];
+        if (json_key_eq(k, key, len))
+            return k + 1;
+    }
+    return NULL;
+}
+
+/* slot of a key hash in a schema */
+JSON_INTERN unsigned
+json_schema_slot(const struct json_schema *s, unsigned h)
+{
+    h = ((h ^ s->seed) * 2654435761u) & 0xFFFFFFFFu;
+    return (h >> 16) & s->mask;
+}
+
+JSON_API int
+json_schema_build(struct json_schema *s, const struct json_field *fields,
+    int count, unsigned char *slots, int size)
+{
+    int i, n;
+    JSON_ASSERT(s);
+    JSON_ASSERT(fields || !count);
+    JSON_ASSERT(slots);
+    if (!s || (!fields && count) || !slots || count < 0 || count > 255)
+        return 0;
+    if (size <= 0 || size > 0x10000 || (size & (size - 1)) || size < count)
+        return 0;
+
+    for (n = 0; n < count; ++n) {
+        /* catches tables with members not matching their field type */
+        static const json_size sizes[] = {sizeof(int), sizeof(json_int64),
+            sizeof(float), sizeof(double), sizeof(int)};
+        const struct json_field *f = &fields[n];
+        if (!f->name || !f->name[0] || f->offset < 0)
+            return 0;
+        if (f->type < JSON_FIELD_STRING && f->size != sizes[f->type])
+            return 0;
+        if (f->type == JSON_FIELD_OBJECT && !f->schema)
+            return 0;
+    }
+    s->fields = fields;
+    s->count = count;
+    s->slots = slots;
+    s->mask = (unsigned)size - 1;
+    /* search a seed which maps every name into its own slot */
+    for (s->seed = 0; s->seed < 4096; ++s->seed) {
+        for (i = 0; i < size; ++i)
+            slots[i] = 0;
+        for (n = 0; n < count; ++n) {
+            json_size len;
+            unsigned at;
+            for (len = 0; fields[n].name[len]; ++len);
+            at = json_schema_slot(s, json_hash_key(fields[n].name, len));
+            if (slots[at]) break;
+            slots[at] = (unsigned char)(n + 1);
+        }
+        if (n == count) return 1;
+    }
+    return 0;
+}
+
+/* writes a single value into the struct member of a field */
+JSON_INTERN int
+json_decode_field(char *dst, const struct json_field *f, const struct json_token *val)
+{
+    json_int64 i;
+    json_number n;
+    switch (f->type) {
+    case JSON_FIELD_INT:
+    case JSON_FIELD_INT64:
+        if (val->type != JSON_NUMBER || json_convert_int(&i, val) != JSON_NUMBER)
+            return 0;
+        if (f->type == JSON_FIELD_INT64)
+            *(json_int64*)dst = i;
+        else if (i >= JSON_INT_MIN && i <= JSON_INT_MAX)
+            *(int*)dst = (int)i;
+        else return 0;
+        return 1;
+    case JSON_FIELD_FLOAT:
+    case JSON_FIELD_DOUBLE:
+        if (val->type != JSON_NUMBER || json_convert(&n, val) != JSON_NUMBER)
+            return 0;
+        if (f->type == JSON_FIELD_FLOAT)
+            *(float*)dst = (float)n;
+        else *(double*)dst = n;
+        return 1;
+    case JSON_FIELD_BOOL:
+        if (val->type != JSON_TRUE && val->type != JSON_FALSE)
+            return 0;
+        *(int*)dst = (val->type == JSON_TRUE);
+        return 1;
+    case JSON_FIELD_STRING: {
+        int pass;
+        json_size k;
+        if (val->type != JSON_STRING || f->size < 1)
+            return 0;
+        /* escapes are decoded directly into the member once it is known to
+         * fit, so a rejected string leaves the member untouched */
+        pass = !(val->flags & JSON_FLAG_ESCAPED);
+        if (pass && val->len > f->size - 1)
+            return 0;
+        for (; pass < 2; ++pass) {
+            const char *cur = val->str;
+            const char *end = val->str + val->len;
+            for (k = 0; cur < end;) {
+                char c[4];
+                int j, n, size;
+                if (*cur != '\\' || !(val->flags & JSON_FLAG_ESCAPED)) {
+                    if (pass) dst[k] = *cur;
+                    k++, cur++;
+                } else {
+                    if (!(n = json_decode_escape(c, &size, cur + 1, end)))
+                        return 0;
+                    for (j = 0; j < size; ++j, ++k)
+                        if (pass) dst[k] = c[j];
+                    cur += n + 1;
+                }
+                if (k > f->size - 1) return 0;
+            }
+        }
+        dst[k] = 0;
+        return 1;
+    }
+    case JSON_FIELD_OBJECT:
+        if (val->type != JSON_OBJECT || !f->schema)
+            return 0;
+        return json_decode(dst, f->schema, val + 1, val->sub) >= 0;
+    default: return 0;
+    }
+}
+
+JSON_API int
+json_decode(void *out, const struct json_schema *s,
+    const struct json_token *toks, json_size count)
+{
+    json_size i;
+    int decoded = 0;
+    JSON_ASSERT(out);
+    JSON_ASSERT(s);
+    JSON_ASSERT(toks || !count);
+    if (!out || !s || !s->slots || (!toks && count))
+        return -1;
+
+    for (i = 0; i + 1 < count; i += toks[i+1].sub + 2) {
+        json_size k;
+        const struct json_field *f;
+        const struct json_token *key = &toks[i];
+        unsigned at = json_schema_slot(s, json_hash_key(key->str, key->len));
+        if (!s->slots[at]) continue;
+
+        /* a single compare rejects unknown keys hashed into a used slot */
+        f = &s->fields[s->slots[at]-1];
+        for (k = 0; k < key->len && f->name[k] == key->str[k]; ++k);
+        if (k != key->len || f->name[k])
+            continue;
+        decoded += json_decode_field((char*)out + f->offset, f, &toks[i+1]);
+    }
+    return decoded;
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                CURSOR
+
+  -------------------------------------------------------------------------*/
+/* returns the closing quote of the string starting after `begin` and adds
+ * JSON_FLAG_ESCAPED to `flags` (if not NULL) if it contains escapes */
+JSON_INTERN const char*
+json_skip_string(const char *begin, const char *end, unsigned *flags)
+{
+    const char *cur = json_scan_string(begin + 1, end);
+    for (; cur < end && *cur; cur = json_scan_string(cur + 1, end)) {
+        if (*cur == '\\') {
+            if (flags) *flags |= JSON_FLAG_ESCAPED;
+            cur++;
+        } else if (*cur == '"') return cur;
+    }
+    return NULL;
+}
+
+#ifdef JSON_VEC_WIDTH
+/* returns the end of the container starting at `begin` by counting brackets
+ * outside of strings over 64 byte blocks or NULL if it is not closed */
+JSON_INTERN const char*
+json_skip(const char *begin, const char *end)
+{
+    json_size pos;
+    int depth = 0, done = 0;
+    json_size length = (json_size)(end - begin);
+    json_uint64 prev_string = 0, prev_escaped = 0;
+    const unsigned char *src = (const unsigned char*)begin;
+
+    for (pos = 0; pos < length && !done; pos += 64) {
+        struct json_block b;
+        unsigned char tmp[64];
+        const unsigned char *blk = src + pos;
+        json_uint64 escaped, string, bits;
+
+        if (length - pos < 64) {
+            int i;
+            for (i = 0; i < 64; ++i)
+                tmp[i] = (pos + i < length) ? src[pos + i] : 0;
+            blk = tmp;
+        }
+        json_classify(&b, blk);
+        if (b.zero) {
+            /* end of string or input inside this block */
+            json_uint64 valid = (b.zero & (~b.zero + 1)) - 1;
+            b.quote &= valid; b.op &= valid;
+            done = 1;
+        }
+        escaped = json_escaped(b.bslash, &prev_escaped);
+        string = json_prefix_xor(b.quote & ~escaped) ^ prev_string;
+        prev_string = (json_uint64)0 - (string >> 63);
+        for (bits = b.op & ~string; bits; bits &= bits - 1) {
+            unsigned char c = blk[json_ctz(bits)];
+            if (c == '{' || c == '[') depth++;
+            else if ((c == '}' || c == ']') && --depth == 0)
+                return begin + pos + json_ctz(bits) + 1;
+        }
+    }
+    return NULL;
+}
+#else
+/* returns the end of the container starting at `begin` by counting brackets
+ * outside of strings or NULL if it is not closed. Without SIMD a plain byte
+ * loop is faster than classifying whole blocks. */
+JSON_INTERN const char*
+json_skip(const char *begin, const char *end)
+{
+    int depth = 0;
+    const char *cur;
+    for (cur = begin; cur < end && *cur; ++cur) {
+        if (*cur == '"') {
+            if (!(cur = json_skip_string(cur, end, NULL)))
+                return NULL;
+        } else if (*cur == '{' || *cur == '[') {
+            depth++;
+        } else if ((*cur == '}' || *cur == ']') && --depth == 0)
+            return cur + 1;
+    }
+    return NULL;
+}
+#endif
+
+/* stops the cursor with an error and returns false */
+JSON_INTERN int
+json_cursor_fail(struct json_cursor *c, enum json_status status)
+{
+    c->cur = NULL;
+    c->skip = NULL;
+    c->err = status;
+    return 0;
+}
+
+JSON_API struct json_cursor
+json_cursor_begin(const char *json, json_size length)
+{
+    struct json_cursor c;
+    const char *cur;
+
+    c.cur = c.end = c.skip = c.begin = NULL;
+    c.parent = NULL;
+    c.type = JSON_NONE;
+    c.count = 0;
+    c.err = JSON_INVAL;
+    JSON_ASSERT(json);
+    if (!json || length <= 0)
+        return c;
+
+    cur = json_skip_space(json, json + length);
+    c.err = JSON_PARSING_ERROR;
+    if (cur == json + length || (*cur != '{' && *cur != '['))
+        return c;
+    c.type = (*cur == '{') ? JSON_OBJECT: JSON_ARRAY;
+    c.begin = cur;
+    c.cur = cur + 1;
+    c.end = json + length;
+    c.err = JSON_OK;
+    return c;
+}
+
+JSON_API struct json_cursor
+json_cursor_enter(struct json_cursor *parent, const struct json_token *container)
+{
+    struct json_cursor c;
+    JSON_ASSERT(parent);
+    JSON_ASSERT(container);
+
+    c.cur = c.end = c.skip = c.begin = NULL;
+    c.parent = NULL;
+    c.type = JSON_NONE;
+    c.count = 0;
+    c.err = JSON_INVAL;
+    if (!parent || !container || !container->str)
+        return c;
+    if (container->type != JSON_OBJECT && container->type != JSON_ARRAY)
+        return c;
+
+    c.type = container->type;
+    c.begin = container->str;
+    c.cur = container->str + 1;
+    c.end = parent->end;
+    c.err = JSON_OK;
+    c.parent = parent;
+    return c;
+}
+
+JSON_API int
+json_cursor_next(struct json_cursor *c, struct json_token *key,
+    struct json_token *value)
+{
+    const char *cur, *end;
+    struct json_token tok = JSON_TOKEN_NULL;
+
+    JSON_ASSERT(c);
+    if (!c || !c->cur) return 0;
+    end = c->end;
+    if (c->skip) {
+        if (!(c->cur = json_skip(c->skip, end)))
+            return json_cursor_fail(c, JSON_PARSING_ERROR);
+        c->skip = NULL;
+    }
+
+    /* end of container or separator to the next value */
+    cur = json_skip_space(c->cur, end);
+    if (cur == end) return json_cursor_fail(c, JSON_PARSING_ERROR);
+    if (*cur == ((c->type == JSON_OBJECT) ? '}': ']')) {
+        /* parent continues after this container if it is still pending */
+        if (c->parent && c->parent->skip == c->begin) {
+            c->parent->cur = cur + 1;
+            c->parent->skip = NULL;
+        }
+        c->cur = NULL;
+        return 0;
+    }
+    if (c->count) {
+        if (*cur != ',')
+            return json_cursor_fail(c, JSON_PARSING_ERROR);
+        cur = json_skip_space(cur + 1, end);
+    }
+
+    /* object key followed by the name separator */
+    if (c->type == JSON_OBJECT) {
+        const char *close;
+        if (cur == end || *cur != '"' || !(close = json_skip_string(cur, end, &tok.flags)))
+            return json_cursor_fail(c, JSON_PARSING_ERROR);
+        tok.type = JSON_STRING;
+        tok.str = cur + 1;
+        tok.len = (json_size)(close - cur) - 1;
+        if (key) *key = tok;
+        cur = json_skip_space(close + 1, end);
+        if (cur == end || (*cur != ':' && *cur != '='))
+            return json_cursor_fail(c, JSON_PARSING_ERROR);
+        cur = json_skip_space(cur + 1, end);
+    } else if (key) *key = tok;
+    if (cur == end) return json_cursor_fail(c, JSON_PARSING_ERROR);
+
+    /* value */
+    tok.str = cur;
+    tok.type = json_type_char(*cur);
+    tok.flags = 0;
+    if (tok.type == JSON_OBJECT || tok.type == JSON_ARRAY) {
+        tok.len = 1;
+        c->skip = cur++;
+    } else if (tok.type == JSON_STRING) {
+        const char *close;
+        if (!(close = json_skip_string(cur, end, &tok.flags)))
+            return json_cursor_fail(c, JSON_PARSING_ERROR);
+        tok.str = cur + 1;
+        tok.len = (json_size)(close - cur) - 1;
+        cur = close + 1;
+    } else {
+        if (json_go_struct[(unsigned char)*cur] != JSON_STATE_BARE)
+            return json_cursor_fail(c, JSON_PARSING_ERROR);
+        for (; cur < end && *cur; ++cur) {
+            char state = json_go_bare[(unsigned char)*cur];
+            if (state == JSON_STATE_FAILED)
+                return json_cursor_fail(c, JSON_PARSING_ERROR);
+            if (state == JSON_STATE_UNBARE) break;
+        }
+        tok.len = (json_size)(cur - tok.str);
+        tok.flags = json_flags(tok.type, tok.str, tok.len);
+    }
+    if (value) *value = tok;
+    c->cur = cur;
+    c->count++;
+    return 1;
+}
+
+JSON_API int
+json_cursor_find(struct json_cursor *c, const char *key, struct json_token *value)
+{
+    json_size len;
+    struct json_token k;
+    JSON_ASSERT(c);
+    JSON_ASSERT(key);
+    if (!c || !key || c->type != JSON_OBJECT)
+        return 0;
+    for (len = 0; key[len]; ++len);
+    while (json_cursor_next(c, &k, value)) {
+        if (json_key_eq(&k, key, len))
+            return 1;
+    }
+    return 0;
+}
+
+JSON_API int
+json_cursor_skip(struct json_cursor *c, struct json_token *value)
+{
+    const char *close;
+    JSON_ASSERT(c);
+    JSON_ASSERT(value);
+    if (!c || !value || !c->skip || c->skip != value->str)
+        return 0;
+    if (!(close = json_skip(c->skip, c->end)))
+        return json_cursor_fail(c, JSON_PARSING_ERROR);
+    value->len = (json_size)(close - value->str);
+    c->cur = close;
+    c->skip = NULL;
+    return 1;
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                WRITER
+
+  -------------------------------------------------------------------------*/
+/* returns the cached power 10^k as normalized 64-bit significand */
+JSON_INTERN json_uint64
+json_cached_pow10(int k, int *e)
+{
+    const unsigned int *p = json_pow5[k - JSON_POW5_MIN];
+    json_uint64 f = ((json_uint64)p[0] << 32) | p[1];
+    *e = ((k < 0) ? -((-217706 * k + 65535) >> 16): ((217706 * k) >> 16)) - 63;
+    return f + (p[2] >> 31);
+}
+
+/* 64x64 bit multiplication rounded to the upper 64 bits */
+JSON_INTERN json_uint64
+json_mul64(json_uint64 a, json_uint64 b)
+{
+    json_uint64 hi, lo;
+    json_mul128(a, b, &hi, &lo);
+    return hi + (lo >> 63);
+}
+
+/* moves the last generated digit towards the exact value */
+JSON_INTERN void
+json_grisu_round(char *buf, int len, json_uint64 delta, json_uint64 rest,
+    json_uint64 ten_kappa, json_uint64 wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+        (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buf[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/* generates the shortest digits of a positive double which still convert
+ * back to the same value (Grisu2). Returns the number of digits and
+ * the decimal exponent of the last digit in `K`. */
+JSON_INTERN int
+json_grisu2(char *buf, double value, int *K)
+{
+    static const unsigned int pow10[] = {1,10,100,1000,10000,100000,
+        1000000,10000000,100000000,1000000000};
+    union {json_uint64 u; double d;} v;
+    json_uint64 f, w, wp, wm, c, one, delta, p2;
+    int e, pe, me, ce, k, lz, kappa, len = 0;
+    unsigned int p1;
+    double dk;
+
+    v.d = value;
+    f = v.u & (((json_uint64)1 << 52) - 1);
+    e = (int)((v.u >> 52) & 0x7FF);
+    if (e) {
+        f |= (json_uint64)1 << 52;
+        e -= 1075;
+    } else e = -1074;
+
+    /* normalized value and boundaries to the neighbouring doubles. The
+     * upper boundary has one more bit and ends up with the same exponent. */
+    w = f << json_clz(f);
+    wp = (f << 1) + 1; pe = e - 1;
+    lz = json_clz(wp);
+    wp <<= lz; pe -= lz;
+    if (f == (json_uint64)1 << 52) {
+        wm = (f << 2) - 1; me = e - 2;
+    } else {
+        wm = (f << 1) - 1; me = e - 1;
+    }
+    wm <<= me - pe;
+
+    /* scale by a cached power of ten into a binary exponent of [-60,-57] */
+    dk = (double)(-61 - pe) * 0.30102999566398114;
+    k = (int)dk;
+    if (dk - k > 0.0) k++;
+    c = json_cached_pow10(k, &ce);
+    w = json_mul64(w, c);
+    wp = json_mul64(wp, c) - 1;
+    wm = json_mul64(wm, c) + 1;
+    pe = pe + ce + 64;
+    *K = -k;
+
+    /* generate digits of the integral and then the fractional part */
+    one = (json_uint64)1 << -pe;
+    delta = wp - wm;
+    p1 = (unsigned int)(wp >> -pe);
+    p2 = wp & (one - 1);
+    for (kappa = 0; kappa < 10 && p1 >= pow10[kappa]; ++kappa);
+    while (kappa > 0) {
+        json_uint64 rest;
+        unsigned int d = p1 / pow10[kappa-1];
+        p1 %= pow10[kappa-1];
+        if (d || len) buf[len++] = (char)('0' + d);
+        kappa--;
+        rest = ((json_uint64)p1 << -pe) + p2;
+        if (rest <= delta) {
+            *K += kappa;
+            json_grisu_round(buf, len, delta, rest, (json_uint64)pow10[kappa] << -pe, wp - w);
+            return len;
+        }
+    }
+    for (;;) {
+        int d;
+        p2 *= 10;
+        delta *= 10;
+        d = (int)(p2 >> -pe);
+        if (d || len) buf[len++] = (char)('0' + d);
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta) {
+            int i;
+            json_uint64 scale = 1;
+            for (i = 0; i < -kappa; ++i)
+                scale = (i < 19) ? scale * 10: 0;
+            *K += kappa;
+            json_grisu_round(buf, len, delta, p2, one, (wp - w) * scale);
+            return len;
+        }
+    }
+}
+
+/* writes the shortest round trip representation of a double and returns its
+ * length (at most 25 characters). Not finite numbers are written as null. */
+JSON_INTERN int
+json_format_number(char *buf, double value)
+{
+    int i, len, K, kk, n = 0;
+    union {json_uint64 u; double d;} v;
+    v.d = value;
+    if (((v.u >> 52) & 0x7FF) == 0x7FF) {
+        buf[0] = 'n'; buf[1] = 'u'; buf[2] = 'l'; buf[3] = 'l';
+        return 4;
+    }
+    if (v.u >> 63) {
+        buf[n++] = '-';
+        v.u &= ~((json_uint64)1 << 63);
+    }
+    if (!v.u) {
+        buf[n++] = '0'; buf[n++] = '.'; buf[n++] = '0';
+        return n;
+    }
+
+    buf += n;
+    len = json_grisu2(buf, v.d, &K);
+    kk = len + K;
+    if (K >= 0 && kk <= 21) {
+        /* integer: 1234000.0 */
+        for (i = len; i < kk; ++i)
+            buf[i] = '0';
+        buf[kk] = '.';
+        buf[kk + 1] = '0';
+        return n + kk + 2;
+    } else if (kk > 0 && kk <= 21) {
+        /* 123.45 */
+        for (i = len; i > kk; --i)
+            buf[i] = buf[i - 1];
+        buf[kk] = '.';
+        return n + len + 1;
+    } else if (kk > -6 && kk <= 0) {
+        /* 0.00012345 */
+        int offset = 2 - kk;
+        for (i = len - 1; i >= 0; --i)
+            buf[i + offset] = buf[i];
+        buf[0] = '0';
+        buf[1] = '.';
+        for (i = 2; i < offset; ++i)
+            buf[i] = '0';
+        return n + len + offset;
+    } else {
+        /* 1.2345e-7 and 1e30 */
+        int exp = kk - 1;
+        if (len > 1) {
+            for (i = len; i > 1; --i)
+                buf[i] = buf[i - 1];
+            buf[1] = '.';
+            len++;
+        }
+        buf[len++] = 'e';
+        if (exp < 0) {
+            buf[len++] = '-';
+            exp = -exp;
+        }
+        if (exp >= 100) buf[len++] = (char)('0' + exp / 100);
+        if (exp >= 10) buf[len++] = (char)('0' + (exp / 10) % 10);
+        buf[len++] = (char)('0' + exp % 10);
+        return n + len;
+    }
+}
+
+/* writes a 64-bit integer and returns its length (at most 20 characters) */
+JSON_INTERN int
+json_format_int(char *buf, json_int64 num)
+{
+    int n = 0, len = 0;
+    char tmp[20];
+    json_uint64 u = (num < 0) ? (json_uint64)0 - (json_uint64)num: (json_uint64)num;
+    if (num < 0) buf[len++] = '-';
+    do {tmp[n++] = (char)('0' + (int)(u % 10)); u /= 10;} while (u);
+    while (n) buf[len++] = tmp[--n];
+    return len;
+}
+
+/* returns space for `size` bytes inside the buffer by flushing if needed */
+JSON_INTERN char*
+json_writer_reserve(struct json_writer *w, int size)
+{
+    if (w->err) return NULL;
+    if (w->capacity - w->used >= size)
+        return w->buffer + w->used;
+    if (!w->flush) {
+        w->err = JSON_OUT_OF_MEMORY;
+        return NULL;
+    }
+    if (w->used && w->flush(w->userdata, w->buffer, w->used)) {
+        w->err = JSON_FLUSH_FAILED;
+        return NULL;
+    }
+    w->used = 0;
+    if (w->capacity < size) {
+        w->err = JSON_OUT_OF_MEMORY;
+        return NULL;
+    }
+    return w->buffer;
+}
+
+/* appends bytes in buffer sized pieces */
+JSON_INTERN void
+json_writer_put(struct json_writer *w, const char *data, int size)
+{
+    while (size > 0) {
+        int i, n = (size < w->capacity) ? size: w->capacity;
+        char *dst = json_writer_reserve(w, n);
+        if (!dst) return;
+        for (i = 0; i < n; ++i)
+            dst[i] = data[i];
+        w->used += n;
+        data += n;
+        size -= n;
+    }
+}
+
+/* writes the separator in front of a value */
+JSON_INTERN void
+json_writer_sep(struct json_writer *w)
+{
+    if (w->comma)
+        json_writer_put(w, ",", 1);
+    w->comma = 1;
+}
+
+/* writes a quoted and escaped string */
+JSON_INTERN void
+json_writer_quote(struct json_writer *w, const char *str, int len)
+{
+    static const char hex[] = "0123456789abcdef";
+    int i, run = 0;
+    if (len < 0)
+        for (len = 0; str[len]; ++len);
+
+    json_writer_put(w, "\"", 1);
+    for (i = 0; i < len; ++i) {
+        char esc[6];
+        int n = 2;
+        unsigned char c = (unsigned char)str[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        json_writer_put(w, str + run, i - run);
+        run = i + 1;
+        esc[0] = '\\';
+        switch (c) {
+        case '"': esc[1] = '"'; break;
+        case '\\': esc[1] = '\\'; break;
+        case '\b': esc[1] = 'b'; break;
+        case '\f': esc[1] = 'f'; break;
+        case '\n': esc[1] = 'n'; break;
+        case '\r': esc[1] = 'r'; break;
+        case '\t': esc[1] = 't'; break;
+        default:
+            esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+            esc[4] = hex[c >> 4]; esc[5] = hex[c & 0xF];
+            n = 6; break;
+        }
+        json_writer_put(w, esc, n);
+    }
+    json_writer_put(w, str + run, len - run);
+    json_writer_put(w, "\"", 1);
+}
+
+JSON_API void
+json_writer_begin(struct json_writer *w, char *buffer, int capacity,
+    json_flush_f flush, void *userdata)
+{
+    JSON_ASSERT(w);
+    JSON_ASSERT(buffer);
+    JSON_ASSERT(capacity >= 64);
+    if (!w) return;
+    w->buffer = buffer;
+    w->capacity = capacity;
+    w->used = 0;
+    w->flush = flush;
+    w->userdata = userdata;
+    w->depth = 0;
+    w->comma = 0;
+    w->err = (!buffer || capacity < 64) ? JSON_INVAL: JSON_OK;
+}
+
+JSON_API enum json_status
+json_writer_end(struct json_writer *w)
+{
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (w->err) return w->err;
+    if (w->depth) return JSON_PARSING_ERROR;
+    if (w->flush && w->used) {
+        if (w->flush(w->userdata, w->buffer, w->used))
+            return (w->err = JSON_FLUSH_FAILED);
+        w->used = 0;
+    }
+    return JSON_OK;
+}
+
+JSON_API void
+json_write_object_begin(struct json_writer *w)
+{
+    JSON_ASSERT(w);
+    json_writer_sep(w);
+    json_writer_put(w, "{", 1);
+    w->comma = 0;
+    w->depth++;
+}
+
+JSON_API void
+json_write_object_end(struct json_writer *w)
+{
+    JSON_ASSERT(w);
+    json_writer_put(w, "}", 1);
+    w->comma = 1;
+    w->depth--;
+}
+
+JSON_API void
+json_write_array_begin(struct json_writer *w)
+{
+    JSON_ASSERT(w);
+    json_writer_sep(w);
+    json_writer_put(w, "[", 1);
+    w->comma = 0;
+    w->depth++;
+}
+
+JSON_API void
+json_write_array_end(struct json_writer *w)
+{
+    JSON_ASSERT(w);
+    json_writer_put(w, "]", 1);
+    w->comma = 1;
+    w->depth--;
+}
+
+JSON_API void
+json_write_key(struct json_writer *w, const char *key, int len)
+{
+    JSON_ASSERT(w);
+    JSON_ASSERT(key);
+    json_writer_sep(w);
+    json_writer_quote(w, key, len);
+    json_writer_put(w, ":", 1);
+    w->comma = 0;
+}
+
+JSON_API void
+json_write_string(struct json_writer *w, const char *str, int len)
+{
+    JSON_ASSERT(w);
+    JSON_ASSERT(str);
+    json_writer_sep(w);
+    json_writer_quote(w, str, len);
+}
+
+JSON_API void
+json_write_number(struct json_writer *w, json_number num)
+{
+    char tmp[32];
+    JSON_ASSERT(w);
+    json_writer_sep(w);
+    if (!w->err && w->capacity - w->used >= 32)
+        w->used += json_format_number(w->buffer + w->used, num);
+    else json_writer_put(w, tmp, json_format_number(tmp, num));
+}
+
+JSON_API void
+json_write_int(struct json_writer *w, json_int64 num)
+{
+    char tmp[32];
+    JSON_ASSERT(w);
+    json_writer_sep(w);
+    if (!w->err && w->capacity - w->used >= 32)
+        w->used += json_format_int(w->buffer + w->used, num);
+    else json_writer_put(w, tmp, json_format_int(tmp, num));
+}
+
+JSON_API void
+json_write_bool(struct json_writer *w, int value)
+{
+    JSON_ASSERT(w);
+    json_writer_sep(w);
+    if (value) json_writer_put(w, "true", 4);
+    else json_writer_put(w, "false", 5);
+}
+
+JSON_API void
+json_write_null(struct json_writer *w)
+{
+    JSON_ASSERT(w);
+    json_writer_sep(w);
+    json_writer_put(w, "null", 4);
+}
+
+JSON_API void
+json_write_raw(struct json_writer *w, const char *json, int len)
+{
+    JSON_ASSERT(w);
+    JSON_ASSERT(json);
+    if (len < 0)
+        for (len = 0; json[len]; ++len);
+    json_writer_sep(w);
+    json_writer_put(w, json, len);
+}
+
+/*--------------------------------------------------------------------------
+ *
+                                CACHE
+
+  -------------------------------------------------------------------------*/
+/* cache layout (all values little endian):
+ *  header:  "JSNC", version, record size, reserved (4 x 32-bit),
+ *           token count, source length (2 x 64-bit)
+ *  records: offset, length, sub, children, type | flags << 8 | decoded << 16
+ *           (5 x 32-bit per token, numbers hold the double in sub/children)
+ *  source:  the JSON text */
+#define JSON_CACHE_VERSION 1
+#define JSON_CACHE_HEADER 32
+#define JSON_CACHE_RECORD 20
+#define JSON_CACHE_DECODED 0x10000u
+
+JSON_INTERN void
+json_put32(unsigned char *p, unsigned long v)
+{
+    p[0] = (unsigned char)(v & 0xFF);
+    p[1] = (unsigned char)((v >> 8) & 0xFF);
+    p[2] = (unsigned char)((v >> 16) & 0xFF);
+    p[3] = (unsigned char)((v >> 24) & 0xFF);
+}
+
+JSON_INTERN unsigned long
+json_get32(const unsigned char *p)
+{
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8) |
+        ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+JSON_INTERN json_uint64
+json_get64(const unsigned char *p)
+{
+    return (json_uint64)json_get32(p) | ((json_uint64)json_get32(p + 4) << 32);
+}
+
+JSON_API enum json_status
+json_cache_write(const struct json_token *toks, json_size count,
+    const char *json, json_size length, json_flush_f flush, void *userdata)
+{
+    json_size i;
+    int used = 0;
+    unsigned char buf[JSON_CACHE_RECORD * 64];
+
+    JSON_ASSERT(toks || !count);
+    JSON_ASSERT(json);
+    JSON_ASSERT(flush);
+    if ((!toks && count) || !json || length <= 0 || count < 0 || !flush)
+        return JSON_INVAL;
+    if (!JSON_FITS_U32(length) || !JSON_FITS_U32(count))
+        return JSON_INVAL;
+
+    for (i = 0; i < JSON_CACHE_HEADER; ++i)
+        buf[i] = 0;
+    buf[0] = 'J'; buf[1] = 'S'; buf[2] = 'N'; buf[3] = 'C';
+    json_put32(buf + 4, JSON_CACHE_VERSION);
+    json_put32(buf + 8, JSON_CACHE_RECORD);
+    json_put32(buf + 16, (unsigned long)count);
+    json_put32(buf + 24, (unsigned long)length);
+    if (flush(userdata, (const char*)buf, JSON_CACHE_HEADER))
+        return JSON_FLUSH_FAILED;
+
+    for (i = 0; i < count; ++i) {
+        const struct json_token *t = &toks[i];
+        unsigned char *r = buf + used;
+        unsigned long info = (unsigned long)t->type | ((unsigned long)t->flags << 8);
+        json_size off = (json_size)(t->str - json);
+        if (!t->str || off < 0 || t->len < 0 || t->len > length - off)
+            return JSON_INVAL;
+        json_put32(r, (unsigned long)off);
+        json_put32(r + 4, (unsigned long)t->len);
+        if (t->type == JSON_NUMBER) {
+            json_number num = 0;
+            union {double d; json_uint64 u;} bits;
+            if (json_convert(&num, t) == JSON_NUMBER)
+                info |= JSON_CACHE_DECODED;
+            bits.d = num;
+            json_put32(r + 8, (unsigned long)(bits.u & 0xFFFFFFFFu));
+            json_put32(r + 12, (unsigned long)(bits.u >> 32));
+        } else {
+            json_put32(r + 8, (unsigned long)t->sub);
+            json_put32(r + 12, (unsigned long)t->children);
+        }
+        json_put32(r + 16, info);
+        used += JSON_CACHE_RECORD;
+        if (used == (int)sizeof(buf)) {
+            if (flush(userdata, (const char*)buf, used))
+                return JSON_FLUSH_FAILED;
+            used = 0;
+        }
+    }
+    if (used && flush(userdata, (const char*)buf, used))
+        return JSON_FLUSH_FAILED;
+
+    /* source text in chunks the callback can handle */
+    for (i = 0; i < length; i += 0x40000000) {
+        int n = (int)((length - i < 0x40000000) ? length - i: 0x40000000);
+        if (flush(userdata, json + i, n))
+            return JSON_FLUSH_FAILED;
+    }
+    return JSON_OK;
+}
+
+JSON_API enum json_status
+json_cache_open(struct json_cache *c, const void *data, json_size size)
+{
+    json_uint64 count, length;
+    const unsigned char *p = (const unsigned char*)data;
+
+    JSON_ASSERT(c);
+    JSON_ASSERT(data);
+    if (!c || !data || size < JSON_CACHE_HEADER)
+        return JSON_INVAL;
+    if (p[0] != 'J' || p[1] != 'S' || p[2] != 'N' || p[3] != 'C' ||
+        json_get32(p + 4) != JSON_CACHE_VERSION ||
+        json_get32(p + 8) != JSON_CACHE_RECORD)
+        return JSON_INVAL;
+
+    count = json_get64(p + 16);
+    length = json_get64(p + 24);
+    if (count > (json_uint64)(size - JSON_CACHE_HEADER) / JSON_CACHE_RECORD ||
+        length != (json_uint64)(size - JSON_CACHE_HEADER) - count * JSON_CACHE_RECORD)
+        return JSON_INVAL;
+
+    c->count = (json_size)count;
+    c->length = (json_size)length;
+    c->records = p + JSON_CACHE_HEADER;
+    c->json = (const char*)(c->records + c->count * JSON_CACHE_RECORD);
+    return JSON_OK;
+}
+
+JSON_API enum json_status
+json_cache_tokens(struct json_token *toks, json_size max, const struct json_cache *c)
+{
+    json_size i;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(c);
+    if (!toks || !c || !c->records)
+        return JSON_INVAL;
+    if (max < c->count)
+        return JSON_OUT_OF_TOKEN;
+
+    for (i = 0; i < c->count; ++i) {
+        const unsigned char *r = c->records + i * JSON_CACHE_RECORD;
+        struct json_token *t = &toks[i];
+        json_size off = (json_size)json_get32(r);
+        unsigned long info = json_get32(r + 16);
+        t->str = c->json + off;
+        t->len = (json_size)json_get32(r + 4);
+        t->type = (enum json_token_type)(info & 0xFF);
+        t->flags = (unsigned)((info >> 8) & 0xFF);
+        if (t->type == JSON_NUMBER) {
+            t->sub = t->children = 0;
+        } else {
+            t->sub = (json_size)json_get32(r + 8);
+            t->children = (json_size)json_get32(r + 12);
+        }
+        if (off > c->length || t->len > c->length - off ||
+            t->type <= JSON_NONE || t->type >= JSON_MAX || t->sub > c->count - i - 1)
+            return JSON_PARSING_ERROR;
+    }
+    return JSON_OK;
+}
+
+JSON_API int
+json_cache_number(json_number *num, const struct json_cache *c, json_size index)
+{
+    const unsigned char *r;
+    unsigned long info;
+    union {double d; json_uint64 u;} bits;
+
+    JSON_ASSERT(num);
+    JSON_ASSERT(c);
+    if (!num || !c || !c->records || index < 0 || index >= c->count)
+        return JSON_NONE;
+    r = c->records + index * JSON_CACHE_RECORD;
+    info = json_get32(r + 16);
+    if ((info & 0xFF) != JSON_NUMBER || !(info & JSON_CACHE_DECODED))
+        return JSON_NONE;
+    bits.u = json_get64(r + 8);
+    *num = bits.d;
+    return JSON_NUMBER;
+}
+
+#ifdef JSON_USE_MMAP
+JSON_API enum json_status
+json_cache_load(struct json_cache *c, struct json_file *file, const char *path)
+{
+    enum json_status status = json_file_open(file, path);
+    if (status != JSON_OK) return status;
+    status = json_cache_open(c, file->data, file->size);
+    if (status != JSON_OK)
+        json_file_close(file);
+    return status;
+}
+#endif
+
+
+/*--------------------------------------------------------------------------
+ *
+                                MSGPACK
+
+  -------------------------------------------------------------------------*/
+/* appends bytes of any size to the writer */
+JSON_INTERN void
+json_mp_put(struct json_writer *w, const char *data, json_size size)
+{
+    while (size > 0) {
+        int n = (size < 0x40000000) ? (int)size: 0x40000000;
+        json_writer_put(w, data, n);
+        data += n;
+        size -= n;
+    }
+}
+
+/* writes a format byte followed by a big endian value of `bytes` size */
+JSON_INTERN void
+json_mp_put_head(struct json_writer *w, unsigned c, json_uint64 v, int bytes)
+{
+    int i;
+    char buf[9];
+    buf[0] = (char)c;
+    for (i = bytes; i > 0; --i, v >>= 8)
+        buf[i] = (char)(v & 0xFF);
+    json_writer_put(w, buf, bytes + 1);
+}
+
+/* writes a string, array or map header using the smallest format */
+JSON_INTERN void
+json_mp_put_size(struct json_writer *w, enum json_token_type type, json_size n)
+{
+    unsigned fix = (type == JSON_STRING) ? 0xa0: (type == JSON_ARRAY) ? 0x90: 0x80;
+    unsigned big = (type == JSON_STRING) ? 0xda: (type == JSON_ARRAY) ? 0xdc: 0xde;
+    if (!JSON_FITS_U32(n))
+        w->err = JSON_INVAL;
+    else if (n < ((type == JSON_STRING) ? 32: 16))
+        json_mp_put_head(w, fix | (unsigned)n, 0, 0);
+    else if (type == JSON_STRING && n <= 0xFF)
+        json_mp_put_head(w, 0xd9, (json_uint64)n, 1);
+    else if (n <= 0xFFFF)
+        json_mp_put_head(w, big, (json_uint64)n, 2);
+    else json_mp_put_head(w, big + 1, (json_uint64)n, 4);
+}
+
+/* writes integers with the smallest format and everything else as double */
+JSON_INTERN void
+json_mp_put_number(struct json_writer *w, const struct json_token *tok)
+{
+    json_int64 i;
+    union {double d; json_uint64 u;} bits;
+    if ((tok->flags & JSON_FLAG_INTEGER) && json_convert_int(&i, tok) == JSON_NUMBER) {
+        json_uint64 u = (json_uint64)i;
+        if (i >= 0) {
+            if (u <= 0x7f) json_mp_put_head(w, (unsigned)u, 0, 0);
+            else if (u <= 0xFF) json_mp_put_head(w, 0xcc, u, 1);
+            else if (u <= 0xFFFF) json_mp_put_head(w, 0xcd, u, 2);
+            else if (u <= 0xFFFFFFFFu) json_mp_put_head(w, 0xce, u, 4);
+            else json_mp_put_head(w, 0xcf, u, 8);
+        } else {
+            if (i >= -32) json_mp_put_head(w, (unsigned)(u & 0xFF), 0, 0);
+            else if (i >= -128) json_mp_put_head(w, 0xd0, u, 1);
+            else if (i >= -32768) json_mp_put_head(w, 0xd1, u, 2);
+            else if (i >= -(json_int64)0x7FFFFFFF - 1) json_mp_put_head(w, 0xd2, u, 4);
+            else json_mp_put_head(w, 0xd3, u, 8);
+        }
+        return;
+    }
+    if (json_convert(&bits.d, tok) != JSON_NUMBER) {
+        w->err = JSON_PARSING_ERROR;
+        return;
+    }
+    json_mp_put_head(w, 0xcb, bits.u, 8);
+}
+
+/* writes a string with all escape sequences decoded */
+JSON_INTERN void
+json_mp_put_string(struct json_writer *w, const struct json_token *tok)
+{
+    char tmp[4];
+    int n, size;
+    json_size len = tok->len;
+    const char *cur, *run, *end = tok->str + tok->len;
+    if (!(tok->flags & JSON_FLAG_ESCAPED)) {
+        json_mp_put_size(w, JSON_STRING, len);
+        json_mp_put(w, tok->str, len);
+        return;
+    }
+    /* first pass for the decoded length in the header */
+    for (cur = json_scan_string(tok->str, end); cur < end; cur = json_scan_string(cur, end)) {
+        if (*cur++ != '\\') continue;
+        if (!(n = json_decode_escape(tmp, &size, cur, end))) {
+            w->err = JSON_PARSING_ERROR;
+            return;
+        }
+        cur += n;
+        len -= n + 1 - size;
+    }
+    json_mp_put_size(w, JSON_STRING, len);
+    run = tok->str;
+    for (cur = json_scan_string(run, end); cur < end; cur = json_scan_string(cur, end)) {
+        if (*cur != '\\') {cur++; continue;}
+        json_mp_put(w, run, (json_size)(cur - run));
+        n = json_decode_escape(tmp, &size, cur + 1, end);
+        json_writer_put(w, tmp, size);
+        run = cur += n + 1;
+    }
+    json_mp_put(w, run, (json_size)(end - run));
+}
+
+/* writes a token and, for objects and arrays, its members by reading the
+ * container text again. Each nesting level therefore rescans its parent. */
+JSON_INTERN void
+json_mp_put_value(struct json_writer *w, const struct json_token *tok, int depth)
+{
+    switch (tok->type) {
+    case JSON_OBJECT:
+    case JSON_ARRAY: {
+        json_size n = 0;
+        struct json_iter iter;
+        struct json_token child;
+        json_size count = (tok->type == JSON_OBJECT) ? tok->children * 2: tok->children;
+        if (depth >= JSON_MP_DEPTH) {
+            w->err = JSON_PARSING_ERROR;
+            return;
+        }
+        json_mp_put_size(w, tok->type, tok->children);
+        if (!count) return;
+        iter = json_begin(tok->str, tok->len);
+        iter = json_read(&child, &iter);
+        while (!iter.err && child.str && n < count && !w->err) {
+            json_mp_put_value(w, &child, depth + 1);
+            iter = json_read(&child, &iter);
+            n++;
+        }
+        if (n != count && !w->err)
+            w->err = JSON_PARSING_ERROR;
+    } break;
+    case JSON_STRING: json_mp_put_string(w, tok); break;
+    case JSON_NUMBER: json_mp_put_number(w, tok); break;
+    case JSON_TRUE: json_mp_put_head(w, 0xc3, 0, 0); break;
+    case JSON_FALSE: json_mp_put_head(w, 0xc2, 0, 0); break;
+    case JSON_NULL: json_mp_put_head(w, 0xc0, 0, 0); break;
+    default: w->err = JSON_PARSING_ERROR; break;
+    }
+}
+
+JSON_API enum json_status
+json_mp_transcode(const char *json, json_size length, json_flush_f flush,
+    void *userdata)
+{
+    char buffer[4096];
+    const char *cur;
+    struct json_writer w;
+    struct json_iter iter;
+    struct json_token root, tok;
+
+    JSON_ASSERT(json);
+    JSON_ASSERT(flush);
+    if (!json || length <= 0 || !flush)
+        return JSON_INVAL;
+    cur = json_skip_space(json, json + length);
+    if (cur >= json + length)
+        return JSON_PARSING_ERROR;
+
+    iter = json_begin(json, length);
+    if (*cur == '{' || *cur == '[') {
+        /* the tokenizer only returns the members of the root, so the root
+         * token is built from its first character and a counting pass */
+        json_size n = 0;
+        root = JSON_TOKEN_NULL;
+        root.type = (*cur == '{') ? JSON_OBJECT: JSON_ARRAY;
+        root.str = cur;
+        root.len = (json_size)(json + length - cur);
+        for (iter = json_read(&tok, &iter); !iter.err && tok.str; iter = json_read(&tok, &iter))
+            n++;
+        if (iter.err || (root.type == JSON_OBJECT && (n & 1)))
+            return JSON_PARSING_ERROR;
+        root.children = (root.type == JSON_OBJECT) ? n / 2: n;
+    } else {
+        json_read(&root, &iter);
+        if (!root.str) return JSON_PARSING_ERROR;
+    }
+    json_writer_begin(&w, buffer, sizeof(buffer), flush, userdata);
+    json_mp_put_value(&w, &root, 0);
+    return json_writer_end(&w);
+}
+
+/* returns the end of the item at `p` and counts all items nested inside */
+JSON_INTERN const unsigned char*
+json_mp_skip(const unsigned char *p, const unsigned char *end, json_size *sub)
+{
+    json_size left = 1, count = 0, head, n;
+    while (left) {
+        enum json_token_type type = json_mp_header(p, end, &head, &n);
+        if (type == JSON_NONE)
+            return NULL;
+        p += head;
+        left--;
+        count++;
+        if (type == JSON_STRING) {
+            if (n > end - p) return NULL;
+            p += n;
+        } else if (type == JSON_OBJECT || type == JSON_ARRAY) {
+            /* every pending item needs at least one byte */
+            if (n > end - p) return NULL;
+            left += (type == JSON_OBJECT) ? n * 2: n;
+            if (left > end - p) return NULL;
+        }
+    }
+    *sub = count - 1;
+    return p;
+}
+
+JSON_API struct json_mp_iter
+json_mp_begin(const void *data, json_size size)
+{
+    json_size head, n;
+    struct json_mp_iter iter;
+    enum json_token_type type;
+    const unsigned char *p = (const unsigned char*)data;
+
+    iter.src = p;
+    iter.len = size;
+    iter.left = 1;
+    iter.err = 0;
+    if (!p || size <= 0) {
+        iter.err = 1;
+        return iter;
+    }
+    type = json_mp_header(p, p + size, &head, &n);
+    if (type == JSON_NONE) {
+        iter.err = 1;
+    } else if (type == JSON_OBJECT || type == JSON_ARRAY) {
+        iter.src = p + head;
+        iter.len = size - head;
+        if (n > iter.len) iter.err = 1;
+        iter.left = (type == JSON_OBJECT) ? n * 2: n;
+    }
+    return iter;
+}
+
+JSON_API struct json_mp_iter
+json_mp_read(struct json_token *tok, const struct json_mp_iter *prev)
+{
+    json_size head, n;
+    struct json_mp_iter iter;
+    const unsigned char *end, *next;
+
+    JSON_ASSERT(tok);
+    JSON_ASSERT(prev);
+    if (!tok || !prev || !prev->src || prev->err) {
+        struct json_mp_iter it = {0, 0, 0, 1};
+        if (tok) *tok = JSON_TOKEN_NULL;
+        return it;
+    }
+    iter = *prev;
+    *tok = JSON_TOKEN_NULL;
+    if (!iter.left) return iter;
+
+    end = iter.src + iter.len;
+    tok->type = json_mp_header(iter.src, end, &head, &n);
+    tok->str = (const char*)iter.src;
+    tok->flags = JSON_FLAG_BINARY;
+    switch (tok->type) {
+    case JSON_NONE: goto fail;
+    case JSON_STRING:
+        if (n > iter.len - head) goto fail;
+        tok->str += head;
+        tok->len = n;
+        next = iter.src + head + n;
+        break;
+    case JSON_OBJECT:
+    case JSON_ARRAY:
+        if (!(next = json_mp_skip(iter.src, end, &tok->sub)))
+            goto fail;
+        tok->children = n;
+        tok->len = (json_size)(next - iter.src);
+        break;
+    case JSON_NUMBER: {
+        json_int64 i;
+        double d;
+        if (json_mp_number(&i, &d, iter.src, end) == JSON_FLAG_INTEGER)
+            tok->flags |= JSON_FLAG_INTEGER;
+        tok->len = head;
+        next = iter.src + head;
+    } break;
+    default:
+        tok->len = 1;
+        next = iter.src + 1;
+        break;
+    }
+    iter.len -= (json_size)(next - iter.src);
+    iter.src = next;
+    iter.left--;
+    return iter;
+
+fail:
+    *tok = JSON_TOKEN_NULL;
+    iter.err = 1;
+    return iter;
+}
+
+JSON_API struct json_mp_iter
+json_mp_parse(struct json_pair *p, const struct json_mp_iter *it)
+{
+    struct json_mp_iter next;
+    JSON_ASSERT(p);
+    JSON_ASSERT(it);
+    next = json_mp_read(&p->name, it);
+    if (next.err) return next;
+    return json_mp_read(&p->value, &next);
+}
+
+JSON_API enum json_status
+json_mp_load(struct json_token *toks, json_size max, json_size *read,
+    const void *data, json_size size)
+{
+    int depth = 0;
+    json_size left;
+    struct json_mp_iter iter;
+    const unsigned char *p, *end;
+    struct {json_size index, left;} stack[JSON_MP_DEPTH];
+
+    JSON_ASSERT(toks);
+    JSON_ASSERT(data);
+    JSON_ASSERT(max > 0);
+    JSON_ASSERT(read);
+    if (!toks || !data || size <= 0 || max <= 0 || !read)
+        return JSON_INVAL;
+    if (*read >= max)
+        return JSON_OUT_OF_TOKEN;
+
+    iter = json_mp_begin(data, size);
+    if (iter.err) return JSON_PARSING_ERROR;
+    p = iter.src;
+    end = p + iter.len;
+    left = iter.left;
+
+    /* iterative walk that patches `sub` and `len` of containers on close */
+    while (left || depth) {
+        json_size head, n;
+        struct json_token *tok;
+        if (*read >= max)
+            return JSON_OUT_OF_TOKEN;
+        if (depth) stack[depth-1].left--;
+        else left--;
+
+        tok = &toks[(*read)++];
+        *tok = JSON_TOKEN_NULL;
+        tok->type = json_mp_header(p, end, &head, &n);
+        tok->str = (const char*)p;
+        tok->len = head;
+        tok->flags = JSON_FLAG_BINARY;
+        switch (tok->type) {
+        case JSON_NONE: return JSON_PARSING_ERROR;
+        case JSON_STRING:
+            if (n > end - p - head)
+                return JSON_PARSING_ERROR;
+            tok->str += head;
+            tok->len = n;
+            p += head + n;
+            break;
+        case JSON_NUMBER: {
+            json_int64 i;
+            double d;
+            if (json_mp_number(&i, &d, p, end) == JSON_FLAG_INTEGER)
+                tok->flags |= JSON_FLAG_INTEGER;
+            p += head;
+        } break;
+        case JSON_OBJECT:
+        case JSON_ARRAY:
+            p += head;
+            tok->children = n;
+            if (n > ((tok->type == JSON_OBJECT) ? (end - p) / 2: end - p))
+                return JSON_PARSING_ERROR;
+            if (!n) break;
+            if (depth >= JSON_MP_DEPTH)
+                return JSON_PARSING_ERROR;
+            stack[depth].index = *read - 1;
+            stack[depth].left = (tok->type == JSON_OBJECT) ? n * 2: n;
+            depth++;
+            break;
+        default: p += 1; break;
+        }
+        while (depth && !stack[depth-1].left) {
+            tok = &toks[stack[depth-1].index];
+            tok->sub = *read - stack[depth-1].index - 1;
+            tok->len = (json_size)((const char*)p - tok->str);
+            depth--;
+        }
+    }
+    return (p == end) ? JSON_OK: JSON_PARSING_ERROR;
 }
 
 #endif
@@ -0,0 +1,1131 @@
+/*
+    Copyright (c) 2016
+    vurtun <polygone@gmx.net>
+    zlib license
+
+    Throughput benchmark for json.h. Build with optimizations and
+    optionally with SIMD support for the structural index:
+        cc -O2 json_bench.c -o json_bench
+        cc -O2 -DJSON_USE_SSE2 json_bench.c -o json_bench
+        cc -O2 -mavx2 -DJSON_USE_AVX2 json_bench.c -o json_bench
+    The batch and split benchmarks use sched.h and therefore needs to be linked
+    with pthread on posix systems (-lpthread).
+    Usage:
+        json_bench [megabytes] [results.csv]
+    Every measurement is additionally written as `section,name,value,unit`
+    into the optional csv file to track regressions between versions.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#define JSON_USE_MMAP
+#define JSON_IMPLEMENTATION
+#include "../mm_json.h"
+
+#define SCHED_IMPLEMENTATION
+#include "../mm_sched.h"
+
+static FILE *bench_csv;
+static const char *bench_current = "";
+
+#define bench_section(desc) \
+    do { \
+        bench_current = desc;\
+        printf("--------------- {%s} ---------------\n", desc);\
+    } while (0);
+
+static double
+bench_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+#endif
+}
+
+static void*
+bench_resize(void *userdata, void *old, json_size size)
+{
+    (void)userdata;
+    return realloc(old, (size_t)size);
+}
+
+/* prints a measurement and appends it to the csv output */
+static void
+bench_metric(const char *name, double value, const char *unit)
+{
+    printf("%-24s %10.2f %s\n", name, value, unit);
+    if (bench_csv)
+        fprintf(bench_csv, "%s,%s,%.4f,%s\n", bench_current, name, value, unit);
+}
+
+static void
+bench_report(const char *name, double secs, int bytes, int runs)
+{
+    double mb = ((double)bytes * (double)runs) / (1024.0 * 1024.0);
+    printf("%-24s %10.2f MB/s %8.3f GB/s\n", name, mb / secs, mb / secs / 1024.0);
+    if (bench_csv)
+        fprintf(bench_csv, "%s,%s,%.4f,MB/s\n", bench_current, name, mb / secs);
+}
+
+/* generates a log dump of JSON records either inside a top level array
+ * or as newline delimited records */
+static char*
+bench_log_corpus(int size, int *length, int lines)
+{
+    int i = 0;
+    int len = 0;
+    char *buf = (char*)malloc((size_t)size + 512);
+    if (!lines) buf[len++] = '[';
+    while (len < size) {
+        len += sprintf(buf + len,
+            "%s{\"id\":%d,\"ts\":%d.%03d,\"level\":\"%s\",\"user\":{\"name\":\"user_%d\","
+            "\"tags\":[\"a\",\"b\",\"c\"],\"active\":%s},\"msg\":\"request \\\"GET /index.html\\\""
+            " served in %d ms with status %d\",\"extra\":null}",
+            (!i ? "" : (lines ? "\n" : ",\n")), i, 1460000000 + i, i % 1000, (i % 3) ? "info" : "warn",
+            i % 997, (i & 1) ? "true" : "false", i % 250, (i % 7) ? 200 : 404);
+        i++;
+    }
+    if (!lines) buf[len++] = ']';
+    buf[len] = '\0';
+    *length = len;
+    return buf;
+}
+
+/* output sink that appends to a file */
+static int
+bench_flush_file(void *userdata, const char *data, int size)
+{
+    return fwrite(data, 1, (size_t)size, (FILE*)userdata) == (size_t)size ? 0: -1;
+}
+
+/* output sink that only counts the flushed bytes */
+static int
+bench_flush(void *userdata, const char *data, int size)
+{
+    (void)data;
+    *(long*)userdata += size;
+    return 0;
+}
+
+/* generates a geojson like array of coordinate pairs with 15 to 17
+ * significant digits similar to canada.json or pairs of integer ids */
+static char*
+bench_number_corpus(int size, int *length, int integers)
+{
+    int i = 0;
+    int len = 0;
+    char *buf = (char*)malloc((size_t)size + 512);
+    unsigned seed = 12345u;
+    buf[len++] = '[';
+    while (len < size) {
+        double x, y;
+        seed = seed * 1103515245u + 12345u;
+        x = -141.0 + (double)(seed >> 8) / 16777216.0 * 90.0;
+        seed = seed * 1103515245u + 12345u;
+        y = 41.0 + (double)(seed >> 8) / 16777216.0 * 42.0;
+        if (integers) {
+            len += sprintf(buf + len, "%s[%u,%u%06u]", (!i ? "" : ","),
+                seed >> 16, seed >> 8, (unsigned)i % 1000000u);
+        } else {
+            len += sprintf(buf + len, "%s[%.*g,%.*g]", (!i ? "" : ","),
+                15 + i % 3, x, 15 + (i + 1) % 3, y);
+        }
+        i++;
+    }
+    buf[len++] = ']';
+    buf[len] = '\0';
+    *length = len;
+    return buf;
+}
+
+/* generates records with long string values like embedded html, utf-8
+ * text and base64 blobs */
+static char*
+bench_string_corpus(int size, int *length)
+{
+    int i = 0;
+    int len = 0;
+    char *buf = (char*)malloc((size_t)size + 4096);
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    buf[len++] = '[';
+    while (len < size) {
+        int k;
+        len += sprintf(buf + len, "%s{\"id\":%d,\"html\":\"", (!i ? "" : ",\n"), i);
+        for (k = 0; k < 8; ++k)
+            len += sprintf(buf + len, "<div class=\\\"item\\\">Item %d of the list with some "
+                "longer description text</div>\\n", k);
+        len += sprintf(buf + len, "\",\"text\":\"");
+        for (k = 0; k < 16; ++k)
+            len += sprintf(buf + len, "Gr\xc3\xbc\xc3\x9f""e aus K\xc3\xb6ln \xe2\x82\xac ");
+        len += sprintf(buf + len, "\",\"blob\":\"");
+        for (k = 0; k < 1024; ++k)
+            buf[len++] = b64[((unsigned)k * 2654435761u + (unsigned)i) >> 26];
+        len += sprintf(buf + len, "\"}");
+        i++;
+    }
+    buf[len++] = ']';
+    buf[len] = '\0';
+    *length = len;
+    return buf;
+}
+
+/* generates a search result in the shape of twitter.json: statuses with a
+ * nested user, entity arrays, escaped html, CJK text and 64-bit ids */
+static char*
+bench_twitter_corpus(int size, int *length)
+{
+    int i = 0;
+    int len = 0;
+    char *buf = (char*)malloc((size_t)size + 4096);
+    len += sprintf(buf, "{\"statuses\":[");
+    while (len < size) {
+        len += sprintf(buf + len, "%s{\"created_at\":\"Sun Aug 31 00:%02d:%02d +0000 2014\","
+            "\"id\":5058749240958%05d,\"id_str\":\"5058749240958%05d\","
+            "\"text\":\"@user_%d \\u3010\xe5\x90\x8d\xe5\x89\x8d\\u3011 status %d #tag%d http:\\/\\/t.co\\/%x\","
+            "\"source\":\"<a href=\\\"http:\\/\\/twitter.com\\/download\\/iphone\\\" rel=\\\"nofollow\\\">"
+            "Twitter for iPhone<\\/a>\",\"truncated\":false,\"in_reply_to_status_id\":null,",
+            (!i ? "" : ","), i / 60 % 60, i % 60, i % 100000, i % 100000,
+            i * 7 % 1000, i, i % 50, (unsigned)i * 2654435761u);
+        len += sprintf(buf + len, "\"user\":{\"id\":%d,\"name\":\"\xe5\x89\x8d\xe7\x94\xb0 %d\","
+            "\"screen_name\":\"user_%d\",\"location\":\"\","
+            "\"description\":\"profile text of user %d with \\ud83d\\ude00 emoji\","
+            "\"followers_count\":%d,\"friends_count\":%d,\"verified\":%s,"
+            "\"profile_image_url\":\"http:\\/\\/pbs.twimg.com\\/profile_images\\/%d\\/img.jpeg\"},",
+            1186275104 + i, i, i * 7 % 1000, i, i * 31 % 5000, i * 17 % 800,
+            (i % 5) ? "false": "true", i);
+        len += sprintf(buf + len, "\"geo\":null,\"retweet_count\":%d,\"favorite_count\":%d,"
+            "\"entities\":{\"hashtags\":[{\"text\":\"tag%d\",\"indices\":[%d,%d]}],\"urls\":[],"
+            "\"user_mentions\":[{\"screen_name\":\"user_%d\",\"id\":%d,\"indices\":[0,%d]}]},"
+            "\"favorited\":false,\"retweeted\":false,\"lang\":\"%s\"}",
+            i % 13, i % 7, i % 50, 20 + i % 9, 24 + i % 9, i * 3 % 1000, 866260188 + i,
+            9 + i % 5, (i % 3) ? "ja": "en");
+        i++;
+    }
+    len += sprintf(buf + len, "],\"search_metadata\":{\"count\":%d}}", i);
+    *length = len;
+    return buf;
+}
+
+/* generates records nested 24 levels deep mixing objects and arrays */
+static char*
+bench_nested_corpus(int size, int *length)
+{
+    int i = 0;
+    int len = 0;
+    char *buf = (char*)malloc((size_t)size + 4096);
+    buf[len++] = '[';
+    while (len < size) {
+        int d;
+        if (i) buf[len++] = ',';
+        for (d = 0; d < 24; ++d)
+            len += sprintf(buf + len, "{\"id\":%d,\"v\":[%d,[%d.5]],\"n%d\":", i + d, d, i, d);
+        len += sprintf(buf + len, "{\"leaf\":\"value %d\"}", i);
+        for (d = 0; d < 24; ++d)
+            buf[len++] = '}';
+        i++;
+    }
+    buf[len++] = ']';
+    buf[len] = '\0';
+    *length = len;
+    return buf;
+}
+
+static char*
+bench_canada_corpus(int size, int *length)
+{
+    return bench_number_corpus(size, length, 0);
+}
+
+static char*
+bench_log_array(int size, int *length)
+{
+    return bench_log_corpus(size, length, 0);
+}
+
+/* corpora of the suite with the paths queried inside each record */
+struct bench_corpus {
+    const char *name;
+    char *(*generate)(int size, int *length);
+    const char *records;
+    /* path to the array of records or NULL for a root array */
+    const char *queries[4];
+    /* paths inside each record or NULL */
+};
+static const struct bench_corpus bench_corpora[] = {
+    {"twitter", bench_twitter_corpus, "statuses",
+        {"id", "user.screen_name", "entities.hashtags[0].text", "lang"}},
+    {"canada", bench_canada_corpus, NULL, {NULL, NULL, NULL, NULL}},
+    {"nested", bench_nested_corpus, NULL,
+        {"id", "n0.n1.n2.n3.id", "n0.n1.n2.n3.n4.n5.n6.n7.n8.n9.n10.n11.v[1]",
+        "n0.n1.n2.n3.n4.n5.n6.n7.n8.n9.n10.n11.n12.n13.n14.n15.n16.n17.n18.n19.n20.n21.n22.n23.leaf"}},
+    {"strings", bench_string_corpus, NULL, {"id", "text", "blob", NULL}},
+    {"log", bench_log_array, NULL, {"id", "user.name", "user.active", "extra"}}
+};
+
+/* records of the log corpus for the struct decoding benchmark */
+struct bench_user {char name[16]; int active;};
+struct bench_record {int id; double ts; char level[8]; struct bench_user user;};
+#define BENCH_USER_FIELDS(FIELD)\
+    FIELD(struct bench_user, name, JSON_FIELD_STRING, 0)\
+    FIELD(struct bench_user, active, JSON_FIELD_BOOL, 0)
+#define BENCH_RECORD_FIELDS(FIELD)\
+    FIELD(struct bench_record, id, JSON_FIELD_INT, 0)\
+    FIELD(struct bench_record, ts, JSON_FIELD_DOUBLE, 0)\
+    FIELD(struct bench_record, level, JSON_FIELD_STRING, 0)\
+    FIELD(struct bench_record, user, JSON_FIELD_OBJECT, &bench_user_schema)
+static struct json_schema bench_user_schema, bench_record_schema;
+static const struct json_field bench_user_fields[] = {BENCH_USER_FIELDS(JSON_FIELD_ENTRY)};
+static const struct json_field bench_record_fields[] = {BENCH_RECORD_FIELDS(JSON_FIELD_ENTRY)};
+
+int main(int argc, char **argv)
+{
+    int c, i, runs = 5;
+    int length = 0;
+    json_size read = 0, count = 0;
+    int size = ((argc > 1) ? atoi(argv[1]) : 32) * 1024 * 1024;
+    double begin;
+    int num;
+    char *json;
+    unsigned *index;
+    struct json_token *toks;
+
+    json = bench_log_corpus(size, &length, 0);
+    num = json_num(json, length);
+    toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+    index = (unsigned*)calloc((size_t)length, sizeof(unsigned));
+    printf("corpus: %d bytes, %d tokens\n", length, num);
+    if (argc > 2 && !(bench_csv = fopen(argv[2], "w")))
+        fprintf(stderr, "could not open %s\n", argv[2]);
+    if (bench_csv)
+        fprintf(bench_csv, "section,name,value,unit\n");
+
+    for (c = 0; c < (int)(sizeof(bench_corpora)/sizeof(bench_corpora[0])); ++c) {
+        int n, k, q, text_len = 0;
+        long queries = 0, numbers = 0, misses = 0;
+        double secs, sum = 0;
+        char *text;
+        json_size r, rec_count;
+        struct json_token *t, *records;
+        const struct bench_corpus *corpus = &bench_corpora[c];
+
+        bench_section(corpus->name);
+        text = corpus->generate(size, &text_len);
+        n = json_num(text, text_len);
+        t = (struct json_token*)calloc((size_t)n, sizeof(struct json_token));
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            n = json_num(text, text_len);
+        secs = bench_now() - begin;
+        bench_report("json_num", secs, text_len, runs);
+        bench_metric("json_num", (double)n * runs / secs / 1e6, "Mtokens/s");
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(t, n, &read, text, text_len);
+        }
+        secs = bench_now() - begin;
+        bench_report("json_load", secs, text_len, runs);
+        bench_metric("json_load", (double)read * runs / secs / 1e6, "Mtokens/s");
+
+        /* every query path inside every record */
+        records = t;
+        rec_count = read;
+        if (corpus->records && (records = json_query(t, read, corpus->records)) != NULL) {
+            rec_count = records->sub;
+            records++;
+        }
+        if (records && corpus->queries[0]) {
+            begin = bench_now();
+            for (i = 0; i < runs; ++i) {
+                for (r = 0; r < rec_count; r += records[r].sub + 1) {
+                    if (!records[r].sub) continue;
+                    for (q = 0; q < 4 && corpus->queries[q]; ++q) {
+                        struct json_token *hit = json_query(&records[r+1], records[r].sub, corpus->queries[q]);
+                        if (hit) sum += (double)hit->len;
+                        else misses++;
+                        queries++;
+                    }
+                }
+            }
+            secs = bench_now() - begin;
+            bench_metric("json_query", secs * 1e9 / (double)queries, "ns/query");
+        }
+
+        /* every number token */
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            for (k = 0; k < read; ++k) {
+                json_number v;
+                if (t[k].type != JSON_NUMBER) continue;
+                if (json_convert(&v, &t[k]) == JSON_NUMBER) sum += v;
+                numbers++;
+            }
+        }
+        secs = bench_now() - begin;
+        if (numbers) bench_metric("json_convert", secs * 1e9 / (double)numbers, "ns/number");
+        printf("%d bytes, %ld tokens, %ld query misses (checksum %g)\n",
+            text_len, (long)read, misses, sum);
+        free(t);
+        free(text);
+    }
+
+    bench_section("stage 1 + 2")
+    {
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            num = json_num(json, length);
+        bench_report("json_num", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(toks, num, &read, json, length);
+        }
+        bench_report("json_load", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            json_index(index, length, &count, json, length);
+        bench_report("json_index", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_index(index, length, &count, json, length);
+            json_load_indexed(toks, num, &read, json, length, index, count);
+        }
+        bench_report("json_index+load_indexed", bench_now() - begin, length, runs);
+    }
+
+    bench_section("on demand")
+    {
+        /* three small fields around one big blob */
+        int doc_len = 0;
+        char *doc = (char*)malloc((size_t)length + 64);
+        struct json_token val;
+        doc_len += sprintf(doc, "{\"id\":7,\"data\":");
+        memcpy(doc + doc_len, json, (size_t)length);
+        doc_len += length;
+        doc_len += sprintf(doc + doc_len, ",\"name\":\"test\",\"count\":3}");
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(toks, num, &read, doc, doc_len);
+            json_query(toks, read, "id");
+            json_query(toks, read, "name");
+            json_query(toks, read, "count");
+        }
+        bench_report("json_load+json_query", bench_now() - begin, doc_len, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            struct json_cursor root = json_cursor_begin(doc, doc_len);
+            json_cursor_find(&root, "id", &val);
+            json_cursor_find(&root, "name", &val);
+            json_cursor_find(&root, "count", &val);
+        }
+        bench_report("json_cursor_find", bench_now() - begin, doc_len, runs);
+        free(doc);
+    }
+
+    free(index);
+    free(toks);
+    free(json);
+
+    bench_section("strings")
+    {
+        json = bench_string_corpus(size, &length);
+        num = json_num(json, length);
+        toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            json_num(json, length);
+        bench_report("json_num", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(toks, num, &read, json, length);
+        }
+        bench_report("json_load", bench_now() - begin, length, runs);
+
+        {
+            /* decode every string: escaped html is copied, the rest are views */
+            json_size t;
+            long total = 0;
+            struct json_arena arena;
+            struct json_view view;
+            char *memory = (char*)malloc((size_t)length);
+            begin = bench_now();
+            for (i = 0; i < runs; ++i) {
+                json_arena_begin(&arena, memory, length);
+                for (t = 0; t < read; ++t) {
+                    if (toks[t].type != JSON_STRING) continue;
+                    json_unescape(&view, &arena, &toks[t]);
+                    total += (long)view.len;
+                }
+            }
+            bench_report("json_unescape", bench_now() - begin, length, runs);
+            printf("%-24s %10ld bytes copied of %ld\n", "arena", (long)arena.used, total / runs);
+            free(memory);
+        }
+        free(toks);
+        free(json);
+    }
+
+    bench_section("numbers")
+    {
+        int n, k, mismatch = 0;
+        double secs, sum = 0;
+        json_number *nums;
+
+        json = bench_number_corpus(size / 4, &length, 0);
+        num = json_num(json, length);
+        toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+        read = 0;
+        json_load(toks, num, &read, json, length);
+        for (n = 0, k = 0; k < read; ++k)
+            if (toks[k].type == JSON_NUMBER) toks[n++] = toks[k];
+        nums = (json_number*)calloc((size_t)n, sizeof(json_number));
+        printf("corpus: %d bytes, %d numbers\n", length, n);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            for (k = 0; k < n; ++k)
+                json_convert(&nums[k], &toks[k]);
+        secs = bench_now() - begin;
+        bench_metric("json_convert", secs * 1e9 / ((double)n * runs), "ns/number");
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            for (k = 0; k < n; ++k)
+                sum += strtod(toks[k].str, NULL);
+        secs = bench_now() - begin;
+        bench_metric("strtod", secs * 1e9 / ((double)n * runs), "ns/number");
+
+        for (k = 0; k < n; ++k) {
+            double ref = strtod(toks[k].str, NULL);
+            mismatch += (memcmp(&ref, &nums[k], sizeof(ref)) != 0);
+        }
+        printf("mismatches against strtod: %d (checksum %g)\n", mismatch, sum);
+
+        /* flatten into a single array of numbers like a vertex buffer */
+        for (k = 1; k < length - 1; ++k)
+            if (json[k] == '[' || json[k] == ']') json[k] = ' ';
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(toks, num, &read, json, length);
+            for (k = 0; k < read; ++k)
+                json_convert(&nums[k], &toks[k]);
+        }
+        bench_report("json_load+json_convert", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            struct json_token array;
+            array.type = JSON_ARRAY;
+            array.str = json;
+            array.len = length;
+            json_array_to_doubles(nums, n, &array);
+        }
+        bench_report("json_array_to_doubles", bench_now() - begin, length, runs);
+        free(nums);
+        free(toks);
+        free(json);
+    }
+
+    bench_section("integers")
+    {
+        int n, k;
+        double secs;
+        json_number *nums;
+        json_int64 *ints;
+
+        json = bench_number_corpus(size / 4, &length, 1);
+        num = json_num(json, length);
+        toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+        read = 0;
+        json_load(toks, num, &read, json, length);
+        for (n = 0, k = 0; k < read; ++k)
+            if (toks[k].flags & JSON_FLAG_INTEGER) toks[n++] = toks[k];
+        nums = (json_number*)calloc((size_t)n, sizeof(json_number));
+        ints = (json_int64*)calloc((size_t)n, sizeof(json_int64));
+        printf("corpus: %d bytes, %d integers\n", length, n);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            for (k = 0; k < n; ++k)
+                json_convert(&nums[k], &toks[k]);
+        secs = bench_now() - begin;
+        bench_metric("json_convert", secs * 1e9 / ((double)n * runs), "ns/number");
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            for (k = 0; k < n; ++k)
+                json_convert_int(&ints[k], &toks[k]);
+        secs = bench_now() - begin;
+        bench_metric("json_convert_int", secs * 1e9 / ((double)n * runs), "ns/number");
+        free(ints);
+        free(nums);
+        free(toks);
+        free(json);
+    }
+
+    bench_section("object lookup")
+    {
+        int k, keys = 20000, lookups = 200000;
+        json_size size, *slots;
+        double secs;
+        struct json_hash hash;
+        struct json_path path;
+        char names[1024][16];
+
+        json = (char*)malloc((size_t)keys * 40 + 16);
+        length = sprintf(json, "{");
+        for (k = 0; k < keys; ++k)
+            length += sprintf(json + length, "%s\"%d\":{\"n\":%d}", k ? ",": "", k * 7919, k);
+        length += sprintf(json + length, "}");
+        num = json_num(json, length);
+        toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+        read = 0;
+        json_load(toks, num, &read, json, length);
+        printf("object with %d members\n", keys);
+        for (k = 0; k < 1024; ++k)
+            sprintf(names[k], "%u", ((unsigned)k * 104729u % (unsigned)keys) * 7919u);
+
+        begin = bench_now();
+        for (k = 0; k < lookups / 100; ++k) {
+            json_path_compile(&path, names[k & 1023]);
+            json_query_compiled(toks, read, &path);
+        }
+        secs = bench_now() - begin;
+        bench_metric("json_query_compiled", secs * 1e9 / (lookups / 100), "ns/lookup");
+
+        begin = bench_now();
+        size = json_hash_size(toks, read);
+        slots = (json_size*)calloc((size_t)size, sizeof(json_size));
+        json_hash_build(&hash, slots, size, toks, read);
+        secs = bench_now() - begin;
+        bench_metric("json_hash_build", secs * 1e6, "us");
+
+        begin = bench_now();
+        for (k = 0; k < lookups; ++k)
+            json_hash_get(&hash, names[k & 1023]);
+        secs = bench_now() - begin;
+        bench_metric("json_hash_get", secs * 1e9 / lookups, "ns/lookup");
+        free(slots);
+        free(toks);
+        free(json);
+    }
+
+    bench_section("column select")
+    {
+        json_size r, n = 0, records = 0;
+        double secs;
+        struct json_select sel;
+        struct json_token **column;
+
+        json = bench_log_array(size, &length);
+        num = json_num(json, length);
+        toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+        read = 0;
+        json_load(toks, num, &read, json, length);
+        for (r = 0; r < read; r += toks[r].sub + 1)
+            records++;
+        column = (struct json_token**)calloc((size_t)records, sizeof(struct json_token*));
+
+        /* one query per record as the root array can not be indexed */
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            for (n = 0, r = 0; r < read; r += toks[r].sub + 1)
+                column[n++] = json_query(&toks[r+1], toks[r].sub, "user.name");
+        }
+        secs = bench_now() - begin;
+        bench_metric("json_query per record", secs * 1e9 / (double)(runs * records), "ns/record");
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            json_select_compile(&sel, "[*].user.name");
+            n = json_query_select(column, records, toks, read, &sel, JSON_NONE);
+        }
+        secs = bench_now() - begin;
+        bench_metric("json_query_select", secs * 1e9 / (double)(runs * records), "ns/record");
+        if (n != records)
+            printf("select mismatch: %ld of %ld\n", (long)n, (long)records);
+        free(column);
+        free(toks);
+        free(json);
+    }
+
+    bench_section("writer")
+    {
+        int r, records = 200000;
+        long total = 0;
+        double secs;
+        char out[16 * 1024];
+        struct json_writer w;
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            int used = 0;
+            for (r = 0; r < records; ++r) {
+                if ((int)sizeof(out) - used < 512) {
+                    bench_flush(&total, out, used);
+                    used = 0;
+                }
+                used += sprintf(out + used, "%s{\"id\":%d,\"ts\":%.17g,\"level\":\"%s\","
+                    "\"user\":{\"name\":\"user_%d\",\"active\":%s},\"pos\":[%.17g,%.17g],"
+                    "\"msg\":\"%s\"}", r ? ",": "[", r, 1460000000.0 + r / 1000.0,
+                    (r % 3) ? "info": "warn", r % 997, (r & 1) ? "true": "false",
+                    r * 0.25, r / 3.0, "request served");
+            }
+            out[used++] = ']';
+            bench_flush(&total, out, used);
+        }
+        secs = bench_now() - begin;
+        bench_metric("sprintf", secs * 1e9 / ((double)records * runs), "ns/record");
+        bench_metric("sprintf", (double)total / (1024.0 * 1024.0) / secs, "MB/s");
+
+        total = 0;
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            json_writer_begin(&w, out, sizeof(out), bench_flush, &total);
+            json_write_array_begin(&w);
+            for (r = 0; r < records; ++r) {
+                char name[32];
+                json_write_object_begin(&w);
+                json_write_key(&w, "id", 2);
+                json_write_int(&w, r);
+                json_write_key(&w, "ts", 2);
+                json_write_number(&w, 1460000000.0 + r / 1000.0);
+                json_write_key(&w, "level", 5);
+                json_write_string(&w, (r % 3) ? "info": "warn", 4);
+                json_write_key(&w, "user", 4);
+                json_write_object_begin(&w);
+                json_write_key(&w, "name", 4);
+                json_write_string(&w, name, sprintf(name, "user_%d", r % 997));
+                json_write_key(&w, "active", 6);
+                json_write_bool(&w, r & 1);
+                json_write_object_end(&w);
+                json_write_key(&w, "pos", 3);
+                json_write_array_begin(&w);
+                json_write_number(&w, r * 0.25);
+                json_write_number(&w, r / 3.0);
+                json_write_array_end(&w);
+                json_write_key(&w, "msg", 3);
+                json_write_string(&w, "request served", 14);
+                json_write_object_end(&w);
+            }
+            json_write_array_end(&w);
+            json_writer_end(&w);
+        }
+        secs = bench_now() - begin;
+        bench_metric("json_writer", secs * 1e9 / ((double)records * runs), "ns/record");
+        bench_metric("json_writer", (double)total / (1024.0 * 1024.0) / secs, "MB/s");
+    }
+
+    bench_section("file load")
+    {
+        FILE *fp;
+        int got;
+        json_size max = 0;
+        char *data;
+        struct json_file file;
+        struct json_allocator alloc;
+        const char path[] = "json_bench_file.json";
+
+        json = bench_log_corpus(size, &length, 0);
+        fp = fopen(path, "wb");
+        if (fp) {
+            fwrite(json, 1, (size_t)length, fp);
+            fclose(fp);
+        }
+        free(json);
+        alloc.userdata = NULL;
+        alloc.resize = bench_resize;
+        toks = NULL;
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            fp = fopen(path, "rb");
+            if (!fp) break;
+            data = (char*)malloc((size_t)length);
+            got = (int)fread(data, 1, (size_t)length, fp);
+            fclose(fp);
+            read = 0;
+            json_load_alloc(&toks, &max, &read, data, got, &alloc);
+            free(data);
+        }
+        bench_report("fread+json_load_alloc", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            if (json_load_file(&file, &toks, &max, &read, path, &alloc) != JSON_OK)
+                break;
+            json_file_close(&file);
+        }
+        bench_report("json_load_file", bench_now() - begin, length, runs);
+        free(toks);
+        remove(path);
+    }
+
+    bench_section("cache reload")
+    {
+        FILE *fp;
+        json_size max = 0;
+        struct json_file file;
+        struct json_cache cache;
+        struct json_allocator alloc;
+        const char path[] = "json_bench_file.json";
+        const char cache_path[] = "json_bench_file.cache";
+
+        json = bench_log_corpus(size, &length, 0);
+        fp = fopen(path, "wb");
+        if (fp) {
+            fwrite(json, 1, (size_t)length, fp);
+            fclose(fp);
+        }
+        alloc.userdata = NULL;
+        alloc.resize = bench_resize;
+        toks = NULL;
+        read = 0;
+        json_load_alloc(&toks, &max, &read, json, length, &alloc);
+        fp = fopen(cache_path, "wb");
+        if (fp) {
+            json_cache_write(toks, read, json, length, bench_flush_file, fp);
+            fclose(fp);
+        }
+        free(json);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            if (json_load_file(&file, &toks, &max, &read, path, &alloc) != JSON_OK)
+                break;
+            json_file_close(&file);
+        }
+        bench_report("json_load_file", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            if (json_cache_load(&cache, &file, cache_path) != JSON_OK)
+                break;
+            json_cache_tokens(toks, max, &cache);
+            json_file_close(&file);
+        }
+        bench_report("json_cache_load", bench_now() - begin, length, runs);
+        free(toks);
+        remove(path);
+        remove(cache_path);
+    }
+
+    bench_section("struct decode")
+    {
+        double secs;
+        long records = 0, check = 0;
+        json_size r, max = 0, got;
+        json_number id = 0;
+        unsigned char user_slots[8], record_slots[16];
+        struct bench_record rec;
+        struct json_allocator alloc;
+
+        json_schema_build(&bench_user_schema, bench_user_fields, 2, user_slots, 8);
+        json_schema_build(&bench_record_schema, bench_record_fields, 4, record_slots, 16);
+        json = bench_log_corpus(size, &length, 0);
+        alloc.userdata = NULL;
+        alloc.resize = bench_resize;
+        toks = NULL;
+        read = 0;
+        json_load_alloc(&toks, &max, &read, json, length, &alloc);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            for (r = 0; r < read; r += toks[r].sub + 1) {
+                struct json_token *t = &toks[r+1];
+                json_size n = toks[r].sub;
+                json_query_number(&id, t, n, "id");
+                json_query_number(&rec.ts, t, n, "ts");
+                json_query_string(rec.level, sizeof(rec.level), &got, t, n, "level");
+                json_query_string(rec.user.name, sizeof(rec.user.name), &got, t, n, "user.name");
+                rec.user.active = json_query_type(t, n, "user.active") == JSON_TRUE;
+                check += (long)id + rec.user.active;
+                records++;
+            }
+        }
+        secs = bench_now() - begin;
+        bench_metric("json_query per field", secs * 1e9 / (double)records, "ns/record");
+        bench_metric("json_query per field", (double)length * runs / (1024.0 * 1024.0) / secs, "MB/s");
+
+        records = 0;
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            for (r = 0; r < read; r += toks[r].sub + 1) {
+                json_decode(&rec, &bench_record_schema, &toks[r+1], toks[r].sub);
+                check -= rec.id + rec.user.active;
+                records++;
+            }
+        }
+        secs = bench_now() - begin;
+        bench_metric("json_decode", secs * 1e9 / (double)records, "ns/record");
+        bench_metric("json_decode", (double)length * runs / (1024.0 * 1024.0) / secs, "MB/s");
+        if (check) printf("struct decode mismatch\n");
+        free(toks);
+        free(json);
+    }
+
+    bench_section("msgpack")
+    {
+        FILE *fp;
+        long total = 0;
+        char *mp;
+        json_size max = 0, mp_size;
+        struct json_allocator alloc;
+        const char path[] = "json_bench_file.mp";
+
+        json = bench_log_corpus(size, &length, 0);
+        begin = bench_now();
+        for (i = 0; i < runs; ++i)
+            json_mp_transcode(json, length, bench_flush, &total);
+        bench_report("json_mp_transcode", bench_now() - begin, length, runs);
+
+        mp = NULL;
+        mp_size = 0;
+        fp = fopen(path, "wb+");
+        if (fp) {
+            json_mp_transcode(json, length, bench_flush_file, fp);
+            mp_size = (json_size)ftell(fp);
+            mp = (char*)malloc((size_t)mp_size);
+            rewind(fp);
+            if (fread(mp, 1, (size_t)mp_size, fp) != (size_t)mp_size)
+                mp_size = 0;
+            fclose(fp);
+        }
+        remove(path);
+        bench_metric("msgpack size", 100.0 * (double)mp_size / length, "% of the JSON size");
+
+        alloc.userdata = NULL;
+        alloc.resize = bench_resize;
+        toks = NULL;
+        read = 0;
+        json_load_alloc(&toks, &max, &read, json, length, &alloc);
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(toks, max, &read, json, length);
+        }
+        bench_report("json_load", bench_now() - begin, length, runs);
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_mp_load(toks, max, &read, mp, mp_size);
+        }
+        bench_report("json_mp_load", bench_now() - begin, length, runs);
+        free(toks);
+        free(mp);
+        free(json);
+    }
+
+    bench_section("ndjson batch")
+    {
+        int n, t, cores;
+        void *memory;
+        sched_size needed;
+        struct scheduler sched;
+        struct json_batch batch;
+        struct json_record *records;
+        struct json_batch_slot *slots;
+        struct json_allocator alloc;
+
+        json = bench_log_corpus(size, &length, 1);
+        n = json_batch_split(NULL, 0, json, length);
+        records = (struct json_record*)calloc((size_t)n, sizeof(struct json_record));
+        json_batch_split(records, n, json, length);
+        alloc.userdata = NULL;
+        alloc.resize = bench_resize;
+        toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            int r;
+            for (r = 0; r < n; ++r) {
+                read = 0;
+                json_load(toks, num, &read, records[r].str, records[r].len);
+            }
+        }
+        bench_report("json_load per line", bench_now() - begin, length, runs);
+        free(toks);
+
+        scheduler_init(&sched, &needed, SCHED_DEFAULT, NULL);
+        cores = (int)sched.threads_num;
+        for (t = 1; t <= cores; t = (t < cores && t * 2 > cores) ? cores: t * 2) {
+            char name[64];
+            scheduler_init(&sched, &needed, t, NULL);
+            memory = calloc(needed, 1);
+            scheduler_start(&sched, memory);
+            slots = (struct json_batch_slot*)calloc(sched.threads_num, sizeof(struct json_batch_slot));
+
+            begin = bench_now();
+            for (i = 0; i < runs; ++i) {
+                struct sched_task task;
+                json_batch_begin(&batch, records, n, slots, (int)sched.threads_num, &alloc);
+                scheduler_add(&task, &sched, json_batch_run, &batch, (sched_uint)n);
+                scheduler_join(&sched, &task);
+            }
+            sprintf(name, "json_batch %u threads", sched.threads_num);
+            bench_report(name, bench_now() - begin, length, runs);
+
+            scheduler_stop(&sched);
+            for (i = 0; i < (int)sched.threads_num; ++i)
+                free(slots[i].toks);
+            free(slots);
+            free(memory);
+            if (t == cores) break;
+        }
+        free(records);
+        free(json);
+    }
+
+    bench_section("incremental update")
+    {
+        char *at;
+        int edits = runs * 1000;
+        struct json_edit edit;
+        struct json_allocator alloc;
+        json_size max;
+
+        json = bench_twitter_corpus(size, &length);
+        num = json_num(json, length);
+        max = num + 64;
+        toks = (struct json_token*)calloc((size_t)max, sizeof(struct json_token));
+        alloc.userdata = NULL;
+        alloc.resize = bench_resize;
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(toks, max, &read, json, length);
+        }
+        bench_metric("json_load", (bench_now() - begin) * 1e6 / runs, "us/edit");
+
+        /* patches a counter in the middle of the document in place */
+        at = strstr(json + length / 2, "\"retweet_count\":") + 16;
+        edit.old = json;
+        edit.offset = (json_size)(at - json);
+        edit.removed = edit.inserted = 1;
+        begin = bench_now();
+        for (i = 0; i < edits; ++i) {
+            *at = (char)('0' + i % 10);
+            json_update(&toks, &max, &read, json, length, &edit, &alloc);
+        }
+        bench_metric("json_update", (bench_now() - begin) * 1e6 / edits, "us/edit");
+
+        /* inserting and removing a digit shifts all following tokens */
+        begin = bench_now();
+        for (i = 0; i < edits; ++i) {
+            edit.removed = i & 1;
+            edit.inserted = !edit.removed;
+            if (edit.inserted) {
+                memmove(at + 1, at, (size_t)(json + length - at));
+                length++;
+            } else {
+                memmove(at, at + 1, (size_t)(json + length - at - 1));
+                length--;
+            }
+            json_update(&toks, &max, &read, json, length, &edit, &alloc);
+        }
+        bench_metric("memmove+json_update", (bench_now() - begin) * 1e6 / edits, "us/edit");
+        read = 0;
+        if (json_load(toks, max, &read, json, length) != JSON_OK || read != num)
+            printf("update mismatch\n");
+        free(toks);
+        free(json);
+    }
+
+    bench_section("array split")
+    {
+        int t, c, n, cores;
+        void *memory;
+        sched_size needed;
+        struct scheduler sched;
+        struct json_split split;
+        struct json_split_chunk *chunks;
+        struct json_allocator alloc;
+        json_size max = 0;
+
+        json = bench_log_array(size, &length);
+        num = json_num(json, length);
+        toks = (struct json_token*)calloc((size_t)num, sizeof(struct json_token));
+        alloc.userdata = NULL;
+        alloc.resize = bench_resize;
+
+        begin = bench_now();
+        for (i = 0; i < runs; ++i) {
+            read = 0;
+            json_load(toks, num, &read, json, length);
+        }
+        bench_report("json_load", bench_now() - begin, length, runs);
+        free(toks);
+        toks = NULL;
+
+        scheduler_init(&sched, &needed, SCHED_DEFAULT, NULL);
+        cores = (int)sched.threads_num;
+        for (t = 1; t <= cores; t = (t < cores && t * 2 > cores) ? cores: t * 2) {
+            char name[64];
+            scheduler_init(&sched, &needed, t, NULL);
+            memory = calloc(needed, 1);
+            scheduler_start(&sched, memory);
+            /* more chunks than threads to balance uneven chunks */
+            n = (int)sched.threads_num * 8;
+            chunks = (struct json_split_chunk*)calloc((size_t)n, sizeof(struct json_split_chunk));
+
+            begin = bench_now();
+            for (i = 0; i < runs; ++i) {
+                struct sched_task task;
+                json_split_begin(&split, chunks, n, json, length, &alloc);
+                scheduler_add(&task, &sched, json_split_scan, &split, (sched_uint)n);
+                scheduler_join(&sched, &task);
+                json_split_reconcile(&split);
+                scheduler_add(&task, &sched, json_split_run, &split, (sched_uint)n);
+                scheduler_join(&sched, &task);
+                read = 0;
+                json_split_join(&toks, &max, &read, &split);
+            }
+            sprintf(name, "json_split %u threads", sched.threads_num);
+            bench_report(name, bench_now() - begin, length, runs);
+            if (read != num)
+                printf("token mismatch: %ld of %ld\n", (long)read, (long)num);
+
+            scheduler_stop(&sched);
+            for (c = 0; c < n; ++c)
+                free(chunks[c].toks);
+            free(chunks);
+            free(memory);
+            if (t == cores) break;
+        }
+        free(toks);
+        free(json);
+    }
+    if (bench_csv)
+        fclose(bench_csv);
+    return 0;
+}
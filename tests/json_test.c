@@ -8,6 +8,7 @@
 #include <string.h>
 
 #define JSON_STATIC
+#define JSON_USE_MMAP
 #define JSON_IMPLEMENTATION
 #include "../mm_json.h"
 
@@ -42,6 +43,88 @@
         printf("======================================================\n"); \
     } while (0)
 
+static void*
+test_resize(void *userdata, void *old, json_size size)
+{
+    (void)userdata;
+    return realloc(old, (size_t)size);
+}
+
+/* resize which fails once the call counter in userdata reaches zero */
+static void*
+test_resize_limit(void *userdata, void *old, json_size size)
+{
+    int *calls = (int*)userdata;
+    if (!--*calls) return NULL;
+    return realloc(old, (size_t)size);
+}
+
+struct test_events {
+    char log[1024];
+    int len;
+};
+
+static void
+test_event(void *userdata, enum json_event event,
+    const struct json_token *tok, unsigned depth)
+{
+    struct test_events *e = (struct test_events*)userdata;
+    const char *tag[] = {"B", "E", "K", "V"};
+    e->len += sprintf(e->log + e->len, "%s%u:%d:%.*s:%d ", tag[event],
+        depth, (int)tok->type, (int)tok->len, tok->str, (int)tok->children);
+}
+
+struct test_output {
+    char data[1024];
+    int len;
+    int flushes;
+};
+
+static int
+test_flush(void *userdata, const char *data, int size)
+{
+    struct test_output *o = (struct test_output*)userdata;
+    if (o->len + size >= (int)sizeof(o->data))
+        return -1;
+    memcpy(o->data + o->len, data, (size_t)size);
+    o->len += size;
+    o->data[o->len] = 0;
+    o->flushes++;
+    return 0;
+}
+
+/* replaces `removed` bytes at `offset` of a zero terminated buffer */
+static struct json_edit
+test_edit(char *buf, int offset, int removed, const char *insert)
+{
+    struct json_edit e;
+    int n = (int)strlen(insert);
+    memmove(buf + offset + n, buf + offset + removed, strlen(buf + offset + removed) + 1);
+    memcpy(buf + offset, insert, (size_t)n);
+    e.old = buf;
+    e.offset = offset;
+    e.removed = removed;
+    e.inserted = n;
+    return e;
+}
+
+/* returns the number of tokens differing from a fresh parse */
+static int
+test_reload(const struct json_token *toks, json_size read, const char *json)
+{
+    int diff = 0;
+    json_size i, n = 0;
+    struct json_token fresh[64];
+    if (json_load(fresh, 64, &n, json, (json_size)strlen(json)) != JSON_OK || n != read)
+        return -1;
+    for (i = 0; i < n; ++i) {
+        diff += toks[i].str != fresh[i].str || toks[i].len != fresh[i].len;
+        diff += toks[i].type != fresh[i].type || toks[i].flags != fresh[i].flags;
+        diff += toks[i].sub != fresh[i].sub || toks[i].children != fresh[i].children;
+    }
+    return diff;
+}
+
 static int run_test(void)
 {
     int pass_count = 0;
@@ -187,6 +270,79 @@ static int run_test(void)
         test_assert(num >= 0.0002567 && num <= 0.0002568);
     }
 
+    test_section("precise")
+    {
+        int i, exact = 1;
+        json_number num = 0;
+        struct json_token tok;
+        static const char *nums[] = {
+            "0.1", "-65.613616999999977", "1e23", "8.98846567431158e307",
+            "9007199254740993", "2.2250738585072011e-308", "2.2250738585072014e-308",
+            "4.9406564584124654e-324", "2.4703282292062328e-324", "1.7976931348623157e308",
+            "123456789012345678901234567890", "0.30000000000000001665334536937734810635447502136230468750",
+            "9007199254740992.9999999999999999999", "1e-400", "-0.0", "0e12", "100000000000000000000000e-23"};
+        for (i = 0; i < (int)(sizeof(nums)/sizeof(nums[0])); ++i) {
+            double ref = strtod(nums[i], NULL);
+            tok.str = nums[i];
+            tok.len = (int)strlen(nums[i]);
+            tok.type = JSON_NUMBER;
+            if (json_convert(&num, &tok) != JSON_NUMBER || memcmp(&num, &ref, sizeof(ref)))
+                exact = 0;
+        }
+        test_assert(exact);
+
+        tok.str = "1e400";
+        tok.len = 5;
+        test_assert(json_convert(&num, &tok) == JSON_NUMBER);
+        test_assert(num > 1.7976931348623157e308);
+        tok.str = "1e";
+        tok.len = 2;
+        test_assert(json_convert(&num, &tok) == JSON_NONE);
+        tok.str = "-";
+        tok.len = 1;
+        test_assert(json_convert(&num, &tok) == JSON_NONE);
+        tok.str = "1.2.3";
+        tok.len = 5;
+        test_assert(json_convert(&num, &tok) == JSON_NONE);
+    }
+
+    test_section("integer")
+    {
+        json_size read = 0;
+        json_int64 n = 0, max;
+        struct json_token toks[16];
+        struct json_token tok;
+        const char buf[] = "[1, -2, 3.0, 4e2, 18014398509481985, \"5\"]";
+
+        test_assert(json_load(toks, 16, &read, buf, sizeof(buf)) == JSON_OK);
+        test_assert(read == 6);
+        test_assert(toks[0].flags == JSON_FLAG_INTEGER);
+        test_assert(toks[1].flags == JSON_FLAG_INTEGER);
+        test_assert(!toks[2].flags);
+        test_assert(!toks[3].flags);
+        test_assert(!toks[5].flags);
+        test_assert(json_convert_int(&n, &toks[1]) == JSON_NUMBER && n == -2);
+        test_assert(json_convert_int(&n, &toks[4]) == JSON_NUMBER);
+        test_assert(n == ((json_int64)1 << 54) + 1);
+        test_assert(json_convert_int(&n, &toks[2]) == JSON_NONE);
+
+        max = (json_int64)922337203 * 1000000000 + 685477580;
+        max = max * 10 + 7;
+        tok = toks[0];
+        tok.str = "9223372036854775807";
+        tok.len = 19;
+        test_assert(json_convert_int(&n, &tok) == JSON_NUMBER && n == max);
+        tok.str = "-9223372036854775808";
+        tok.len = 20;
+        test_assert(json_convert_int(&n, &tok) == JSON_NUMBER && n == -max - 1);
+        tok.str = "9223372036854775808";
+        tok.len = 19;
+        test_assert(json_convert_int(&n, &tok) == JSON_NONE);
+        tok.str = "99999999999999999999";
+        tok.len = 20;
+        test_assert(json_convert_int(&n, &tok) == JSON_NONE);
+    }
+
     test_section("utf8")
     {
         struct json_iter iter;
@@ -201,6 +357,52 @@ static int run_test(void)
         test_assert(pair.value.type == JSON_STRING);
     }
 
+    test_section("utf8_blocks")
+    {
+        /* sequences straddling the 16 and 32 byte blocks of the string scan */
+        static const char *valid[] = {"\xc3\xa4", "\xe2\x82\xac", "\xf0\xa4\xaa\xa4"};
+        static const char *invalid[] = {"\x7f", "\x80", "\xff", "\xc3", "\xc3\x41",
+            "\xe2\x82", "\xf0\xa4\xaa"};
+        const char *pad = "0123456789abcdef0123456789abcdef0123456789";
+        int i, n, len, ok = 1;
+        char buf[128];
+        char buffer[128];
+        json_size read;
+        struct json_token toks[4];
+        struct json_iter iter;
+        struct json_pair pair;
+        struct json_stream stream;
+        struct test_events events;
+        enum json_status status;
+
+        for (i = 0; i < 10; ++i) {
+            const char *seq = (i < 3) ? valid[i]: invalid[i-3];
+            for (n = 0; n < 40; ++n) {
+                int err = (i >= 3);
+                len = sprintf(buf, "{\"k\":\"%.*s%s%s\"}", n, pad, seq, pad);
+                read = 0;
+                status = json_load(toks, 4, &read, buf, len);
+                ok = ok && (status == (err ? JSON_PARSING_ERROR: JSON_OK));
+                ok = ok && (err || toks[1].len == n + (int)strlen(seq) + 42);
+
+                iter = json_begin(buf, len);
+                iter = json_parse(&pair, &iter);
+                ok = ok && (!iter.err == !err);
+
+                /* also split in the middle of the sequence */
+                events.len = 0;
+                json_stream_begin(&stream, buffer, sizeof(buffer), test_event, &events);
+                status = json_stream_feed(&stream, buf, n + 7);
+                if (status == JSON_OK)
+                    status = json_stream_feed(&stream, buf + n + 7, len - n - 7);
+                if (status == JSON_OK)
+                    status = json_stream_end(&stream);
+                ok = ok && (status == (err ? JSON_PARSING_ERROR: JSON_OK));
+            }
+        }
+        test_assert(ok);
+    }
+
     test_section("map")
     {
         struct json_iter iter;
@@ -584,8 +786,8 @@ static int run_test(void)
 
     test_section("load")
     {
-        int count = 0;
-        int read = 0;
+        json_size count = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[14];
         const char buf[] =
@@ -613,10 +815,168 @@ static int run_test(void)
         test_assert(read == 14);
     }
 
+    test_section("load_alloc")
+    {
+        json_size max = 0;
+        json_size read = 0;
+        enum json_status status;
+        struct json_token *toks = NULL;
+        struct json_allocator alloc;
+        const char buf[] =
+            "{\"sub\":{\"a\": \"b\"}, \"list\":[1,2,3,4], \"a\":true, \"b\": \"0a1b2\"}";
+
+        alloc.userdata = NULL;
+        alloc.resize = test_resize;
+        status = json_load_alloc(&toks, &max, &read, buf, sizeof(buf), &alloc);
+        test_assert(status == JSON_OK);
+        test_assert(read == 14);
+        test_assert(max >= read);
+        test_token(&toks[0], "sub", JSON_STRING, 0, 0);
+        test_token(&toks[1], "{\"a\": \"b\"}", JSON_OBJECT, 1, 2);
+        test_token(&toks[3], "b", JSON_STRING, 0, 0);
+        test_token(&toks[5], "[1,2,3,4]", JSON_ARRAY, 4, 4);
+        test_token(&toks[9], "4", JSON_NUMBER, 0, 0);
+        test_token(&toks[13], "0a1b2", JSON_STRING, 0, 0);
+        free(toks);
+    }
+
+    test_section("load_file")
+    {
+        FILE *fp;
+        json_size max = 0;
+        json_size read = 0;
+        enum json_status status;
+        struct json_file file;
+        struct json_token *toks = NULL;
+        struct json_allocator alloc;
+        const char path[] = "json_test_load_file.json";
+        const char buf[] = "{\"sub\":{\"a\": \"b\"}, \"list\":[1,2,3,4]}";
+
+        fp = fopen(path, "wb");
+        test_assert(fp != NULL);
+        if (fp) {
+            fwrite(buf, 1, sizeof(buf)-1, fp);
+            fclose(fp);
+        }
+        alloc.userdata = NULL;
+        alloc.resize = test_resize;
+        status = json_load_file(&file, &toks, &max, &read, path, &alloc);
+        test_assert(status == JSON_OK);
+        test_assert(file.size == (int)sizeof(buf)-1);
+        test_assert(read == 10);
+        test_token(&toks[1], "{\"a\": \"b\"}", JSON_OBJECT, 1, 2);
+        test_token(&toks[9], "4", JSON_NUMBER, 0, 0);
+        test_assert(toks[9].str >= file.data && toks[9].str < file.data + file.size);
+        json_file_close(&file);
+        test_assert(file.data == NULL);
+        free(toks);
+        remove(path);
+
+        test_assert(json_file_open(&file, path) == JSON_FILE_ERROR);
+        test_assert(json_load_file(&file, &toks, &max, &read, path, &alloc) == JSON_FILE_ERROR);
+    }
+
+#ifdef JSON_TEST_LARGE
+    /* writes a document with a string above 4GB to check that lengths and
+     * offsets do not overflow (needs 64-bit json_size and ~4.5GB of disk) */
+    test_section("load_large")
+    if (sizeof(json_size) > 4) {
+        FILE *fp;
+        json_size i, max = 0;
+        json_size read = 0;
+        json_int64 value = 0;
+        char *chunk;
+        const json_size pad = ((json_size)1 << 32) + 4096;
+        const json_size chunk_size = 1 << 20;
+        struct json_file file;
+        struct json_token *toks = NULL, *tok;
+        struct json_cursor root;
+        struct json_token val;
+        struct json_allocator alloc;
+        unsigned index[4];
+        const char path[] = "json_test_load_large.json";
+
+        chunk = (char*)malloc((size_t)chunk_size);
+        memset(chunk, 'x', (size_t)chunk_size);
+        fp = fopen(path, "wb");
+        test_assert(fp != NULL);
+        if (fp) {
+            fputs("{\"pad\":\"", fp);
+            for (i = 0; i < pad; i += chunk_size)
+                fwrite(chunk, 1, (size_t)((pad - i < chunk_size) ? pad - i: chunk_size), fp);
+            fputs("\",\"list\":[1,2,3],\"last\":{\"value\":42}}", fp);
+            fclose(fp);
+        }
+        free(chunk);
+
+        test_assert(json_file_open(&file, path) == JSON_OK);
+        test_assert(file.size > pad);
+        test_assert(json_num(file.data, file.size) == 11);
+
+        alloc.userdata = NULL;
+        alloc.resize = test_resize;
+        test_assert(json_load_alloc(&toks, &max, &read, file.data, file.size, &alloc) == JSON_OK);
+        test_assert(read == 11);
+        test_assert(toks[1].type == JSON_STRING && toks[1].len == pad);
+        test_assert(toks[2].str - file.data > pad);
+        tok = json_query(toks, read, "list[2]");
+        test_assert(tok && !json_cmp(tok, "3"));
+        test_assert(json_query_int(&value, toks, read, "last.value") == JSON_NUMBER);
+        test_assert(value == 42);
+        free(toks);
+
+        root = json_cursor_begin(file.data, file.size);
+        test_assert(json_cursor_find(&root, "last", &val));
+        test_assert(val.str - file.data > pad);
+
+        /* the 32-bit tape and index offsets can not address this document */
+        read = 0;
+        test_assert(json_index(index, 4, &read, file.data, file.size) == JSON_INVAL);
+        json_file_close(&file);
+        remove(path);
+    }
+#endif
+
+    test_section("load_grow")
+    {
+        int i;
+        json_size max = 0;
+        json_size read = 0;
+        enum json_status status;
+        struct json_token *toks = NULL;
+        struct json_allocator alloc;
+        char buf[4096];
+        char *p = buf;
+
+        *p++ = '[';
+        for (i = 0; i < 500; ++i)
+            p += sprintf(p, "%s[%d]", i ? "," : "", i);
+        *p++ = ']';
+        *p = '\0';
+
+        alloc.userdata = NULL;
+        alloc.resize = test_resize;
+        status = json_load_alloc(&toks, &max, &read, buf, (int)(p - buf), &alloc);
+        test_assert(status == JSON_OK);
+        test_assert(read == 1000);
+        test_assert(read == json_num(buf, (int)(p - buf)));
+        test_token(&toks[998], "[499]", JSON_ARRAY, 1, 1);
+        test_token(&toks[999], "499", JSON_NUMBER, 0, 0);
+        free(toks);
+    }
+
+    test_section("load_out_of_token")
+    {
+        json_size read = 0;
+        struct json_token toks[4];
+        const char buf[] = "{\"list\":[1,2,3,4]}";
+        test_assert(json_load(toks, 4, &read, buf, sizeof(buf)) == JSON_OUT_OF_TOKEN);
+    }
+
     test_section("load_array_root")
     {
-        int count = 0;
-        int read = 0;
+        json_size count = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[14];
         const char buf[] = "[ 1.0, 2.0, 3.0, 4.0 ]";
@@ -634,8 +994,8 @@ static int run_test(void)
 
     test_section("load_array")
     {
-        int count = 0;
-        int read = 0;
+        json_size count = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[14];
         const char buf[] = "[\"Extra close\"]]";
@@ -649,8 +1009,8 @@ static int run_test(void)
 
     test_section("empty")
     {
-        int count = 0;
-        int read = 0;
+        json_size count = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[14];
         const char buf[] =
@@ -680,8 +1040,8 @@ static int run_test(void)
 
     test_section("query_simple")
     {
-        int count = 0;
-        int read = 0;
+        json_size count = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[14];
         const char buf[] =
@@ -701,7 +1061,7 @@ static int run_test(void)
 
     test_section("query_complex")
     {
-        int read = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[128];
         const char buf[] =
@@ -735,7 +1095,7 @@ static int run_test(void)
 
     test_section("query_entangled")
     {
-        int read = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[128];
         const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
@@ -769,7 +1129,7 @@ static int run_test(void)
 
     test_section("query_sub")
     {
-        int read = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[128];
         struct json_token *entity;
@@ -812,10 +1172,1079 @@ static int run_test(void)
         }
     }
 
-    test_section("query_number")
+    test_section("stream")
+    {
+        int i, step;
+        char buffer[64];
+        struct json_stream stream;
+        struct test_events full, chunked;
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test \\\" str\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"utf8\":\"\xc3\xa4\xc3\xb6\xc3\xbc\", \"a\": [{\"b\":-5.25e+2}, [], \"test\", 10]}";
+        int len = (int)strlen(buf);
+
+        full.len = 0;
+        json_stream_begin(&stream, buffer, sizeof(buffer), test_event, &full);
+        test_assert(json_stream_feed(&stream, buf, len) == JSON_OK);
+        test_assert(json_stream_end(&stream) == JSON_OK);
+        test_assert(!strncmp(full.log, "B0:1:{:0 K1:4:b:0 B1:1:{:0 K2:4:a:0 B2:1:{:0 "
+            "K3:4:b:0 V3:3:5:0 E2:1:}:1 K2:4:b:0 B2:2:[:0 V3:3:1:0", 60));
+        test_assert(strstr(full.log, "E1:1:}:7 ") != NULL);
+        test_assert(strstr(full.log, "V2:4:test \\\" str:0 ") != NULL);
+        test_assert(strstr(full.log, "E0:1:}:3 ") != NULL);
+
+        for (step = 1; step < 9; ++step) {
+            enum json_status status = JSON_OK;
+            chunked.len = 0;
+            json_stream_begin(&stream, buffer, sizeof(buffer), test_event, &chunked);
+            for (i = 0; i < len && status == JSON_OK; i += step)
+                status = json_stream_feed(&stream, buf + i, (len - i < step) ? len - i: step);
+            test_assert(status == JSON_OK);
+            test_assert(json_stream_end(&stream) == JSON_OK);
+            test_assert(chunked.len == full.len && !strcmp(chunked.log, full.log));
+        }
+
+        full.len = 0;
+        json_stream_begin(&stream, buffer, sizeof(buffer), test_event, &full);
+        test_assert(json_stream_feed(&stream, "12", 2) == JSON_OK);
+        test_assert(json_stream_feed(&stream, "34.5", 4) == JSON_OK);
+        test_assert(json_stream_end(&stream) == JSON_OK);
+        test_assert(!strcmp(full.log, "V0:3:1234.5:0 "));
+
+        json_stream_begin(&stream, buffer, 4, test_event, &full);
+        test_assert(json_stream_feed(&stream, "[\"too", 5) == JSON_OK);
+        test_assert(json_stream_feed(&stream, " long\"]", 7) == JSON_OUT_OF_MEMORY);
+        json_stream_begin(&stream, buffer, sizeof(buffer), test_event, &full);
+        test_assert(json_stream_feed(&stream, "[[1,2]", 6) == JSON_OK);
+        test_assert(json_stream_end(&stream) == JSON_PARSING_ERROR);
+    }
+
+    test_section("batch")
+    {
+        int n, i;
+        struct json_batch batch;
+        struct json_record records[8];
+        struct json_batch_slot slots[2];
+        struct json_allocator alloc;
+        struct json_token *toks;
+        const char buf[] =
+            "{\"id\":1, \"tags\":[\"a\",\"b\"]}\n"
+            "{\"id\":2, \"tags\":[]}\r\n"
+            "\n"
+            "{\"id\":3, \"tags\":[\"c\"\n"
+            "{\"id\":4, \"sub\":{\"x\":1}}";
+
+        alloc.userdata = NULL;
+        alloc.resize = test_resize;
+        memset(slots, 0, sizeof(slots));
+        n = json_batch_split(NULL, 0, buf, sizeof(buf));
+        test_assert(n == 4);
+        test_assert(json_batch_split(records, 8, buf, sizeof(buf)) == 4);
+        test_assert(records[1].len == 20);
+
+        json_batch_begin(&batch, records, n, slots, 2, &alloc);
+        json_batch_run(&batch, NULL, 0, 2, 1);
+        json_batch_run(&batch, NULL, 2, 4, 0);
+        test_assert(records[0].status == JSON_OK);
+        test_assert(records[0].slot == 1);
+        test_assert(records[0].count == 6);
+        test_assert(records[1].offset == 6);
+        test_assert(records[1].count == 4);
+        test_assert(records[2].status == JSON_PARSING_ERROR);
+        test_assert(records[2].count == 0);
+        test_assert(json_batch_tokens(&batch, 2) == NULL);
+        test_assert(records[3].slot == 0);
+        test_assert(records[3].offset == 0);
+
+        toks = json_batch_tokens(&batch, 0);
+        test_assert(json_query(toks, records[0].count, "tags[1]") == &toks[5]);
+        toks = json_batch_tokens(&batch, 3);
+        test_token(&toks[3], "{\"x\":1}", JSON_OBJECT, 1, 2);
+        test_assert(json_query(toks, records[3].count, "sub.x") == &toks[5]);
+        for (i = 0; i < 2; ++i)
+            free(slots[i].toks);
+    }
+
+    test_section("split")
+    {
+        int i, n, chunks;
+        json_size j, read, max = 0;
+        struct json_split split;
+        struct json_split_chunk chunk[16];
+        struct json_token toks[128];
+        struct json_token *joined = NULL;
+        struct json_allocator alloc;
+        const char buf[] =
+            " [{\"id\":1,\"tags\":[\"a,b\",\"]\"]},\n"
+            "  {\"id\":2,\"text\":\"x\\\"],[{\\\\\",\"sub\":{\"x\":[1,[2,3]]}},\n"
+            "  \"\\\\\", 3.5, true, null, [], {},\n"
+            "  {\"id\":4,\"text\":\"\xc3\xa4,\\u00e4\"}] \n";
+
+        alloc.userdata = NULL;
+        alloc.resize = test_resize;
+        read = 0;
+        test_assert(json_load(toks, 128, &read, buf, sizeof(buf) - 1) == JSON_OK);
+        memset(chunk, 0, sizeof(chunk));
+        for (chunks = 1; chunks <= 16; ++chunks) {
+            test_assert(json_split_begin(&split, chunk, chunks, buf, sizeof(buf) - 1, &alloc) == JSON_OK);
+            json_split_scan(&split, NULL, 0, (unsigned)chunks, 0);
+            test_assert(json_split_reconcile(&split) == JSON_OK);
+            test_assert(*split.close == ']');
+            json_split_run(&split, NULL, 0, (unsigned)chunks, 0);
+            for (n = i = 0; i < chunks; ++i)
+                n += (int)chunk[i].elements;
+            test_assert(n == 9);
+
+            j = 0;
+            test_assert(json_split_join(&joined, &max, &j, &split) == JSON_OK);
+            test_assert(j == read);
+            for (n = 0, j = 0; j < read; ++j) {
+                n += joined[j].str != toks[j].str || joined[j].len != toks[j].len;
+                n += joined[j].type != toks[j].type || joined[j].flags != toks[j].flags;
+                n += joined[j].sub != toks[j].sub || joined[j].children != toks[j].children;
+            }
+            test_assert(n == 0);
+        }
+        j = joined[0].sub + 1;
+        test_assert(json_query(&joined[j+1], joined[j].sub, "sub.x[1][0]")->str[0] == '2');
+
+        test_assert(json_split_begin(&split, chunk, 4, "{\"a\":1}", 7, &alloc) == JSON_INVAL);
+        test_assert(json_split_begin(&split, chunk, 4, "[1,[2,3]", 8, &alloc) == JSON_OK);
+        json_split_scan(&split, NULL, 0, 4, 0);
+        test_assert(json_split_reconcile(&split) == JSON_PARSING_ERROR);
+        test_assert(json_split_begin(&split, chunk, 4, "[1,2],3", 7, &alloc) == JSON_OK);
+        json_split_scan(&split, NULL, 0, 4, 0);
+        test_assert(json_split_reconcile(&split) == JSON_PARSING_ERROR);
+        for (chunks = 1; chunks <= 8; ++chunks) {
+            test_assert(json_split_begin(&split, chunk, chunks, "[1],[2] ", 8, &alloc) == JSON_OK);
+            json_split_scan(&split, NULL, 0, (unsigned)chunks, 0);
+            test_assert(json_split_reconcile(&split) == JSON_OK);
+            json_split_run(&split, NULL, 0, (unsigned)chunks, 0);
+            j = 0;
+            test_assert(json_split_join(&joined, &max, &j, &split) == JSON_PARSING_ERROR);
+        }
+        test_assert(json_split_begin(&split, chunk, 16, "[1,{}]", 6, &alloc) == JSON_OK);
+        json_split_scan(&split, NULL, 0, 16, 0);
+        test_assert(json_split_reconcile(&split) == JSON_OK);
+        json_split_run(&split, NULL, 0, 16, 0);
+        j = 0;
+        test_assert(json_split_join(&joined, &max, &j, &split) == JSON_OK);
+        test_assert(j == 2);
+        test_token(&joined[1], "{}", JSON_OBJECT, 0, 0);
+        for (i = 0; i < 16; ++i)
+            free(chunk[i].toks);
+        free(joined);
+    }
+
+    test_section("update")
+    {
+        char buf[256];
+        char copy[256];
+        json_size read = 0, max = 8;
+        struct json_edit edit;
+        struct json_allocator alloc;
+        struct json_token *toks = (struct json_token*)malloc(8 * sizeof(struct json_token));
+
+        alloc.userdata = NULL;
+        alloc.resize = test_resize;
+        strcpy(buf, "{\"a\":{\"b\":[1,2,3],\"c\":\"x\"},\"d\":[{\"e\":true}],\"f\":0}");
+        test_assert(json_load_alloc(&toks, &max, &read, buf, (json_size)strlen(buf), &alloc) == JSON_OK);
+
+        /* grows the innermost array and resizes both parents */
+        edit = test_edit(buf, 13, 1, "20,[21,22]");
+        test_assert(json_update(&toks, &max, &read, buf, (json_size)strlen(buf), &edit, &alloc) == JSON_OK);
+        test_assert(test_reload(toks, read, buf) == 0);
+        test_token(&toks[1], "{\"b\":[1,20,[21,22],3],\"c\":\"x\"}", JSON_OBJECT, 2, 10);
+
+        /* removes an object member */
+        edit = test_edit(buf, 7, 21, "");
+        test_assert(json_update(&toks, &max, &read, buf, (json_size)strlen(buf), &edit, &alloc) == JSON_OK);
+        test_assert(!strcmp(buf, "{\"a\":{\"c\":\"x\"},\"d\":[{\"e\":true}],\"f\":0}"));
+        test_assert(test_reload(toks, read, buf) == 0);
+
+        /* edit into a copied document rebases every token */
+        strcpy(copy, buf);
+        edit = test_edit(copy, 29, 0, ",\"g\":\"\\n\"");
+        edit.old = buf;
+        test_assert(json_update(&toks, &max, &read, copy, (json_size)strlen(copy), &edit, &alloc) == JSON_OK);
+        test_assert(test_reload(toks, read, copy) == 0);
+        test_assert(json_query(toks, read, "d[0].g")->flags == JSON_FLAG_ESCAPED);
+
+        /* root level edits parse the whole document again */
+        edit = test_edit(copy, (int)strlen(copy) - 2, 1, "12");
+        test_assert(json_update(&toks, &max, &read, copy, (json_size)strlen(copy), &edit, &alloc) == JSON_OK);
+        test_assert(test_reload(toks, read, copy) == 0);
+
+        /* a failed root level edit keeps the old tokens */
+        strcpy(buf, copy);
+        edit = test_edit(buf, 1, 0, "x");
+        edit.old = copy;
+        test_assert(json_update(&toks, &max, &read, buf, (json_size)strlen(buf), &edit, &alloc) == JSON_PARSING_ERROR);
+        test_assert(test_reload(toks, read, copy) == 0);
+
+        /* brackets changed by the edit are rejected */
+        edit = test_edit(copy, 13, 0, "},{");
+        test_assert(json_update(&toks, &max, &read, copy, (json_size)strlen(copy), &edit, &alloc) == JSON_PARSING_ERROR);
+        free(toks);
+
+        /* failed growth while splicing keeps the old tokens intact */
+        {
+            int i, calls = 3;
+            char zeros[256];
+            for (i = 0; i < 70; ++i) {
+                zeros[2*i] = '0';
+                zeros[2*i+1] = ',';
+            }
+            zeros[139] = '\0';
+            toks = NULL;
+            read = max = 0;
+            alloc.userdata = &calls;
+            alloc.resize = test_resize_limit;
+            strcpy(buf, "{\"a\":[1],\"b\":0}");
+            test_assert(json_load_alloc(&toks, &max, &read, buf, (json_size)strlen(buf), &alloc) == JSON_OK);
+            edit = test_edit(buf, 6, 1, zeros);
+            test_assert(json_update(&toks, &max, &read, buf, (json_size)strlen(buf), &edit, &alloc) == JSON_OUT_OF_TOKEN);
+            test_assert(calls == 0);
+            test_assert(read == 5);
+            test_assert(toks[1].children == 1 && toks[1].sub == 1);
+            test_assert(toks[2].len == 1 && toks[3].len == 1);
+            free(toks);
+        }
+    }
+
+    test_section("index")
+    {
+        int i, j;
+        json_size count = 0;
+        json_size read0 = 0, read1 = 0;
+        unsigned index[512];
+        struct json_token toks0[128];
+        struct json_token toks1[128];
+        const char *bufs[4];
+        bufs[0] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+        bufs[1] = "{\"escape\":\"a \\\"quoted\\\" {string} with [brackets], "
+            "colons: and backslashes \\\\\", \"utf8\":\"\xc3\xa4\xc3\xb6\xc3\xbc\","
+            "\"num\": -12.5e+3 , \"list\":[ 1.0, 2.0, 3.0, 4.0 ]}";
+        bufs[2] = "[\"\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\"x\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\"\",1]";
+        bufs[3] = "{\"coord\":[[[1,2], [3,4], [5,6]]], \"name\":\"test\"}";
+        for (i = 0; i < 4; ++i) {
+            int len = (int)strlen(bufs[i]);
+            int ok = 1;
+            read0 = read1 = 0;
+            test_assert(json_load(toks0, 128, &read0, bufs[i], len) == JSON_OK);
+            test_assert(json_index(index, 512, &count, bufs[i], len) == JSON_OK);
+            test_assert(json_load_indexed(toks1, 128, &read1, bufs[i], len, index, count) == JSON_OK);
+            test_assert(read0 == read1);
+            for (j = 0; j < read0 && j < read1; ++j) {
+                ok = ok && toks0[j].type == toks1[j].type;
+                ok = ok && toks0[j].str == toks1[j].str;
+                ok = ok && toks0[j].len == toks1[j].len;
+                ok = ok && toks0[j].children == toks1[j].children;
+                ok = ok && toks0[j].sub == toks1[j].sub;
+            }
+            test_assert(ok);
+        }
+        test_assert(json_index(index, 512, &count, "[\"open", 6) == JSON_PARSING_ERROR);
+        test_assert(json_index(index, 512, &count, "[\"\\x\"]", 6) == JSON_PARSING_ERROR);
+        test_assert(json_index(index, 2, &count, "[1,2,3]", 7) == JSON_OUT_OF_TOKEN);
+
+        /* strings are validated like json_load, also across blocks */
+        {
+            static const char *strs[] = {
+                "{\"a\":\"x\x7fy\"}", "{\"a\":\"x\xffy\"}", "{\"a\":\"x\xc3\"}",
+                "{\"a\":\"x\xc3\xa4\"}", "[\"\xe2\x82\xac\", \"\x80\"]",
+                "[\"\xf0\x9f\x98\x80\", \"\xe2\x82\"]", "[\"\xc3\xa4\", \"\\\\\xc3\"]"
+            };
+            char buf[160];
+            enum json_status status0, status1;
+            for (i = 0; i < (int)(sizeof(strs)/sizeof(strs[0])); ++i) {
+                for (j = 0; j < 96; j += 13) {
+                    /* moves the string over the block boundary */
+                    int len;
+                    memset(buf, ' ', (size_t)j);
+                    strcpy(buf + j, strs[i]);
+                    len = (int)strlen(buf);
+                    read0 = read1 = 0;
+                    status0 = json_load(toks0, 128, &read0, buf, len);
+                    status1 = json_index(index, 512, &count, buf, len);
+                    if (status1 == JSON_OK)
+                        status1 = json_load_indexed(toks1, 128, &read1, buf, len, index, count);
+                    test_assert(status0 == status1);
+                    test_assert(status0 != JSON_OK || read0 == read1);
+                }
+            }
+        }
+    }
+
+    test_section("tape")
     {
         int read = 0;
         enum json_status status;
+        struct json_tape tape[128];
+        struct json_token tok;
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+
+        status = json_load_tape(tape, 128, &read, buf, sizeof(buf));
+        test_assert(status == JSON_OK);
+        test_assert(read == json_num(buf, sizeof(buf)));
+        test_assert(tape[0].type == JSON_STRING);
+        test_assert(tape[0].next == 1);
+        test_assert(tape[0].parent == JSON_TAPE_ROOT);
+        test_assert(tape[1].type == JSON_OBJECT);
+        test_assert(tape[1].next == 22);
+        test_assert(tape[3].parent == 1);
+        test_assert(tape[5].parent == 3);
+        test_assert(tape[7].next == 12);
+        test_assert(tape[23].next == (unsigned)read);
+        test_assert(json_tape_query(tape, read, buf, "b") == &tape[1]);
+        test_assert(json_tape_query(tape, read, buf, "b.a.b") == &tape[5]);
+        test_assert(json_tape_query(tape, read, buf, "b.b") == &tape[7]);
+        test_assert(json_tape_query(tape, read, buf, "b.g") == &tape[21]);
+        test_assert(json_tape_query(tape, read, buf, "a[0].b") == &tape[26]);
+        test_assert(json_tape_query(tape, read, buf, "a[1][3]") == &tape[31]);
+        test_assert(json_tape_query(tape, read, buf, "a[6]") == &tape[36]);
+        test_assert(json_tape_query(tape, read, buf, "a[7]") == NULL);
+        test_assert(json_tape_query(tape, read, buf, "b.h") == NULL);
+
+        /* steps into the wrong kind of container find nothing */
+        test_assert(json_tape_query(tape, read, buf, "a.b") == NULL);
+        test_assert(json_tape_query(tape, read, buf, "b[0]") == NULL);
+
+        json_tape_token(&tok, tape, 1, buf);
+        test_assert(tok.type == JSON_OBJECT);
+        test_assert(tok.children == 7);
+        test_assert(tok.sub == 20);
+        json_tape_token(&tok, tape, 23, buf);
+        test_assert(tok.type == JSON_ARRAY);
+        test_assert(tok.children == 7);
+        test_assert(tok.sub == 13);
+        json_tape_token(&tok, tape, 13, buf);
+        test_token(&tok, "test", JSON_STRING, 0, 0);
+
+        read = 0;
+        test_assert(json_load_tape(tape, 128, &read, "{\"a\":[\"x\",\"y\"]}", 15) == JSON_OK);
+        test_assert(json_tape_query(tape, read, "{\"a\":[\"x\",\"y\"]}", "a.x") == NULL);
+        read = 0;
+        test_assert(json_load_tape(tape, 128, &read, "{\"a\":{\"k\":1,\"m\":2}}", 19) == JSON_OK);
+        test_assert(json_tape_query(tape, read, "{\"a\":{\"k\":1,\"m\":2}}", "a[0]") == NULL);
+        test_assert(json_tape_query(tape, read, "{\"a\":{\"k\":1,\"m\":2}}", "a[1]") == NULL);
+        test_assert(json_tape_query(tape, read, "{\"a\":{\"k\":1,\"m\":2}}", "[0]") == NULL);
+        read = 0;
+        test_assert(json_load_tape(tape, 128, &read, " [ \"a\",1]", 10) == JSON_OK);
+        test_assert(json_tape_query(tape, read, " [ \"a\",1]", "a") == NULL);
+        test_assert(json_tape_query(tape, read, " [ \"a\",1]", "[1]") == &tape[1]);
+        test_assert(sizeof(struct json_tape) == 16);
+    }
+
+    test_section("query_compiled")
+    {
+        int i;
+        json_size read = 0;
+        enum json_status status;
+        struct json_token toks[128];
+        struct json_path path;
+        const char *paths[] = {"b", "b.a", "b.a.b", "b.b", "b.b[3]", "b.c", "b.g",
+            "a[0]", "a[0].b", "a[1][0]", "a[1][3]", "a[2]", "a[6]"};
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+
+        status = json_load(toks, 128, &read, buf, sizeof(buf));
+        test_assert(status == JSON_OK);
+        for (i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i) {
+            test_assert(json_path_compile(&path, paths[i]));
+            test_assert(json_query_compiled(toks, read, &path) == json_query(toks, read, paths[i]));
+        }
+        test_assert(json_path_compile(&path, "a[1][3]"));
+        test_assert(path.count == 3);
+        test_assert(path.steps[0].key && path.steps[0].len == 1);
+        test_assert(!path.steps[2].key && path.steps[2].len == 3);
+        test_assert(json_path_compile(&path, "b.h"));
+        test_assert(json_query_compiled(toks, read, &path) == NULL);
+        test_assert(json_path_compile(&path, "a[7]"));
+        test_assert(json_query_compiled(toks, read, &path) == NULL);
+        test_assert(json_path_compile(&path, "b.c.d"));
+        test_assert(json_query_compiled(toks, read, &path) == NULL);
+
+        /* steps into the wrong kind of container find nothing */
+        read = 0;
+        test_assert(json_load(toks, 128, &read, "{\"a\":[\"x\",\"y\"]}", 15) == JSON_OK);
+        test_assert(json_path_compile(&path, "a.x"));
+        test_assert(json_query_compiled(toks, read, &path) == NULL);
+        test_assert(json_query(toks, read, "a.x") == NULL);
+        read = 0;
+        test_assert(json_load(toks, 128, &read, "{\"a\":{\"k\":1,\"m\":2}}", 19) == JSON_OK);
+        test_assert(json_path_compile(&path, "a[0]"));
+        test_assert(json_query_compiled(toks, read, &path) == NULL);
+        test_assert(json_path_compile(&path, "a[1]"));
+        test_assert(json_query_compiled(toks, read, &path) == NULL);
+        test_assert(json_path_compile(&path, "a.k"));
+        test_assert(!json_cmp(json_query_compiled(toks, read, &path), "1"));
+        test_assert(!json_path_compile(&path, "b..c"));
+        test_assert(!json_path_compile(&path, "a[1"));
+        test_assert(!json_path_compile(&path, "a."));
+        test_assert(!json_path_compile(&path, "a[]"));
+        test_assert(!json_path_compile(&path, "a[99999999999]"));
+    }
+
+    test_section("query_multi")
+    {
+        int i, n;
+        json_size read = 0;
+        struct json_token toks[128];
+        struct json_token *out[8];
+        struct json_path path;
+        struct json_trie trie;
+        struct json_trie_node nodes[32];
+        const char *paths[] = {"b.a.b", "b.b[3]", "a[1][0]", "b.g", "a[0].b",
+            "a[6]", "b.h", "b.b[7]"};
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+
+        test_assert(json_load(toks, 128, &read, buf, sizeof(buf)) == JSON_OK);
+        json_trie_begin(&trie, nodes, 32);
+        for (i = 0; i < 8; ++i) {
+            test_assert(json_path_compile(&path, paths[i]));
+            test_assert(json_trie_add(&trie, &path, i));
+        }
+        test_assert(trie.count == 15);
+        n = json_query_multi(out, 8, toks, read, &trie);
+        test_assert(n == 6);
+        for (i = 0; i < 8; ++i)
+            test_assert(out[i] == json_query(toks, read, paths[i]));
+        test_assert(out[6] == NULL);
+        test_assert(out[7] == NULL);
+
+        json_trie_begin(&trie, nodes, 2);
+        test_assert(json_path_compile(&path, "b.a.b"));
+        test_assert(!json_trie_add(&trie, &path, 0));
+    }
+
+    test_section("query_select")
+    {
+        json_size read = 0;
+        struct json_token toks[128];
+        struct json_token *out[16];
+        struct json_select sel;
+        const char buf[] = "{\"entity\":[{\"id\":1,\"pos\":{\"x\":10}},{\"id\":2,\"pos\":{\"x\":20}},"
+            "{\"id\":3},{\"id\":4,\"pos\":{\"x\":40}}],\"users\":{\"a\":{\"name\":\"ann\"},"
+            "\"b\":{\"name\":\"bob\"}},\"a/b\":1,\"m~n\":2,\"0\":3,\"log\":[5,6,7,8,9]}";
+
+        test_assert(json_load(toks, 128, &read, buf, sizeof(buf)) == JSON_OK);
+        test_assert(json_select_compile(&sel, "entity[*].pos.x"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 3);
+        test_assert(!json_cmp(out[0], "10") && !json_cmp(out[2], "40"));
+        test_assert(json_select_compile(&sel, "users.*.name"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 2);
+        test_assert(!json_cmp(out[1], "bob"));
+        test_assert(json_select_compile(&sel, "log[1:-1:2]"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 2);
+        test_assert(!json_cmp(out[0], "6") && !json_cmp(out[1], "8"));
+        test_assert(json_select_compile(&sel, "log[-1]"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 1);
+        test_assert(!json_cmp(out[0], "9"));
+        test_assert(json_select_compile(&sel, "log[:2]"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 2);
+        test_assert(json_select_compile(&sel, "log[-9]"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 0);
+        test_assert(json_select_compile(&sel, "entity[*].id"));
+        test_assert(json_query_select(NULL, 0, toks, read, &sel, JSON_NONE) == 4);
+        test_assert(json_query_select(out, 2, toks, read, &sel, JSON_NONE) == 4);
+        test_assert(!json_cmp(out[1], "2"));
+
+        /* RFC 6901 JSON Pointer */
+        test_assert(json_select_compile(&sel, "/entity/3/pos/x"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 1);
+        test_assert(!json_cmp(out[0], "40"));
+        test_assert(json_select_compile(&sel, "/a~1b"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 1);
+        test_assert(!json_cmp(out[0], "1"));
+        test_assert(json_select_compile(&sel, "/m~0n"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 1);
+        test_assert(json_select_compile(&sel, "/0"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_OBJECT) == 1);
+        test_assert(!json_cmp(out[0], "3"));
+        test_assert(json_select_compile(&sel, "/log/01"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 0);
+        test_assert(json_select_compile(&sel, "/log/-"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 0);
+
+        read = 0;
+        test_assert(json_load(toks, 128, &read, "[\"x\", [1,2]]", 12) == JSON_OK);
+        test_assert(json_select_compile(&sel, "/1/0"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 1);
+        test_assert(!json_cmp(out[0], "1"));
+        test_assert(json_select_compile(&sel, "[*]"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_NONE) == 2);
+
+        /* numeric reference tokens into a root object need its type */
+        read = 0;
+        test_assert(json_load(toks, 128, &read, "\"0\":1", 5) == JSON_OK);
+        test_assert(json_select_compile(&sel, "/0"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_OBJECT) == 1);
+        test_assert(!json_cmp(out[0], "1"));
+        test_assert(json_query_select(out, 16, toks, read, &sel, JSON_ARRAY) == 1);
+        test_assert(!json_cmp(out[0], "0"));
+        {
+            static const unsigned char mp_map[] = {0x81, 0xA1, '0', 0x05};
+            read = 0;
+            test_assert(json_mp_load(toks, 128, &read, mp_map, sizeof(mp_map)) == JSON_OK);
+            test_assert(json_query_select(out, 16, toks, read, &sel, JSON_OBJECT) == 1);
+            test_assert(out[0]->type == JSON_NUMBER);
+            test_assert(!json_cmp(&toks[0], "0"));
+        }
+
+        test_assert(!json_select_compile(&sel, ""));
+        test_assert(!json_select_compile(&sel, "a[1"));
+        test_assert(!json_select_compile(&sel, "a[1:2:0]"));
+        test_assert(!json_select_compile(&sel, "a."));
+        test_assert(!json_select_compile(&sel, "/a~2"));
+    }
+
+    test_section("cursor")
+    {
+        int i, j;
+        json_size read = 0;
+        int ok = 1, ids = 0;
+        json_int64 id = 0;
+        struct json_token toks[128];
+        struct json_token key, val;
+        struct json_cursor root, users, user;
+        const char *bufs[4];
+        const char buf[] = "{\"skip\":{\"a\":[1,{\"b\":\"}]\\\"{\"}],\"c\":\"x\\\\\"},"
+            "\"num\":12,\"users\":[{\"name\":\"a\",\"id\":1},{\"id\":2,\"name\":\"b\"}],"
+            "\"str\":\"v\",\"arr\":[1, 2, 3]}";
+
+        root = json_cursor_begin(buf, (int)strlen(buf));
+        test_assert(root.err == JSON_OK && root.type == JSON_OBJECT);
+        test_assert(json_cursor_find(&root, "num", &val));
+        test_assert(!json_cmp(&val, "12") && val.flags == JSON_FLAG_INTEGER);
+        test_assert(json_cursor_find(&root, "users", &val));
+        test_assert(val.type == JSON_ARRAY);
+        users = json_cursor_enter(&root, &val);
+        while (json_cursor_next(&users, &key, &val)) {
+            ok = ok && key.type == JSON_NONE && val.type == JSON_OBJECT;
+            user = json_cursor_enter(&users, &val);
+            if (json_cursor_find(&user, "id", &val) && json_convert_int(&id, &val) == JSON_NUMBER)
+                ids += (int)id;
+        }
+        test_assert(ok && ids == 3 && users.err == JSON_OK);
+        test_assert(json_cursor_next(&root, &key, &val));
+        test_assert(!json_cmp(&key, "str") && !json_cmp(&val, "v"));
+        test_assert(json_cursor_next(&root, &key, &val));
+        test_assert(json_cursor_skip(&root, &val));
+        test_assert(!json_cmp(&val, "[1, 2, 3]"));
+        test_assert(json_array_to_int64s(NULL, 0, &val) == 3);
+        test_assert(!json_cursor_next(&root, &key, &val));
+        test_assert(root.err == JSON_OK);
+
+        /* skipped containers end where the tokenizer ends them */
+        bufs[0] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+        bufs[1] = "{\"escape\":[\"a \\\"quoted\\\" {string} with [brackets], "
+            "colons: and backslashes \\\\\"], \"utf8\":\"\xc3\xa4\xc3\xb6\xc3\xbc\","
+            "\"num\": -12.5e+3 , \"list\":[ 1.0, 2.0, 3.0, 4.0 ]}";
+        bufs[2] = "[[\"\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\"x]\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\"\"],1]";
+        bufs[3] = "{\"coord\":[[[1,2], [3,4], [5,6]]], \"name\":\"test\"}";
+        for (i = 0; i < 4; ++i) {
+            int len = (int)strlen(bufs[i]);
+            read = 0;
+            ok = 1;
+            test_assert(json_load(toks, 128, &read, bufs[i], len) == JSON_OK);
+            root = json_cursor_begin(bufs[i], len);
+            for (j = 0; json_cursor_next(&root, &key, &val); ) {
+                if (root.type == JSON_OBJECT)
+                    ok = ok && key.str == toks[j++].str;
+                if (val.type == JSON_OBJECT || val.type == JSON_ARRAY)
+                    ok = ok && json_cursor_skip(&root, &val);
+                ok = ok && val.str == toks[j].str && val.len == toks[j].len;
+                ok = ok && val.type == toks[j].type;
+                j += toks[j].sub + 1;
+            }
+            test_assert(ok && j == read && root.err == JSON_OK);
+        }
+
+        root = json_cursor_begin("{\"a\":[1,{\"b\":2}", 15);
+        test_assert(!json_cursor_find(&root, "c", &val));
+        test_assert(root.err == JSON_PARSING_ERROR);
+        root = json_cursor_begin("{\"a\" 1}", 7);
+        test_assert(!json_cursor_next(&root, &key, &val));
+        test_assert(root.err == JSON_PARSING_ERROR);
+        root = json_cursor_begin("12", 2);
+        test_assert(root.err == JSON_PARSING_ERROR);
+    }
+
+    test_section("hash")
+    {
+        int i, len = 0, ok = 1;
+        json_size read = 0;
+        json_size slots[4096];
+        char *buf = (char*)malloc(64 * 1024);
+        struct json_token *toks = (struct json_token*)calloc(4096, sizeof(struct json_token));
+        struct json_token *t;
+        struct json_hash hash;
+
+        len += sprintf(buf, "{\"dict\":{");
+        for (i = 0; i < 1000; ++i)
+            len += sprintf(buf + len, "%s\"user%d\":{\"id\":%d}", i ? ",": "", i, i);
+        len += sprintf(buf + len, ",\"user7\":1},\"other\":2}");
+        test_assert(json_load(toks, 4096, &read, buf, len) == JSON_OK);
+
+        t = json_query(toks, read, "dict");
+        test_assert(t && t->type == JSON_OBJECT);
+        test_assert(json_hash_size(t + 1, t->sub) == 2048);
+        test_assert(!json_hash_build(&hash, slots, 1024, t + 1, t->sub));
+        test_assert(json_hash_build(&hash, slots, 4096, t + 1, t->sub));
+        for (i = 0; i < 1000; ++i) {
+            char key[32];
+            struct json_path path;
+            struct json_token *v;
+            sprintf(key, "user%d", i);
+            v = json_hash_get(&hash, key);
+            json_path_compile(&path, key);
+            ok = ok && v && v->type == JSON_OBJECT;
+            ok = ok && v == json_query_compiled(t + 1, t->sub, &path);
+        }
+        test_assert(ok);
+        test_assert(json_hash_get(&hash, "user7")->type == JSON_OBJECT);
+        test_assert(json_hash_get(&hash, "user1000") == NULL);
+        test_assert(json_hash_get(&hash, "other") == NULL);
+
+        test_assert(json_hash_build(&hash, slots, json_hash_size(toks, read), toks, read));
+        test_assert(json_hash_get(&hash, "dict") == t);
+        test_assert(!json_cmp(json_hash_get(&hash, "other"), "2"));
+
+        /* empty keys are valid keys */
+        read = 0;
+        test_assert(json_load(toks, 4096, &read, "{\"x\":0,\"\":1}", 13) == JSON_OK);
+        test_assert(json_hash_build(&hash, slots, json_hash_size(toks, read), toks, read));
+        test_assert(!json_cmp(json_hash_get(&hash, ""), "1"));
+        {
+            struct json_token val;
+            struct json_cursor root = json_cursor_begin("{\"x\":0,\"\":1}", 13);
+            test_assert(json_cursor_find(&root, "", &val) && !json_cmp(&val, "1"));
+        }
+        free(toks);
+        free(buf);
+    }
+
+    test_section("unescape")
+    {
+        int tape_read = 0;
+        json_size read = 0, count = 0;
+        char memory[64], small[4];
+        unsigned index[64];
+        struct json_arena arena;
+        struct json_view view;
+        struct json_token toks[16], val;
+        struct json_tape tape[16];
+        struct json_pair pair;
+        struct json_iter iter;
+        struct json_cursor root;
+        const char buf[] = "{\"plain\":\"abc\",\"esc\":\"a\\\"b\\\\c\\/\\n\\t\\u00e9\\u20AC\","
+            "\"pair\":\"\\ud83d\\ude00\",\"lone\":\"\\ud800x\",\"bad\":\"\\u12G4\"}";
+
+        test_assert(json_load(toks, 16, &read, buf, sizeof(buf)-1) == JSON_OK);
+        test_assert(read == 10);
+        test_assert(toks[1].flags == 0 && toks[2].flags == 0);
+        test_assert(toks[3].flags == JSON_FLAG_ESCAPED);
+        test_assert(toks[9].flags == JSON_FLAG_ESCAPED);
+
+        json_arena_begin(&arena, memory, sizeof(memory));
+        test_assert(json_unescape(&view, &arena, &toks[1]));
+        test_assert(view.str == toks[1].str && view.len == 3 && arena.used == 0);
+        test_assert(json_unescape(&view, &arena, &toks[3]));
+        test_assert(view.str == memory && view.len == 13);
+        test_assert(!memcmp(view.str, "a\"b\\c/\n\t\xc3\xa9\xe2\x82\xac", 13));
+        test_assert(json_unescape(&view, &arena, &toks[5]));
+        test_assert(view.len == 4 && !memcmp(view.str, "\xf0\x9f\x98\x80", 4));
+        test_assert(json_unescape(&view, &arena, &toks[7]));
+        test_assert(view.len == 4 && !memcmp(view.str, "\xef\xbf\xbdx", 4));
+        test_assert(arena.used == 21);
+        test_assert(!json_unescape(&view, &arena, &toks[9]) && !view.str);
+        test_assert(arena.used == 21);
+
+        /* plain strings do not need any arena memory */
+        json_arena_begin(&arena, small, sizeof(small));
+        test_assert(!json_unescape(&view, &arena, &toks[3]));
+        test_assert(json_unescape(&view, &arena, &toks[1]) && view.len == 3);
+        test_assert(json_unescape(&view, NULL, &toks[2]) && view.len == 3);
+
+        /* every tokenizer marks escaped strings */
+        iter = json_begin(buf, sizeof(buf)-1);
+        iter = json_parse(&pair, &iter);
+        test_assert(!iter.err && pair.value.flags == 0);
+        iter = json_parse(&pair, &iter);
+        test_assert(!iter.err && pair.value.flags == JSON_FLAG_ESCAPED);
+        iter = json_parse(&pair, &iter);
+        test_assert(!iter.err && pair.value.flags == JSON_FLAG_ESCAPED);
+
+        test_assert(json_index(index, 64, &count, buf, sizeof(buf)-1) == JSON_OK);
+        read = 0;
+        test_assert(json_load_indexed(toks, 16, &read, buf, sizeof(buf)-1, index, count) == JSON_OK);
+        test_assert(toks[1].flags == 0 && toks[3].flags == JSON_FLAG_ESCAPED);
+
+        test_assert(json_load_tape(tape, 16, &tape_read, buf, sizeof(buf)-1) == JSON_OK);
+        json_tape_token(&val, tape, 3, buf);
+        test_assert(val.flags == JSON_FLAG_ESCAPED);
+        json_tape_token(&val, tape, 1, buf);
+        test_assert(val.flags == 0);
+
+        root = json_cursor_begin(buf, sizeof(buf)-1);
+        test_assert(json_cursor_find(&root, "plain", &val) && val.flags == 0);
+        test_assert(json_cursor_find(&root, "esc", &val) && val.flags == JSON_FLAG_ESCAPED);
+        test_assert(json_unescape(&view, &arena, &val) == 0);
+    }
+
+    test_section("writer")
+    {
+        int i;
+        json_size read = 0;
+        char buffer[64];
+        json_number num = 0;
+        struct json_writer w;
+        struct json_token toks[64];
+        struct test_output out;
+        const char expect[] = "{\"name\":\"a \\\"b\\\"\\n\\u0001\\\\\","
+            "\"values\":[0.1,-1.5,1e21,1.0,-0.0,5e-324,1.7976931348623157e308,0.000123,"
+            "-9223372036854775808,42],\"flags\":[true,false,null],\"empty\":{},"
+            "\"raw\":[1,2]}";
+        const double values[] = {0.1, -1.5, 1e21, 1.0, -0.0, 5e-324, 1.7976931348623157e308, 0.000123};
+
+        memset(&out, 0, sizeof(out));
+        json_writer_begin(&w, buffer, sizeof(buffer), test_flush, &out);
+        json_write_object_begin(&w);
+        json_write_key(&w, "name", -1);
+        json_write_string(&w, "a \"b\"\n\001\\", -1);
+        json_write_key(&w, "values", 6);
+        json_write_array_begin(&w);
+        for (i = 0; i < 8; ++i)
+            json_write_number(&w, values[i]);
+        json_write_int(&w, -(json_int64)(((json_uint64)1 << 63) - 1) - 1);
+        json_write_int(&w, 42);
+        json_write_array_end(&w);
+        json_write_key(&w, "flags", -1);
+        json_write_array_begin(&w);
+        json_write_bool(&w, 1);
+        json_write_bool(&w, 0);
+        json_write_null(&w);
+        json_write_array_end(&w);
+        json_write_key(&w, "empty", -1);
+        json_write_object_begin(&w);
+        json_write_object_end(&w);
+        json_write_key(&w, "raw", -1);
+        json_write_raw(&w, "[1,2]", -1);
+        json_write_object_end(&w);
+        test_assert(json_writer_end(&w) == JSON_OK);
+        test_assert(out.flushes > 1);
+        test_assert(!strcmp(out.data, expect));
+
+        test_assert(json_load(toks, 64, &read, out.data, out.len) == JSON_OK);
+        test_assert(json_query_number(&num, toks, read, "values[0]") == JSON_NUMBER);
+        test_assert(num == 0.1);
+        test_assert(json_query_number(&num, toks, read, "values[5]") == JSON_NUMBER);
+        test_assert(num == 5e-324);
+
+        /* without flush callback the output is limited to the buffer */
+        json_writer_begin(&w, buffer, sizeof(buffer), NULL, NULL);
+        json_write_array_begin(&w);
+        for (i = 0; i < 16; ++i)
+            json_write_int(&w, i);
+        json_write_array_end(&w);
+        test_assert(json_writer_end(&w) == JSON_OK);
+        test_assert(w.used == 39 && !memcmp(buffer, "[0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15]", 39));
+        json_writer_begin(&w, buffer, sizeof(buffer), NULL, NULL);
+        for (i = 0; i < 16; ++i)
+            json_write_string(&w, "0123456789", -1);
+        test_assert(json_writer_end(&w) == JSON_OUT_OF_MEMORY);
+        json_writer_begin(&w, buffer, sizeof(buffer), NULL, NULL);
+        json_write_array_begin(&w);
+        test_assert(json_writer_end(&w) == JSON_PARSING_ERROR);
+    }
+
+    test_section("cache")
+    {
+        FILE *fp;
+        json_size i, read = 0;
+        json_number num = 0;
+        struct json_cache cache;
+        struct json_file file;
+        struct json_token toks[16], cached[16];
+        struct test_output out;
+        const char path[] = "json_test_cache.bin";
+        const char buf[] = "{\"name\":\"a\\tb\",\"list\":[1.5,-2e3,7],\"ok\":true}";
+
+        test_assert(json_load(toks, 16, &read, buf, sizeof(buf)-1) == JSON_OK);
+        test_assert(read == 9);
+        memset(&out, 0, sizeof(out));
+        test_assert(json_cache_write(toks, read, buf, sizeof(buf)-1, test_flush, &out) == JSON_OK);
+        test_assert(out.len == 32 + 20 * 9 + (int)sizeof(buf)-1);
+
+        test_assert(json_cache_open(&cache, out.data, out.len) == JSON_OK);
+        test_assert(cache.count == 9 && cache.length == (json_size)sizeof(buf)-1);
+        test_assert(!memcmp(cache.json, buf, sizeof(buf)-1));
+        test_assert(json_cache_tokens(cached, 8, &cache) == JSON_OUT_OF_TOKEN);
+        test_assert(json_cache_tokens(cached, 16, &cache) == JSON_OK);
+        for (i = 0; i < read; ++i) {
+            test_assert(cached[i].str - cache.json == toks[i].str - buf);
+            test_assert(cached[i].len == toks[i].len);
+            test_assert(cached[i].type == toks[i].type);
+            test_assert(cached[i].flags == toks[i].flags);
+            test_assert(cached[i].sub == toks[i].sub);
+            test_assert(cached[i].children == toks[i].children);
+        }
+        test_assert(json_query(cached, read, "list[1]") == &cached[5]);
+        test_assert(json_cache_number(&num, &cache, 4) == JSON_NUMBER && num == 1.5);
+        test_assert(json_cache_number(&num, &cache, 5) == JSON_NUMBER && num == -2000.0);
+        test_assert(json_cache_number(&num, &cache, 6) == JSON_NUMBER && num == 7.0);
+        test_assert(json_cache_number(&num, &cache, 1) == JSON_NONE);
+        test_assert(json_cache_number(&num, &cache, 9) == JSON_NONE);
+
+        /* truncated or foreign data is rejected */
+        test_assert(json_cache_open(&cache, out.data, out.len - 1) == JSON_INVAL);
+        test_assert(json_cache_open(&cache, out.data, 16) == JSON_INVAL);
+        out.data[0] = 'X';
+        test_assert(json_cache_open(&cache, out.data, out.len) == JSON_INVAL);
+        out.data[0] = 'J';
+        out.data[32] += 100;
+        test_assert(json_cache_open(&cache, out.data, out.len) == JSON_OK);
+        test_assert(json_cache_tokens(cached, 16, &cache) == JSON_PARSING_ERROR);
+        out.data[32] -= 100;
+
+        /* reload through a mapped file */
+        fp = fopen(path, "wb");
+        test_assert(fp != NULL);
+        if (fp) {
+            fwrite(out.data, 1, (size_t)out.len, fp);
+            fclose(fp);
+        }
+        test_assert(json_cache_load(&cache, &file, path) == JSON_OK);
+        test_assert(json_cache_tokens(cached, 16, &cache) == JSON_OK);
+        test_assert(cache.json >= file.data && cache.json < file.data + file.size);
+        test_assert(!json_cmp(json_query(cached, read, "name"), "a\\tb"));
+        test_assert(json_query_number(&num, cached, read, "list[0]") == JSON_NUMBER && num == 1.5);
+        json_file_close(&file);
+        remove(path);
+        test_assert(json_cache_load(&cache, &file, path) == JSON_FILE_ERROR);
+    }
+
+    test_section("msgpack")
+    {
+        json_size i, read = 0, mp_read = 0, size = 0;
+        json_int64 value = 0;
+        json_number num = 0;
+        double values[32];
+        char str[16], deep[2 * JSON_MP_DEPTH + 2];
+        struct json_token toks[64], mp[128], tok;
+        struct json_pair pair;
+        struct json_mp_iter iter, sub;
+        struct test_output out;
+        const char buf[] = "{\"a\":1,\"b\":[true,false,null],\"c\":\"x\\ny\",\"d\":-1.5,"
+            "\"e\":-200,\"f\":70000,\"g\":{}}";
+        const unsigned char expect[] = {0x87, 0xa1,'a',0x01, 0xa1,'b',0x93,0xc3,0xc2,0xc0,
+            0xa1,'c',0xa3,'x','\n','y', 0xa1,'d',0xcb,0xbf,0xf8,0,0,0,0,0,0,
+            0xa1,'e',0xd1,0xff,0x38, 0xa1,'f',0xce,0x00,0x01,0x11,0x70, 0xa1,'g',0x80};
+        const char nums[] = "[[0,127,128,-32,-33,255,256,65536,-129,-32769,"
+            "9223372036854775807,-9223372036854775808,4294967296,1e300,0.1,2.5e-3,"
+            "100000000000000000000,1,2,3]]";
+
+        memset(&out, 0, sizeof(out));
+        test_assert(json_mp_transcode(buf, sizeof(buf)-1, test_flush, &out) == JSON_OK);
+        test_assert(out.len == (int)sizeof(expect));
+        test_assert(!memcmp(out.data, expect, sizeof(expect)));
+
+        /* tokens have the same layout as tokens of the JSON text */
+        test_assert(json_load(toks, 64, &read, buf, sizeof(buf)-1) == JSON_OK);
+        test_assert(json_mp_load(mp, 64, &mp_read, out.data, out.len) == JSON_OK);
+        test_assert(mp_read == read);
+        for (i = 0; i < read; ++i) {
+            test_assert(mp[i].type == toks[i].type);
+            test_assert(mp[i].children == toks[i].children);
+            test_assert(mp[i].sub == toks[i].sub);
+            test_assert(mp[i].flags == (toks[i].flags & ~(unsigned)JSON_FLAG_ESCAPED) + JSON_FLAG_BINARY);
+        }
+        test_assert(json_query_number(&num, mp, mp_read, "d") == JSON_NUMBER && num == -1.5);
+        test_assert(json_query_int(&value, mp, mp_read, "f") == JSON_NUMBER && value == 70000);
+        test_assert(json_query_int(&value, mp, mp_read, "e") == JSON_NUMBER && value == -200);
+        test_assert(json_query_int(&value, mp, mp_read, "d") == JSON_NONE);
+        test_assert(json_query_string(str, 16, &size, mp, mp_read, "c") == JSON_STRING);
+        test_assert(size == 3 && !strcmp(str, "x\ny"));
+        test_assert(json_query_type(mp, mp_read, "b[2]") == JSON_NULL);
+        test_assert(json_query_type(mp, mp_read, "g") == JSON_OBJECT);
+        test_assert(json_convert(&num, &mp[5]) == JSON_NONE);
+
+        /* iteration over pairs and into containers */
+        iter = json_mp_begin(out.data, out.len);
+        iter = json_mp_parse(&pair, &iter);
+        test_assert(!iter.err && !json_cmp(&pair.name, "a"));
+        test_assert(json_convert_int(&value, &pair.value) == JSON_NUMBER && value == 1);
+        iter = json_mp_parse(&pair, &iter);
+        test_assert(!iter.err && pair.value.type == JSON_ARRAY && pair.value.children == 3);
+        sub = json_mp_begin(pair.value.str, pair.value.len);
+        sub = json_mp_read(&tok, &sub);
+        test_assert(!sub.err && tok.type == JSON_TRUE);
+        sub = json_mp_read(&tok, &sub);
+        sub = json_mp_read(&tok, &sub);
+        test_assert(!sub.err && tok.type == JSON_NULL);
+        sub = json_mp_read(&tok, &sub);
+        test_assert(!sub.err && !tok.str);
+        for (i = 0; i < 5; ++i)
+            iter = json_mp_parse(&pair, &iter);
+        test_assert(!iter.err && !json_cmp(&pair.name, "g") && pair.value.type == JSON_OBJECT);
+        iter = json_mp_read(&tok, &iter);
+        test_assert(!iter.err && !tok.str);
+
+        /* invalid and truncated data */
+        mp_read = 0;
+        test_assert(json_mp_load(mp, 64, &mp_read, out.data, out.len - 1) == JSON_PARSING_ERROR);
+        mp_read = 0;
+        test_assert(json_mp_load(mp, 4, &mp_read, out.data, out.len) == JSON_OUT_OF_TOKEN);
+        mp_read = 0;
+        out.data[3] = (char)0xc1;
+        test_assert(json_mp_load(mp, 64, &mp_read, out.data, out.len) == JSON_PARSING_ERROR);
+        out.data[0] = (char)0xdf;
+        iter = json_mp_begin(out.data, out.len);
+        test_assert(iter.err);
+
+        /* integer formats and doubles round trip */
+        memset(&out, 0, sizeof(out));
+        test_assert(json_mp_transcode(nums, sizeof(nums)-1, test_flush, &out) == JSON_OK);
+        test_assert((unsigned char)out.data[1] == 0xdc && out.data[3] == 20);
+        mp_read = 0;
+        test_assert(json_mp_load(mp, 64, &mp_read, out.data, out.len) == JSON_OK);
+        test_assert(mp_read == 21 && mp[0].type == JSON_ARRAY && mp[0].children == 20);
+        test_assert(mp[0].len == out.len - 1 && mp[0].sub == 20);
+        test_assert(json_array_to_doubles(values, 32, &mp[0]) == 20);
+        test_assert(values[1] == 127.0 && values[4] == -33.0 && values[13] == 1e300);
+        test_assert(values[14] == 0.1 && values[15] == 2.5e-3 && values[16] == 1e20);
+        test_assert(json_array_to_int64s(NULL, 0, &mp[0]) == -1);
+        read = 0;
+        test_assert(json_load(toks, 64, &read, nums, sizeof(nums)-1) == JSON_OK);
+        for (i = 1; i < read; ++i) {
+            json_int64 a = 0, b = 0;
+            test_assert(json_convert_int(&a, &toks[i]) == json_convert_int(&b, &mp[i]));
+            test_assert(a == b);
+        }
+
+        /* scalar documents */
+        memset(&out, 0, sizeof(out));
+        test_assert(json_mp_transcode(" \"abc\" ", 7, test_flush, &out) == JSON_OK);
+        test_assert(out.len == 4 && (unsigned char)out.data[0] == 0xa3);
+        iter = json_mp_begin(out.data, out.len);
+        iter = json_mp_read(&tok, &iter);
+        test_assert(!iter.err && tok.type == JSON_STRING && !json_cmp(&tok, "abc"));
+        test_assert(json_mp_transcode("[1,2", 4, test_flush, &out) == JSON_PARSING_ERROR);
+
+        /* nesting is limited to JSON_MP_DEPTH */
+        for (i = 0; i <= JSON_MP_DEPTH; ++i) {
+            deep[i] = '[';
+            deep[2 * JSON_MP_DEPTH + 1 - i] = ']';
+        }
+        memset(&out, 0, sizeof(out));
+        test_assert(json_mp_transcode(deep, 2 * JSON_MP_DEPTH + 2, test_flush, &out) == JSON_PARSING_ERROR);
+        memset(&out, 0, sizeof(out));
+        test_assert(json_mp_transcode(deep + 1, 2 * JSON_MP_DEPTH, test_flush, &out) == JSON_OK);
+        memset(out.data, 0x91, JSON_MP_DEPTH + 2);
+        out.data[JSON_MP_DEPTH + 2] = (char)0xc0;
+        mp_read = 0;
+        test_assert(json_mp_load(mp, 128, &mp_read, out.data, JSON_MP_DEPTH + 3) == JSON_PARSING_ERROR);
+        mp_read = 0;
+        test_assert(json_mp_load(mp, 128, &mp_read, out.data + 2, JSON_MP_DEPTH + 1) == JSON_OK);
+        test_assert(mp_read == JSON_MP_DEPTH && mp[0].sub == JSON_MP_DEPTH - 1);
+    }
+
+    test_section("decode")
+    {
+        struct test_vec2 {float x, y;};
+        struct test_entity {
+            int id;
+            json_int64 uid;
+            double weight;
+            int active;
+            char name[8];
+            struct test_vec2 position;
+        };
+        #define TEST_VEC2_FIELDS(FIELD)\
+            FIELD(struct test_vec2, x, JSON_FIELD_FLOAT, 0)\
+            FIELD(struct test_vec2, y, JSON_FIELD_FLOAT, 0)
+        #define TEST_ENTITY_FIELDS(FIELD)\
+            FIELD(struct test_entity, id, JSON_FIELD_INT, 0)\
+            FIELD(struct test_entity, uid, JSON_FIELD_INT64, 0)\
+            FIELD(struct test_entity, weight, JSON_FIELD_DOUBLE, 0)\
+            FIELD(struct test_entity, active, JSON_FIELD_BOOL, 0)\
+            FIELD(struct test_entity, name, JSON_FIELD_STRING, 0)\
+            FIELD(struct test_entity, position, JSON_FIELD_OBJECT, &vec2_schema)
+        static struct json_schema vec2_schema, entity_schema;
+        static const struct json_field vec2_fields[] = {TEST_VEC2_FIELDS(JSON_FIELD_ENTRY)};
+        static const struct json_field entity_fields[] = {TEST_ENTITY_FIELDS(JSON_FIELD_ENTRY)};
+        const struct json_field bad_fields[] = {{"x", 0, JSON_FIELD_DOUBLE, sizeof(float), 0}};
+        unsigned char vec2_slots[4], entity_slots[16], bad_slots[4];
+        json_size read = 0, mp_read = 0;
+        struct json_token toks[64], mp[64], *obj;
+        struct test_entity e;
+        struct test_output out;
+        const char buf[] = "{\"list\":[{\"id\":7,\"uid\":9007199254740993,\"weight\":2.5,"
+            "\"active\":true,\"name\":\"a\\tb\",\"extra\":[1,{\"id\":3}],"
+            "\"position\":{\"y\":-1,\"x\":0.5,\"z\":3}},"
+            "{\"id\":\"text\",\"name\":\"too long name\",\"active\":1,\"position\":[1]}]}";
+
+        test_assert(json_schema_build(&vec2_schema, vec2_fields, 2, vec2_slots, 4));
+        test_assert(json_schema_build(&entity_schema, entity_fields, 6, entity_slots, 16));
+        test_assert(!json_schema_build(&entity_schema, entity_fields, 6, entity_slots, 4));
+        test_assert(!json_schema_build(&vec2_schema, bad_fields, 1, bad_slots, 4));
+        test_assert(entity_fields[5].offset == (json_size)offsetof(struct test_entity, position));
+        test_assert(entity_fields[4].size == 8);
+
+        test_assert(json_load(toks, 64, &read, buf, sizeof(buf)-1) == JSON_OK);
+        memset(&e, 0, sizeof(e));
+        obj = json_query(toks, read, "list[0]");
+        test_assert(json_decode(&e, &entity_schema, obj + 1, obj->sub) == 6);
+        test_assert(e.id == 7 && e.uid == ((json_int64)1 << 53) + 1);
+        test_assert(e.weight == 2.5 && e.active == 1);
+        test_assert(!strcmp(e.name, "a\tb"));
+        test_assert(e.position.x == 0.5f && e.position.y == -1.0f);
+
+        /* members with mismatching types are left untouched */
+        obj = json_query(toks, read, "list[1]");
+        test_assert(json_decode(&e, &entity_schema, obj + 1, obj->sub) == 0);
+        test_assert(e.id == 7 && e.active == 1 && !strcmp(e.name, "a\tb"));
+
+        /* ints out of range and strings decoded to fit the member */
+        read = 0;
+        strcpy(e.name, "-");
+        test_assert(json_load(toks, 64, &read, "{\"id\":2147483648,\"uid\":-2147483649,"
+            "\"name\":\"\\u00e4\\u00e4xy\"}", 59) == JSON_OK);
+        test_assert(json_decode(&e, &entity_schema, toks, read) == 2);
+        test_assert(e.id == 7 && e.uid == -(json_int64)2147483649u);
+        test_assert(!strcmp(e.name, "\xc3\xa4\xc3\xa4xy"));
+        read = 0;
+        test_assert(json_load(toks, 64, &read, "{\"id\":-2147483648,\"name\":\"\\u00e4\\u00e4wxyz\"}", 44) == JSON_OK);
+        test_assert(json_decode(&e, &entity_schema, toks, read) == 1);
+        test_assert(e.id == -2147483647 - 1 && !strcmp(e.name, "\xc3\xa4\xc3\xa4xy"));
+
+        /* works on any token source like MessagePack */
+        memset(&out, 0, sizeof(out));
+        memset(&e, 0, sizeof(e));
+        test_assert(json_mp_transcode(buf, sizeof(buf)-1, test_flush, &out) == JSON_OK);
+        test_assert(json_mp_load(mp, 64, &mp_read, out.data, out.len) == JSON_OK);
+        obj = json_query(mp, mp_read, "list[0]");
+        test_assert(json_decode(&e, &entity_schema, obj + 1, obj->sub) == 6);
+        test_assert(e.uid == ((json_int64)1 << 53) + 1 && !strcmp(e.name, "a\tb"));
+        test_assert(e.position.x == 0.5f);
+        #undef TEST_VEC2_FIELDS
+        #undef TEST_ENTITY_FIELDS
+    }
+
+    test_section("query_number")
+    {
+        json_size read = 0;
+        enum json_status status;
         struct json_token toks[128];
         json_number num;
         int ret;
@@ -861,13 +2290,57 @@ static int run_test(void)
         test_assert(json_query_number(&num, toks, read, "map.entity") == JSON_ARRAY);
     }
 
+    test_section("array_decode")
+    {
+        json_size read = 0;
+        double d[4];
+        float f[4];
+        json_int64 i[4];
+        struct json_iter iter;
+        struct json_pair pair;
+        struct json_token toks[16];
+        const char buf[] = "{\"v\":[ 1.5, 2,-3e1 ,0.1],\"i\":[4294967296,-7],\"e\":[],\"x\":[1,\"2\"]}";
+
+        iter = json_begin(buf, sizeof buf);
+        iter = json_parse(&pair, &iter);
+        test_assert(!iter.err);
+        test_assert(pair.value.type == JSON_ARRAY);
+        test_assert(json_array_to_doubles(NULL, 0, &pair.value) == 4);
+        test_assert(json_array_to_doubles(d, 4, &pair.value) == 4);
+        test_assert(d[0] == 1.5 && d[1] == 2.0 && d[2] == -30.0 && d[3] == 0.1);
+        test_assert(json_array_to_floats(f, 2, &pair.value) == 4);
+        test_assert(f[0] == 1.5f && f[1] == 2.0f);
+        test_assert(json_array_to_int64s(i, 4, &pair.value) == -1);
+
+        test_assert(json_load(toks, 16, &read, buf, sizeof(buf)) == JSON_OK);
+        test_assert(json_array_to_int64s(i, 4, json_query(toks, read, "i")) == 2);
+        test_assert(i[0] == ((json_int64)1 << 32) && i[1] == -7);
+        test_assert(json_array_to_doubles(d, 4, json_query(toks, read, "e")) == 0);
+        test_assert(json_array_to_doubles(d, 4, json_query(toks, read, "x")) == -1);
+        test_assert(json_array_to_doubles(d, 4, json_query(toks, read, "v[0]")) == -1);
+    }
+
+    test_section("query_int")
+    {
+        json_size read = 0;
+        json_int64 id = 0;
+        struct json_token toks[16];
+        const char buf[] = "{\"user\":{\"id\":1152921504606846977,\"score\":1.5}}";
+
+        test_assert(json_load(toks, 16, &read, buf, sizeof(buf)) == JSON_OK);
+        test_assert(json_query_int(&id, toks, read, "user.id") == JSON_NUMBER);
+        test_assert(id == ((json_int64)1 << 60) + 1);
+        test_assert(json_query_int(&id, toks, read, "user.score") == JSON_NONE);
+        test_assert(json_query_int(&id, toks, read, "user") == JSON_OBJECT);
+    }
+
     test_section("query_string")
     {
-        int read = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[128];
         char buffer[256];
-        int size;
+        json_size size;
 
         const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
             "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
@@ -887,7 +2360,7 @@ static int run_test(void)
 
     test_section("query_type")
     {
-        int read = 0;
+        json_size read = 0;
         enum json_status status;
         struct json_token toks[128];
         const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"